@@ -0,0 +1,437 @@
+/**
+ * @file AmbientOcclusionBaker.cpp
+ * @brief Implementation of the AmbientOcclusionBaker class.
+ *
+ * Implements the triangle BVH, the hemisphere ray casting and the shader replacements that apply
+ * the baked occlusion at draw time.
+ */
+
+#include "AmbientOcclusionBaker.h"
+#include "GeometryCache.h"
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtConcurrent/QtConcurrentRun>
+#include <vtkActor.h>
+#include <vtkCellArray.h>
+#include <vtkCellArrayIterator.h>
+#include <vtkDataObject.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkShaderProperty.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+const char* const AmbientOcclusionBaker::ArrayName = "AmbientOcclusion";
+
+namespace {
+    using Vec3 = std::array<float, 3>;
+
+    Vec3 operator-(const Vec3& a, const Vec3& b) { return { a[0] - b[0], a[1] - b[1], a[2] - b[2] }; }
+    Vec3 operator+(const Vec3& a, const Vec3& b) { return { a[0] + b[0], a[1] + b[1], a[2] + b[2] }; }
+    Vec3 operator*(const Vec3& a, float s) { return { a[0] * s, a[1] * s, a[2] * s }; }
+    float dot(const Vec3& a, const Vec3& b) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+    Vec3 cross(const Vec3& a, const Vec3& b) {
+        return { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+    }
+    Vec3 normalized(const Vec3& a) {
+        float length = std::sqrt(dot(a, a));
+        return length > 0.0f ? a * (1.0f / length) : Vec3{ 0.0f, 0.0f, 0.0f };
+    }
+
+    /**
+     * @brief Bounding volume hierarchy over a triangle soup, answering "is anything hit" queries.
+     *
+     * Nodes are split at the centroid median of their longest axis and stored depth first, so a
+     * node's left child directly follows it. Leaves hold up to four triangles.
+     */
+    class TriangleBvh {
+    public:
+        TriangleBvh(const std::vector<Vec3>& points, std::vector<std::array<int, 3>> triangles)
+            : points(points), triangles(std::move(triangles)) {
+            if (this->triangles.empty())
+                return;
+            centroids.reserve(this->triangles.size());
+            for (const auto& triangle : this->triangles)
+                centroids.push_back((points[triangle[0]] + points[triangle[1]] + points[triangle[2]]) * (1.0f / 3.0f));
+            nodes.reserve(2 * this->triangles.size() / LeafSize + 1);
+            build(0, static_cast<int>(this->triangles.size()));
+        }
+
+        /**
+         * @brief Tests whether a ray hits any triangle between tMin and tMax.
+         */
+        bool occluded(const Vec3& origin, const Vec3& direction, float tMin, float tMax) const {
+            if (nodes.empty())
+                return false;
+
+            Vec3 inverse;
+            for (int axis = 0; axis < 3; ++axis)
+                inverse[axis] = direction[axis] != 0.0f ? 1.0f / direction[axis] : std::copysign(1.0e30f, direction[axis]);
+
+            int stack[64];
+            int depth = 0;
+            stack[depth++] = 0;
+            while (depth > 0) {
+                const Node& node = nodes[stack[--depth]];
+                if (!hitsBox(node, origin, inverse, tMin, tMax))
+                    continue;
+                if (node.count > 0) {
+                    for (int i = node.first; i < node.first + node.count; ++i) {
+                        if (hitsTriangle(triangles[i], origin, direction, tMin, tMax))
+                            return true;
+                    }
+                }
+                else if (depth + 2 <= 64) {
+                    stack[depth++] = node.right;
+                    stack[depth++] = node.first; // Left child, visited first
+                }
+            }
+            return false;
+        }
+
+    private:
+        static const int LeafSize = 4;
+
+        struct Node {
+            Vec3 lower; ///< Minimum corner of the node's box.
+            Vec3 upper; ///< Maximum corner of the node's box.
+            int first; ///< First triangle of a leaf, or the left child of an inner node.
+            int count; ///< Number of triangles in a leaf, 0 for inner nodes.
+            int right; ///< Right child of an inner node.
+        };
+
+        int build(int begin, int end) {
+            int index = static_cast<int>(nodes.size());
+            nodes.push_back(Node());
+            Node node;
+            node.lower = { 1.0e30f, 1.0e30f, 1.0e30f };
+            node.upper = { -1.0e30f, -1.0e30f, -1.0e30f };
+            Vec3 centroidLower = node.lower, centroidUpper = node.upper;
+            for (int i = begin; i < end; ++i) {
+                for (int corner = 0; corner < 3; ++corner) {
+                    const Vec3& p = points[triangles[i][corner]];
+                    for (int axis = 0; axis < 3; ++axis) {
+                        node.lower[axis] = std::min(node.lower[axis], p[axis]);
+                        node.upper[axis] = std::max(node.upper[axis], p[axis]);
+                    }
+                }
+                for (int axis = 0; axis < 3; ++axis) {
+                    centroidLower[axis] = std::min(centroidLower[axis], centroids[i][axis]);
+                    centroidUpper[axis] = std::max(centroidUpper[axis], centroids[i][axis]);
+                }
+            }
+
+            Vec3 extent = centroidUpper - centroidLower;
+            int axis = extent[0] > extent[1] ? (extent[0] > extent[2] ? 0 : 2) : (extent[1] > extent[2] ? 1 : 2);
+            if (end - begin <= LeafSize || extent[axis] <= 0.0f) {
+                node.first = begin;
+                node.count = end - begin;
+                node.right = -1;
+                nodes[index] = node;
+                return index;
+            }
+
+            // Sort triangles and their centroids together about the median
+            int middle = begin + (end - begin) / 2;
+            std::vector<int> order(end - begin);
+            for (int i = 0; i < end - begin; ++i)
+                order[i] = begin + i;
+            std::nth_element(order.begin(), order.begin() + (middle - begin), order.end(), [this, axis](int a, int b) {
+                return centroids[a][axis] < centroids[b][axis];
+                });
+            std::vector<std::array<int, 3>> sortedTriangles(end - begin);
+            std::vector<Vec3> sortedCentroids(end - begin);
+            for (int i = 0; i < end - begin; ++i) {
+                sortedTriangles[i] = triangles[order[i]];
+                sortedCentroids[i] = centroids[order[i]];
+            }
+            std::copy(sortedTriangles.begin(), sortedTriangles.end(), triangles.begin() + begin);
+            std::copy(sortedCentroids.begin(), sortedCentroids.end(), centroids.begin() + begin);
+
+            node.count = 0;
+            node.first = build(begin, middle);
+            node.right = build(middle, end);
+            nodes[index] = node;
+            return index;
+        }
+
+        static bool hitsBox(const Node& node, const Vec3& origin, const Vec3& inverse, float tMin, float tMax) {
+            for (int axis = 0; axis < 3; ++axis) {
+                float t0 = (node.lower[axis] - origin[axis]) * inverse[axis];
+                float t1 = (node.upper[axis] - origin[axis]) * inverse[axis];
+                if (t0 > t1)
+                    std::swap(t0, t1);
+                tMin = std::max(tMin, t0);
+                tMax = std::min(tMax, t1);
+                if (tMax < tMin)
+                    return false;
+            }
+            return true;
+        }
+
+        bool hitsTriangle(const std::array<int, 3>& triangle, const Vec3& origin, const Vec3& direction, float tMin, float tMax) const {
+            // Moller-Trumbore, either facing
+            const Vec3& a = points[triangle[0]];
+            Vec3 edge1 = points[triangle[1]] - a;
+            Vec3 edge2 = points[triangle[2]] - a;
+            Vec3 p = cross(direction, edge2);
+            float determinant = dot(edge1, p);
+            if (std::fabs(determinant) < 1.0e-12f)
+                return false;
+            float inverse = 1.0f / determinant;
+            Vec3 s = origin - a;
+            float u = dot(s, p) * inverse;
+            if (u < 0.0f || u > 1.0f)
+                return false;
+            Vec3 q = cross(s, edge1);
+            float v = dot(direction, q) * inverse;
+            if (v < 0.0f || u + v > 1.0f)
+                return false;
+            float t = dot(edge2, q) * inverse;
+            return t > tMin && t < tMax;
+        }
+
+        const std::vector<Vec3>& points;
+        std::vector<std::array<int, 3>> triangles;
+        std::vector<Vec3> centroids;
+        std::vector<Node> nodes;
+    };
+
+    /**
+     * @brief Hashes a vertex index into a well-mixed 32-bit value for per-vertex sample rotation.
+     */
+    std::uint32_t mix(std::uint32_t value) {
+        value ^= value >> 16;
+        value *= 0x7feb352dU;
+        value ^= value >> 15;
+        value *= 0x846ca68bU;
+        value ^= value >> 16;
+        return value;
+    }
+
+    /**
+     * @brief Returns the radical inverse of an index in base 2, the second Hammersley coordinate.
+     */
+    float radicalInverse(std::uint32_t bits) {
+        bits = (bits << 16) | (bits >> 16);
+        bits = ((bits & 0x55555555U) << 1) | ((bits & 0xAAAAAAAAU) >> 1);
+        bits = ((bits & 0x33333333U) << 2) | ((bits & 0xCCCCCCCCU) >> 2);
+        bits = ((bits & 0x0F0F0F0FU) << 4) | ((bits & 0xF0F0F0F0U) >> 4);
+        bits = ((bits & 0x00FF00FFU) << 8) | ((bits & 0xFF00FF00U) >> 8);
+        return static_cast<float>(bits) * 2.3283064365386963e-10f;
+    }
+}
+
+/**
+ * @brief Constructs the baker.
+ *
+ * @param parent The parent QObject.
+ */
+AmbientOcclusionBaker::AmbientOcclusionBaker(QObject* parent)
+    : QObject(parent), rays(64) {
+}
+
+/**
+ * @brief Sets the number of rays cast per vertex for later bakes.
+ *
+ * @param rays The ray count; more rays give smoother shading and take proportionally longer.
+ */
+void AmbientOcclusionBaker::setRayCount(int rays) {
+    this->rays = std::max(1, rays);
+}
+
+/**
+ * @brief Returns the number of rays cast per vertex.
+ *
+ * @return The ray count.
+ */
+int AmbientOcclusionBaker::rayCount() const {
+    return rays;
+}
+
+/**
+ * @brief Starts baking the mesh of a part in the background.
+ *
+ * Does nothing if the part has no resident mesh, if its mesh already carries occlusion or if
+ * the same file is already being baked. The baked() signal is emitted on the GUI thread with
+ * the new mesh, which is also stored in the GeometryCache.
+ *
+ * @param part The part whose mesh to bake.
+ */
+void AmbientOcclusionBaker::bake(ModelPart* part) {
+    vtkSmartPointer<vtkPolyData> mesh = part ? part->levelGeometry(ModelPart::DetailLevel::Full) : nullptr;
+    QString fileName = part ? part->sourceFile() : QString();
+    if (!mesh || fileName.isEmpty() || hasOcclusion(mesh) || inFlight.contains(fileName))
+        return;
+
+    inFlight.insert(fileName);
+    int rayCount = rays;
+    QtConcurrent::run([this, mesh, fileName, rayCount] {
+        vtkSmartPointer<vtkFloatArray> occlusion = computeOcclusion(mesh, rayCount);
+        QMetaObject::invokeMethod(this, [this, mesh, fileName, occlusion] {
+            inFlight.remove(fileName);
+            vtkSmartPointer<vtkPolyData> baked = vtkSmartPointer<vtkPolyData>::New();
+            baked->ShallowCopy(mesh);
+            baked->GetPointData()->AddArray(occlusion);
+            baked->GetBounds();
+            GeometryCache::instance().update(fileName, baked);
+            emit this->baked(fileName, baked);
+            }, Qt::QueuedConnection);
+        });
+}
+
+/**
+ * @brief Reports whether a bake of a file is in progress.
+ *
+ * @param fileName The source file.
+ * @return True if the file is being baked.
+ */
+bool AmbientOcclusionBaker::isBaking(const QString& fileName) const {
+    return inFlight.contains(fileName);
+}
+
+/**
+ * @brief Reports whether a mesh already carries baked occlusion.
+ *
+ * @param mesh The mesh to check.
+ * @return True if the mesh has the occlusion point array.
+ */
+bool AmbientOcclusionBaker::hasOcclusion(vtkPolyData* mesh) {
+    return mesh && mesh->GetPointData()->GetArray(ArrayName);
+}
+
+/**
+ * @brief Computes the ambient occlusion of every vertex of a mesh.
+ *
+ * Only reads the mesh, through thread-safe accessors, so it may run while the mesh is being drawn.
+ * Vertex normals are the area-weighted average of the adjacent triangle normals. Rays start just
+ * above the surface and count as blocked if they hit anything within a fifth of the mesh's
+ * bounding diagonal. Each vertex uses the same Hammersley set rotated by a hash of its index,
+ * so results are deterministic and free of banding.
+ *
+ * @param mesh The mesh to bake.
+ * @param rays The number of rays cast per vertex.
+ * @return One value per point, from 0 (open) to 1 (fully occluded).
+ */
+vtkSmartPointer<vtkFloatArray> AmbientOcclusionBaker::computeOcclusion(vtkPolyData* mesh, int rays) {
+    vtkIdType pointCount = mesh->GetNumberOfPoints();
+    std::vector<Vec3> points(pointCount);
+    for (vtkIdType i = 0; i < pointCount; ++i) {
+        double p[3];
+        mesh->GetPoints()->GetPoint(i, p);
+        points[i] = { static_cast<float>(p[0]), static_cast<float>(p[1]), static_cast<float>(p[2]) };
+    }
+
+    std::vector<std::array<int, 3>> triangles;
+    triangles.reserve(mesh->GetNumberOfPolys());
+    std::vector<Vec3> normals(pointCount, Vec3{ 0.0f, 0.0f, 0.0f });
+    vtkSmartPointer<vtkCellArrayIterator> cells = vtk::TakeSmartPointer(mesh->GetPolys()->NewIterator());
+    for (cells->GoToFirstCell(); !cells->IsDoneWithTraversal(); cells->GoToNextCell()) {
+        vtkIdType count;
+        const vtkIdType* ids;
+        cells->GetCurrentCell(count, ids);
+        for (vtkIdType corner = 2; corner < count; ++corner) {
+            std::array<int, 3> triangle = { static_cast<int>(ids[0]), static_cast<int>(ids[corner - 1]), static_cast<int>(ids[corner]) };
+            Vec3 faceNormal = cross(points[triangle[1]] - points[triangle[0]], points[triangle[2]] - points[triangle[0]]);
+            for (int vertex : triangle)
+                normals[vertex] = normals[vertex] + faceNormal;
+            triangles.push_back(triangle);
+        }
+    }
+
+    Vec3 lower = { 1.0e30f, 1.0e30f, 1.0e30f };
+    Vec3 upper = { -1.0e30f, -1.0e30f, -1.0e30f };
+    for (const Vec3& p : points) {
+        for (int axis = 0; axis < 3; ++axis) {
+            lower[axis] = std::min(lower[axis], p[axis]);
+            upper[axis] = std::max(upper[axis], p[axis]);
+        }
+    }
+    float diagonal = pointCount > 0 ? std::sqrt(dot(upper - lower, upper - lower)) : 0.0f;
+    float reach = 0.2f * diagonal;
+    float offset = 1.0e-4f * diagonal;
+
+    TriangleBvh bvh(points, std::move(triangles));
+
+    vtkSmartPointer<vtkFloatArray> occlusion = vtkSmartPointer<vtkFloatArray>::New();
+    occlusion->SetName(ArrayName);
+    occlusion->SetNumberOfComponents(1);
+    occlusion->SetNumberOfTuples(pointCount);
+    float* values = occlusion->GetPointer(0);
+
+    // Share the vertices out in blocks so each task amortises its scheduling cost
+    const vtkIdType blockSize = 1024;
+    std::vector<vtkIdType> blocks;
+    for (vtkIdType start = 0; start < pointCount; start += blockSize)
+        blocks.push_back(start);
+
+    QtConcurrent::blockingMap(blocks, [&](vtkIdType start) {
+        vtkIdType end = std::min(start + blockSize, pointCount);
+        for (vtkIdType i = start; i < end; ++i) {
+            Vec3 normal = normalized(normals[i]);
+            if (dot(normal, normal) == 0.0f) {
+                values[i] = 0.0f;
+                continue;
+            }
+
+            // Orthonormal frame around the normal
+            Vec3 helper = std::fabs(normal[0]) < 0.9f ? Vec3{ 1.0f, 0.0f, 0.0f } : Vec3{ 0.0f, 1.0f, 0.0f };
+            Vec3 tangent = normalized(cross(helper, normal));
+            Vec3 bitangent = cross(normal, tangent);
+            Vec3 origin = points[i] + normal * offset;
+
+            std::uint32_t hash = mix(static_cast<std::uint32_t>(i));
+            float rotateU = (hash & 0xFFFF) / 65536.0f;
+            float rotateV = (hash >> 16) / 65536.0f;
+            int blocked = 0;
+            for (int ray = 0; ray < rays; ++ray) {
+                float u = std::fmod((ray + 0.5f) / rays + rotateU, 1.0f);
+                float v = std::fmod(radicalInverse(static_cast<std::uint32_t>(ray)) + rotateV, 1.0f);
+                // Cosine-weighted direction on the hemisphere
+                float radius = std::sqrt(u);
+                float angle = 6.28318531f * v;
+                float x = radius * std::cos(angle);
+                float y = radius * std::sin(angle);
+                float z = std::sqrt(std::max(0.0f, 1.0f - u));
+                Vec3 direction = tangent * x + bitangent * y + normal * z;
+                if (bvh.occluded(origin, direction, 0.0f, reach))
+                    ++blocked;
+            }
+            values[i] = static_cast<float>(blocked) / rays;
+        }
+        });
+
+    return occlusion;
+}
+
+/**
+ * @brief Makes an actor's lighting use the occlusion baked into its full-detail mesh.
+ *
+ * The occlusion array is passed to the vertex shader as an attribute and the lit fragment colour
+ * is scaled by the unoccluded fraction. Mappers that do not map the array read the attribute as 0,
+ * so the reduced detail levels, which carry no occlusion, are drawn unshaded with the same actor.
+ * Selection passes overwrite the colour afterwards, so picking is unaffected.
+ *
+ * @param actor The actor to shade.
+ * @param mapper The mapper of the full-detail mesh.
+ */
+void AmbientOcclusionBaker::enableShading(vtkActor* actor, vtkPolyDataMapper* mapper) {
+    if (!actor || !mapper)
+        return;
+
+    mapper->MapDataArrayToVertexAttribute("ambientOcclusion", ArrayName, vtkDataObject::FIELD_ASSOCIATION_POINTS, -1);
+
+    vtkShaderProperty* shaders = actor->GetShaderProperty();
+    shaders->ClearAllShaderReplacements();
+    shaders->AddVertexShaderReplacement("//VTK::Normal::Dec", true,
+        "//VTK::Normal::Dec\nin float ambientOcclusion;\nout float occlusionVSOutput;\n", false);
+    shaders->AddVertexShaderReplacement("//VTK::Normal::Impl", true,
+        "//VTK::Normal::Impl\n  occlusionVSOutput = ambientOcclusion;\n", false);
+    shaders->AddFragmentShaderReplacement("//VTK::Normal::Dec", true,
+        "//VTK::Normal::Dec\nin float occlusionVSOutput;\n", false);
+    shaders->AddFragmentShaderReplacement("//VTK::Light::Impl", true,
+        "//VTK::Light::Impl\n  fragOutput0.rgb *= 1.0 - occlusionVSOutput;\n", false);
+}
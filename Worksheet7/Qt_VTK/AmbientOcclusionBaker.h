@@ -0,0 +1,63 @@
+/**
+ * @file AmbientOcclusionBaker.h
+ *
+ * Defines the AmbientOcclusionBaker class, which computes per-vertex ambient occlusion for the
+ * meshes of loaded parts in the background and stores it with the mesh, so that the lighting
+ * shader can darken creases and cavities at no per-frame cost.
+ */
+
+#ifndef VIEWER_AMBIENTOCCLUSIONBAKER_H
+#define VIEWER_AMBIENTOCCLUSIONBAKER_H
+
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+#include <vtkFloatArray.h>
+#include "ModelPart.h"
+
+class vtkActor;
+class vtkPolyDataMapper;
+
+/**
+ * @class AmbientOcclusionBaker
+ * @brief Background job that bakes ambient occlusion into part meshes.
+ *
+ * For every vertex a fixed set of cosine-weighted rays is cast into the hemisphere around the
+ * vertex normal against a bounding volume hierarchy of the mesh's triangles, and the fraction of
+ * rays blocked within a radius proportional to the mesh size is stored as the point array
+ * "AmbientOcclusion". The vertices are shared out over the global thread pool.
+ *
+ * The result is stored on a shallow copy of the mesh that replaces the original in the
+ * GeometryCache, so parts loaded from the same file later, or restored after being released,
+ * pick it up without baking again. The shader replacements installed by enableShading() read the
+ * array as a vertex attribute and scale the lit colour by it; parts without the array, and the
+ * reduced detail levels, are drawn unchanged.
+ */
+class AmbientOcclusionBaker : public QObject {
+    Q_OBJECT
+
+public:
+    static const char* const ArrayName; ///< Name of the baked point array.
+
+    explicit AmbientOcclusionBaker(QObject* parent = nullptr);
+
+    void setRayCount(int rays);
+    int rayCount() const;
+    void bake(ModelPart* part);
+    bool isBaking(const QString& fileName) const;
+
+    static bool hasOcclusion(vtkPolyData* mesh);
+    static vtkSmartPointer<vtkFloatArray> computeOcclusion(vtkPolyData* mesh, int rays);
+    static void enableShading(vtkActor* actor, vtkPolyDataMapper* mapper);
+
+signals:
+    void baked(const QString& fileName, vtkSmartPointer<vtkPolyData> mesh);
+
+private:
+    int rays; ///< Rays cast per vertex.
+    QSet<QString> inFlight; ///< Source files with a bake in progress.
+};
+
+#endif // VIEWER_AMBIENTOCCLUSIONBAKER_H
@@ -0,0 +1,346 @@
+/**
+ * @file EditJournal.cpp
+ * @brief Implementation of the EditJournal class.
+ */
+
+#include "EditJournal.h"
+#include "ModelPart.h"
+#include "PartRegistry.h"
+#include "GeometryCache.h"
+#include <QHash>
+
+/**
+ * @brief Creates an empty journal with the default memory limit.
+ *
+ * @param parent The parent QObject.
+ */
+EditJournal::EditJournal(QObject* parent)
+    : QObject(parent), limit(DefaultMemoryLimit), used(0) {
+}
+
+/**
+ * @brief Deletes the parts still parked in the journal.
+ */
+EditJournal::~EditJournal() {
+    clear();
+}
+
+/**
+ * @brief Adds the property edits of a transaction to an entry, before the transaction is applied.
+ *
+ * Only values that actually change are kept, and parts with none are left out.
+ *
+ * @param entry The entry to add to.
+ * @param transaction The edits about to be applied.
+ */
+void EditJournal::captureProperties(Entry& entry, const PropertyTransaction& transaction) {
+    for (const PropertyTransaction::Edit& edit : transaction.edits()) {
+        ModelPart* part = edit.part;
+        PropertyChange change;
+        change.partId = part->id();
+        change.before.visible = change.after.visible = part->visible();
+        change.before.colour = change.after.colour = part->getColor().rgb();
+        change.before.opacity = change.after.opacity = static_cast<float>(part->opacity());
+
+        if (edit.fields & PropertyTransaction::Name && part->name() != edit.name) {
+            change.fields |= PropertyTransaction::Name;
+            change.before.name = part->name();
+            change.after.name = edit.name;
+        }
+        if (edit.fields & PropertyTransaction::Visible && change.before.visible != edit.visible) {
+            change.fields |= PropertyTransaction::Visible;
+            change.after.visible = edit.visible;
+        }
+        if (edit.fields & PropertyTransaction::Colour && change.before.colour != edit.colour.rgb()) {
+            change.fields |= PropertyTransaction::Colour;
+            change.after.colour = edit.colour.rgb();
+        }
+        if (edit.fields & PropertyTransaction::Opacity && change.before.opacity != static_cast<float>(edit.opacity)) {
+            change.fields |= PropertyTransaction::Opacity;
+            change.after.opacity = static_cast<float>(edit.opacity);
+        }
+
+        if (change.fields)
+            entry.properties.push_back(change);
+    }
+}
+
+/**
+ * @brief Adds a local transform edit to an entry, before the part is moved.
+ *
+ * @param entry The entry to add to.
+ * @param part The part about to be moved.
+ * @param position The new position.
+ * @param orientation The new orientation.
+ */
+void EditJournal::captureTransform(Entry& entry, ModelPart* part, const double position[3], const double orientation[3]) {
+    TransformChange change;
+    change.partId = part->id();
+    part->getLocalTransform(change.before, change.before + 3);
+    for (int i = 0; i < 3; ++i) {
+        change.after[i] = position[i];
+        change.after[i + 3] = orientation[i];
+    }
+    for (int i = 0; i < 6; ++i) {
+        if (change.before[i] != change.after[i]) {
+            entry.transforms.push_back(change);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Builds the transaction that sets one side of an entry's property edits.
+ *
+ * @param entry The entry.
+ * @param after True for the values after the edit (redo), false for those before it (undo).
+ * @return The transaction, leaving out parts that no longer exist.
+ */
+PropertyTransaction EditJournal::propertyTransaction(const Entry& entry, bool after) {
+    PropertyTransaction transaction;
+    for (const PropertyChange& change : entry.properties) {
+        ModelPart* part = PartRegistry::instance().find(change.partId);
+        if (!part)
+            continue;
+
+        const Properties& values = after ? change.after : change.before;
+        if (change.fields & PropertyTransaction::Name)
+            transaction.setName(part, values.name);
+        if (change.fields & PropertyTransaction::Visible)
+            transaction.setVisible(part, values.visible);
+        if (change.fields & PropertyTransaction::Colour)
+            transaction.setColour(part, QColor::fromRgb(values.colour));
+        if (change.fields & PropertyTransaction::Opacity)
+            transaction.setOpacity(part, values.opacity);
+    }
+    return transaction;
+}
+
+/**
+ * @brief Describes where a part sits in the tree.
+ *
+ * @param part A part in the tree, other than the root.
+ * @return Its placement, with nothing parked.
+ */
+EditJournal::Placement EditJournal::placement(ModelPart* part) {
+    Placement placement;
+    placement.partId = part->id();
+    placement.parentId = part->parentItem() ? part->parentItem()->id() : 0;
+    placement.row = part->row();
+    return placement;
+}
+
+/**
+ * @brief Adds a done edit to the journal, dropping every undone edit.
+ *
+ * @param entry The edit. Entries that change nothing are ignored.
+ */
+void EditJournal::record(Entry entry) {
+    if (entry.properties.empty() && entry.transforms.empty() && entry.inserted.empty() && entry.removed.empty())
+        return;
+
+    for (Entry& undone : redoStack) {
+        used -= undone.bytes;
+        discard(undone);
+    }
+    redoStack.clear();
+
+    entry.bytes = measure(entry);
+    used += entry.bytes;
+    undoStack.push_back(std::move(entry));
+    trim();
+    emit changed();
+}
+
+/**
+ * @brief Returns the edit to undo next, for the caller to revert before calling finishUndo().
+ *
+ * @return The entry, or nullptr if there is nothing to undo.
+ */
+EditJournal::Entry* EditJournal::undoEntry() {
+    return undoStack.empty() ? nullptr : &undoStack.back();
+}
+
+/**
+ * @brief Moves the edit returned by undoEntry(), now reverted, to the redo history.
+ */
+void EditJournal::finishUndo() {
+    if (undoStack.empty())
+        return;
+
+    Entry entry = std::move(undoStack.back());
+    undoStack.pop_back();
+    used -= entry.bytes;
+    entry.bytes = measure(entry); // What is parked has changed
+    used += entry.bytes;
+    redoStack.push_back(std::move(entry));
+    trim();
+    emit changed();
+}
+
+/**
+ * @brief Returns the edit to redo next, for the caller to reapply before calling finishRedo().
+ *
+ * @return The entry, or nullptr if there is nothing to redo.
+ */
+EditJournal::Entry* EditJournal::redoEntry() {
+    return redoStack.empty() ? nullptr : &redoStack.back();
+}
+
+/**
+ * @brief Moves the edit returned by redoEntry(), now reapplied, back to the undo history.
+ */
+void EditJournal::finishRedo() {
+    if (redoStack.empty())
+        return;
+
+    Entry entry = std::move(redoStack.back());
+    redoStack.pop_back();
+    used -= entry.bytes;
+    entry.bytes = measure(entry);
+    used += entry.bytes;
+    undoStack.push_back(std::move(entry));
+    trim();
+    emit changed();
+}
+
+/**
+ * @brief Returns true if there is an edit to undo.
+ */
+bool EditJournal::canUndo() const {
+    return !undoStack.empty();
+}
+
+/**
+ * @brief Returns true if there is an edit to redo.
+ */
+bool EditJournal::canRedo() const {
+    return !redoStack.empty();
+}
+
+/**
+ * @brief Returns the description of the edit to undo next, or an empty string.
+ */
+QString EditJournal::undoText() const {
+    return undoStack.empty() ? QString() : undoStack.back().text;
+}
+
+/**
+ * @brief Returns the description of the edit to redo next, or an empty string.
+ */
+QString EditJournal::redoText() const {
+    return redoStack.empty() ? QString() : redoStack.back().text;
+}
+
+/**
+ * @brief Drops the whole history, deleting every parked part.
+ */
+void EditJournal::clear() {
+    for (Entry& entry : undoStack)
+        discard(entry);
+    for (Entry& entry : redoStack)
+        discard(entry);
+    undoStack.clear();
+    redoStack.clear();
+    used = 0;
+    emit changed();
+}
+
+/**
+ * @brief Sets the memory the history may keep alive, dropping the oldest edits if it is exceeded.
+ *
+ * @param bytes The limit in bytes; 0 keeps no history.
+ */
+void EditJournal::setMemoryLimit(qint64 bytes) {
+    limit = qMax<qint64>(0, bytes);
+    trim();
+    emit changed();
+}
+
+/**
+ * @brief Returns the memory limit in bytes.
+ */
+qint64 EditJournal::memoryLimit() const {
+    return limit;
+}
+
+/**
+ * @brief Returns the estimated memory the history keeps alive, in bytes.
+ */
+qint64 EditJournal::memoryUsed() const {
+    return used;
+}
+
+/**
+ * @brief Estimates the memory an entry keeps alive.
+ *
+ * Parked subtrees count their parts, and each mesh only if every part holding it is parked in
+ * the entry: a mesh still shared with parts elsewhere would not be freed by dropping the entry.
+ */
+qint64 EditJournal::measure(const Entry& entry) {
+    qint64 bytes = sizeof(Entry) + entry.text.size() * sizeof(QChar);
+    bytes += entry.properties.size() * sizeof(PropertyChange);
+    for (const PropertyChange& change : entry.properties)
+        bytes += (change.before.name.size() + change.after.name.size()) * sizeof(QChar);
+    bytes += entry.transforms.size() * sizeof(TransformChange);
+    bytes += (entry.inserted.size() + entry.removed.size()) * sizeof(Placement);
+
+    std::vector<ModelPart*> stack;
+    for (const std::vector<Placement>* placements : { &entry.inserted, &entry.removed }) {
+        for (const Placement& placement : *placements) {
+            if (placement.parked)
+                stack.push_back(placement.parked);
+        }
+    }
+    QHash<vtkPolyData*, int> parkedUsers; // Parked parts holding each mesh
+    while (!stack.empty()) {
+        ModelPart* part = stack.back();
+        stack.pop_back();
+        bytes += sizeof(ModelPart);
+        if (vtkPolyData* mesh = part->levelGeometry(ModelPart::DetailLevel::Full))
+            ++parkedUsers[mesh];
+        for (int row = 0; row < part->childCount(); ++row)
+            stack.push_back(part->child(row));
+    }
+
+    GeometryCache& cache = GeometryCache::instance();
+    for (auto it = parkedUsers.constBegin(); it != parkedUsers.constEnd(); ++it) {
+        if (cache.userCount(it.key()) <= it.value())
+            bytes += static_cast<qint64>(it.key()->GetActualMemorySize()) * 1024;
+    }
+    return bytes;
+}
+
+/**
+ * @brief Deletes the parts parked in an entry.
+ */
+void EditJournal::discard(Entry& entry) {
+    for (std::vector<Placement>* placements : { &entry.inserted, &entry.removed }) {
+        for (Placement& placement : *placements) {
+            if (!placement.parked)
+                continue;
+            emit subtreeDiscarded(placement.parked);
+            delete placement.parked;
+            placement.parked = nullptr;
+        }
+    }
+}
+
+/**
+ * @brief Drops edits until the history fits the memory limit.
+ *
+ * The oldest done edits go first, then the undone edits furthest from being redone, so what is
+ * left can still be undone and redone in order.
+ */
+void EditJournal::trim() {
+    while (used > limit && !undoStack.empty()) {
+        used -= undoStack.front().bytes;
+        discard(undoStack.front());
+        undoStack.pop_front();
+    }
+    while (used > limit && !redoStack.empty()) {
+        used -= redoStack.front().bytes;
+        discard(redoStack.front());
+        redoStack.pop_front();
+    }
+}
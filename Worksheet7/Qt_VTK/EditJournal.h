@@ -0,0 +1,133 @@
+/**
+ * @file EditJournal.h
+ *
+ * Defines the EditJournal class, which records edits to the parts tree as compact deltas so they
+ * can be undone and redone.
+ */
+
+#ifndef VIEWER_EDITJOURNAL_H
+#define VIEWER_EDITJOURNAL_H
+
+#include <QObject>
+#include <QColor>
+#include <QString>
+#include <QtGlobal>
+#include <deque>
+#include <vector>
+#include "PropertyTransaction.h"
+
+class ModelPart;
+
+/**
+ * @class EditJournal
+ * @brief Undo and redo history of property, transform, insert and delete edits.
+ *
+ * Each entry holds only what an edit changed: the old and new values of the properties it set,
+ * keyed by part ID, the old and new local transforms, and where inserted or removed subtrees sit
+ * in the tree. A subtree that is out of the tree because its deletion was done, or its insertion
+ * undone, is parked in the entry as the detached parts themselves, so their meshes stay shared
+ * by reference and putting them back costs one insert whatever their size.
+ *
+ * The journal estimates the memory each entry keeps alive, parked meshes included, and drops the
+ * oldest entries once the total exceeds the memory limit. Parked parts of a dropped entry are
+ * deleted, after subtreeDiscarded() has been emitted for each of their roots.
+ */
+class EditJournal : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr qint64 DefaultMemoryLimit = 256LL * 1024 * 1024; ///< Memory limit of a new journal, in bytes.
+
+    /**
+     * @brief Property values of one part on one side of an edit.
+     */
+    struct Properties {
+        QString name; ///< The name, if the change sets PropertyTransaction::Name.
+        bool visible = true; ///< The visibility.
+        QRgb colour = 0; ///< The colour.
+        float opacity = 1.0f; ///< The opacity.
+    };
+
+    /**
+     * @brief Property edit of one part.
+     */
+    struct PropertyChange {
+        quint64 partId = 0; ///< ID of the edited part.
+        int fields = 0; ///< The PropertyTransaction::Field flags whose values changed.
+        Properties before; ///< Values before the edit.
+        Properties after; ///< Values after the edit.
+    };
+
+    /**
+     * @brief Local transform edit of one part, as position followed by orientation.
+     */
+    struct TransformChange {
+        quint64 partId = 0; ///< ID of the moved part.
+        double before[6] = {}; ///< Position and orientation before the edit.
+        double after[6] = {}; ///< Position and orientation after the edit.
+    };
+
+    /**
+     * @brief Place in the tree of one inserted or removed subtree.
+     */
+    struct Placement {
+        quint64 partId = 0; ///< ID of the subtree's root.
+        quint64 parentId = 0; ///< ID of the parent it is a child of while in the tree.
+        int row = 0; ///< Row it occupies under the parent while in the tree.
+        ModelPart* parked = nullptr; ///< The detached subtree while out of the tree, owned by the journal; otherwise nullptr.
+    };
+
+    /**
+     * @brief One undoable edit.
+     *
+     * Undoing restores the removed subtrees, removes the inserted ones and sets the old transforms
+     * and properties; redoing does the reverse.
+     */
+    struct Entry {
+        QString text; ///< Description shown in the Undo and Redo actions.
+        std::vector<PropertyChange> properties; ///< Property edits, one per part.
+        std::vector<TransformChange> transforms; ///< Transform edits.
+        std::vector<Placement> inserted; ///< Subtrees the edit inserted, in ascending row order per parent.
+        std::vector<Placement> removed; ///< Subtrees the edit removed, in ascending row order per parent.
+        qint64 bytes = 0; ///< Memory the entry keeps alive, as last measured.
+    };
+
+    explicit EditJournal(QObject* parent = nullptr);
+    ~EditJournal();
+
+    static void captureProperties(Entry& entry, const PropertyTransaction& transaction);
+    static void captureTransform(Entry& entry, ModelPart* part, const double position[3], const double orientation[3]);
+    static PropertyTransaction propertyTransaction(const Entry& entry, bool after);
+    static Placement placement(ModelPart* part);
+
+    void record(Entry entry);
+    Entry* undoEntry();
+    void finishUndo();
+    Entry* redoEntry();
+    void finishRedo();
+    bool canUndo() const;
+    bool canRedo() const;
+    QString undoText() const;
+    QString redoText() const;
+    void clear();
+
+    void setMemoryLimit(qint64 bytes);
+    qint64 memoryLimit() const;
+    qint64 memoryUsed() const;
+
+signals:
+    void changed();
+    void subtreeDiscarded(ModelPart* root);
+
+private:
+    static qint64 measure(const Entry& entry);
+    void discard(Entry& entry);
+    void trim();
+
+    std::deque<Entry> undoStack; ///< Done edits, oldest first.
+    std::deque<Entry> redoStack; ///< Undone edits, the one undone first at the front.
+    qint64 limit; ///< Memory limit in bytes.
+    qint64 used; ///< Sum of the bytes of every entry.
+};
+
+#endif // VIEWER_EDITJOURNAL_H
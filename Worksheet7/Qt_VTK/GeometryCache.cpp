@@ -0,0 +1,146 @@
+/**
+ * @file GeometryCache.cpp
+ * @brief Implementation of the GeometryCache class.
+ *
+ * Reads STL files on a cache miss and shares the resulting polydata between every part that asks
+ * for the same file while it is in memory.
+ */
+
+#include "GeometryCache.h"
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <vtkNew.h>
+#include <vtkSTLReader.h>
+
+ /**
+  * @brief Returns the process-wide geometry cache.
+  *
+  * @return The geometry cache.
+  */
+GeometryCache& GeometryCache::instance() {
+    static GeometryCache cache;
+    return cache;
+}
+
+/**
+ * @brief Returns the mesh stored in an STL file, reading it only if it is not already in memory.
+ *
+ * The file is read outside the lock, so two threads missing on the same file at once may both
+ * read it; the first to finish wins and the other result is discarded.
+ *
+ * @param fileName The path to the STL file.
+ * @return The mesh, or an empty polydata if the file could not be read.
+ */
+vtkSmartPointer<vtkPolyData> GeometryCache::load(const QString& fileName) {
+    QString key = QFileInfo(fileName).canonicalFilePath();
+    if (key.isEmpty())
+        key = fileName;
+
+    {
+        QMutexLocker locker(&mutex);
+        auto cached = meshes.constFind(key);
+        if (cached != meshes.constEnd())
+            return cached.value();
+    }
+
+    vtkNew<vtkSTLReader> reader;
+    reader->SetFileName(fileName.toStdString().c_str());
+    reader->Update();
+    vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->ShallowCopy(reader->GetOutput());
+
+    QMutexLocker locker(&mutex);
+    auto cached = meshes.constFind(key);
+    if (cached != meshes.constEnd())
+        return cached.value();
+    meshes.insert(key, polyData);
+    return polyData;
+}
+
+/**
+ * @brief Reports whether the mesh for a file is currently in memory.
+ *
+ * @param fileName The path to the STL file.
+ * @return True if a request for the file would not touch the disk.
+ */
+bool GeometryCache::contains(const QString& fileName) {
+    QString key = QFileInfo(fileName).canonicalFilePath();
+    if (key.isEmpty())
+        key = fileName;
+
+    QMutexLocker locker(&mutex);
+    return meshes.contains(key);
+}
+
+/**
+ * @brief Replaces the cached mesh of a file, for example with one carrying derived arrays.
+ *
+ * Parts holding the previous mesh keep it until they are given the new one.
+ *
+ * @param fileName The path to the STL file.
+ * @param polyData The mesh to hand out for the file from now on.
+ */
+void GeometryCache::update(const QString& fileName, vtkSmartPointer<vtkPolyData> polyData) {
+    QString key = QFileInfo(fileName).canonicalFilePath();
+    if (key.isEmpty())
+        key = fileName;
+
+    QMutexLocker locker(&mutex);
+    meshes.insert(key, polyData);
+}
+
+/**
+ * @brief Drops every mesh that no part is using any more.
+ *
+ * A mesh whose only reference is the cache's own cannot be picked up by another thread while the
+ * lock is held, so it is safe to release here.
+ *
+ * @return The number of bytes released.
+ */
+qint64 GeometryCache::trim() {
+    QMutexLocker locker(&mutex);
+    qint64 released = 0;
+    for (auto it = meshes.begin(); it != meshes.end();) {
+        if (it.value()->GetReferenceCount() == 1) {
+            released += static_cast<qint64>(it.value()->GetActualMemorySize()) * 1024;
+            it = meshes.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    return released;
+}
+
+/**
+ * @brief Records that a part holds a mesh.
+ *
+ * @param polyData The mesh.
+ */
+void GeometryCache::addUser(const vtkPolyData* polyData) {
+    QMutexLocker locker(&mutex);
+    ++users[polyData];
+}
+
+/**
+ * @brief Records that a part no longer holds a mesh.
+ *
+ * @param polyData The mesh.
+ */
+void GeometryCache::removeUser(const vtkPolyData* polyData) {
+    QMutexLocker locker(&mutex);
+    auto it = users.find(polyData);
+    if (it != users.end() && --it.value() <= 0)
+        users.erase(it);
+}
+
+/**
+ * @brief Returns the number of parts holding a mesh.
+ *
+ * @param polyData The mesh.
+ * @return The number of parts, 0 if none.
+ */
+int GeometryCache::userCount(const vtkPolyData* polyData) {
+    QMutexLocker locker(&mutex);
+    return users.value(polyData, 0);
+}
@@ -0,0 +1,51 @@
+/**
+ * @file GeometryCache.h
+ *
+ * Defines the GeometryCache class, which hands out the polydata loaded from STL files so that parts
+ * loaded from the same file share one mesh, and so that a part which has released its mesh can get
+ * it back later.
+ */
+
+#ifndef VIEWER_GEOMETRYCACHE_H
+#define VIEWER_GEOMETRYCACHE_H
+
+#include <QString>
+#include <QHash>
+#include <QMutex>
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+/**
+ * @class GeometryCache
+ * @brief Process-wide cache of meshes keyed by source file.
+ *
+ * A mesh stays in memory for as long as some part uses it. Once every part has let go of it,
+ * trim() drops it and the next request reads it from disk again. All methods are safe to call
+ * from loader threads.
+ *
+ * Parts report when they start and stop holding a mesh, so userCount() tells how many parts
+ * share it, for example to know whether dropping some parts would free it.
+ */
+class GeometryCache {
+public:
+    static GeometryCache& instance();
+
+    vtkSmartPointer<vtkPolyData> load(const QString& fileName);
+    bool contains(const QString& fileName);
+    void update(const QString& fileName, vtkSmartPointer<vtkPolyData> polyData);
+    qint64 trim();
+    void addUser(const vtkPolyData* polyData);
+    void removeUser(const vtkPolyData* polyData);
+    int userCount(const vtkPolyData* polyData);
+
+private:
+    GeometryCache() = default;
+    GeometryCache(const GeometryCache&) = delete;
+    GeometryCache& operator=(const GeometryCache&) = delete;
+
+    QMutex mutex; ///< Guards the mesh table.
+    QHash<QString, vtkSmartPointer<vtkPolyData>> meshes; ///< Meshes in memory, keyed by canonical file path.
+    QHash<const vtkPolyData*, int> users; ///< Number of parts holding each mesh; absent means none.
+};
+
+#endif // VIEWER_GEOMETRYCACHE_H
@@ -0,0 +1,255 @@
+/**
+ * @file InteractionGovernor.cpp
+ * @brief Implementation of the InteractionGovernor class.
+ *
+ * Times every frame rendered by the view and, while the camera is being moved, assigns each
+ * ModelPart a detail level so that the estimated cost of the next frame fits the target.
+ */
+
+#include "InteractionGovernor.h"
+#include <vtkCamera.h>
+#include <vtkCommand.h>
+#include <vtkMath.h>
+#include <vtkRenderWindowInteractor.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+ /**
+  * @brief Constructs the governor and attaches it to the given window.
+  *
+  * Observes the window's render events to time frames and the window's interactor for the mouse
+  * events that start and end a camera interaction.
+  *
+  * @param renderWindow The render window to govern.
+  * @param renderer The renderer whose camera is used to measure on-screen part size.
+  * @param parent The parent QObject.
+  */
+InteractionGovernor::InteractionGovernor(vtkRenderWindow* renderWindow, vtkRenderer* renderer, QObject* parent)
+    : QObject(parent), renderWindow(renderWindow), renderer(renderer),
+    targetTime(1000.0 / 30.0), lastFrameTime(0.0), buttonsHeld(0), interacting(false) {
+    windowObservers.append(renderWindow->AddObserver(vtkCommand::StartEvent, this, &InteractionGovernor::onRenderStart));
+    windowObservers.append(renderWindow->AddObserver(vtkCommand::EndEvent, this, &InteractionGovernor::onRenderEnd));
+
+    vtkRenderWindowInteractor* interactor = renderWindow->GetInteractor();
+    if (interactor) {
+        const unsigned long pressEvents[] = { vtkCommand::LeftButtonPressEvent, vtkCommand::MiddleButtonPressEvent, vtkCommand::RightButtonPressEvent };
+        const unsigned long releaseEvents[] = { vtkCommand::LeftButtonReleaseEvent, vtkCommand::MiddleButtonReleaseEvent, vtkCommand::RightButtonReleaseEvent };
+        for (unsigned long event : pressEvents)
+            interactorObservers.append(interactor->AddObserver(event, this, &InteractionGovernor::onInteractionStart));
+        for (unsigned long event : releaseEvents)
+            interactorObservers.append(interactor->AddObserver(event, this, &InteractionGovernor::onInteractionEnd));
+        interactorObservers.append(interactor->AddObserver(vtkCommand::MouseWheelForwardEvent, this, &InteractionGovernor::onMouseWheel));
+        interactorObservers.append(interactor->AddObserver(vtkCommand::MouseWheelBackwardEvent, this, &InteractionGovernor::onMouseWheel));
+    }
+
+    wheelIdleTimer.setSingleShot(true);
+    wheelIdleTimer.setInterval(150);
+    connect(&wheelIdleTimer, &QTimer::timeout, this, &InteractionGovernor::endInteraction);
+}
+
+/**
+ * @brief Detaches the governor from the render window and its interactor.
+ */
+InteractionGovernor::~InteractionGovernor() {
+    for (unsigned long tag : windowObservers)
+        renderWindow->RemoveObserver(tag);
+
+    vtkRenderWindowInteractor* interactor = renderWindow->GetInteractor();
+    if (interactor) {
+        for (unsigned long tag : interactorObservers)
+            interactor->RemoveObserver(tag);
+    }
+}
+
+/**
+ * @brief Sets the frame time the governor aims for while the camera is moving.
+ *
+ * @param milliseconds The target frame time in milliseconds.
+ */
+void InteractionGovernor::setTargetFrameTime(double milliseconds) {
+    targetTime = std::max(1.0, milliseconds);
+}
+
+/**
+ * @brief Returns the frame time the governor aims for while the camera is moving.
+ *
+ * @return The target frame time in milliseconds.
+ */
+double InteractionGovernor::targetFrameTime() const {
+    return targetTime;
+}
+
+/**
+ * @brief Replaces the set of parts the governor may downgrade.
+ *
+ * Must be called whenever parts are added to or removed from the renderer.
+ *
+ * @param parts The parts currently in the scene.
+ */
+void InteractionGovernor::setParts(const QList<ModelPart*>& parts) {
+    this->parts = parts;
+}
+
+/**
+ * @brief Reports whether a camera interaction is in progress.
+ *
+ * @return True while the camera is being moved.
+ */
+bool InteractionGovernor::isInteracting() const {
+    return interacting;
+}
+
+/**
+ * @brief Marks the start of an interaction when a mouse button is pressed in the view.
+ */
+void InteractionGovernor::onInteractionStart(vtkObject*, unsigned long, void*) {
+    ++buttonsHeld;
+    interacting = true;
+}
+
+/**
+ * @brief Ends the interaction once every mouse button has been released.
+ */
+void InteractionGovernor::onInteractionEnd(vtkObject*, unsigned long, void*) {
+    buttonsHeld = std::max(0, buttonsHeld - 1);
+    if (buttonsHeld == 0)
+        endInteraction();
+}
+
+/**
+ * @brief Treats wheel zooming as an interaction that ends shortly after the wheel stops.
+ */
+void InteractionGovernor::onMouseWheel(vtkObject*, unsigned long, void*) {
+    interacting = true;
+    wheelIdleTimer.start();
+}
+
+/**
+ * @brief Starts timing a frame.
+ */
+void InteractionGovernor::onRenderStart(vtkObject*, unsigned long, void*) {
+    frameTimer.start();
+}
+
+/**
+ * @brief Records the cost of the frame just rendered and rebalances detail if interacting.
+ */
+void InteractionGovernor::onRenderEnd(vtkObject*, unsigned long, void*) {
+    if (!frameTimer.isValid())
+        return;
+
+    lastFrameTime = frameTimer.nsecsElapsed() / 1.0e6;
+    if (interacting)
+        rebalance(lastFrameTime);
+}
+
+/**
+ * @brief Leaves interaction mode and renders one frame at full detail.
+ *
+ * The render is queued rather than issued immediately so that it runs after the interactor style
+ * has finished handling the release event.
+ */
+void InteractionGovernor::endInteraction() {
+    if (!interacting || buttonsHeld > 0)
+        return;
+
+    interacting = false;
+    wheelIdleTimer.stop();
+    restoreFullDetail();
+    QTimer::singleShot(0, this, [this]() { renderWindow->Render(); });
+}
+
+/**
+ * @brief Chooses a detail level for every part so the next frame fits the target time.
+ *
+ * The cost per primitive is estimated from the previous frame. Starting from full detail, parts
+ * are downgraded one level at a time in order of increasing on-screen size until the estimated
+ * cost fits the budget, so large parts near the camera keep their detail the longest.
+ *
+ * @param frameTime The measured cost of the previous frame in milliseconds.
+ */
+void InteractionGovernor::rebalance(double frameTime) {
+    struct Candidate {
+        ModelPart* part;
+        double size;
+        int level;
+    };
+
+    std::vector<Candidate> candidates;
+    candidates.reserve(parts.size());
+    double submitted = 0.0;
+    double fullCost = 0.0;
+    for (ModelPart* part : parts) {
+        vtkActor* actor = part->getActor();
+        if (!actor || !actor->GetVisibility())
+            continue;
+        submitted += part->primitiveCount(part->detailLevel());
+        fullCost += part->primitiveCount(ModelPart::DetailLevel::Full);
+        candidates.push_back({ part, screenSize(part), 0 });
+    }
+    if (candidates.empty() || submitted <= 0.0)
+        return;
+
+    double costPerPrimitive = frameTime / submitted;
+    double budget = targetTime / costPerPrimitive;
+
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.size < b.size;
+    });
+
+    double estimate = fullCost;
+    for (int level = 1; level < ModelPart::DetailLevelCount && estimate > budget; ++level) {
+        for (Candidate& candidate : candidates) {
+            if (estimate <= budget)
+                break;
+            auto from = static_cast<ModelPart::DetailLevel>(candidate.level);
+            auto to = static_cast<ModelPart::DetailLevel>(level);
+            estimate -= candidate.part->primitiveCount(from) - candidate.part->primitiveCount(to);
+            candidate.level = level;
+        }
+    }
+
+    for (const Candidate& candidate : candidates)
+        candidate.part->setDetailLevel(static_cast<ModelPart::DetailLevel>(candidate.level));
+}
+
+/**
+ * @brief Returns every part to its full-detail representation.
+ */
+void InteractionGovernor::restoreFullDetail() {
+    for (ModelPart* part : parts)
+        part->setDetailLevel(ModelPart::DetailLevel::Full);
+}
+
+/**
+ * @brief Estimates the on-screen radius of a part in pixels.
+ *
+ * Projects the part's bounding sphere through the active camera of the renderer.
+ *
+ * @param part The part to measure.
+ * @return The approximate projected radius in pixels.
+ */
+double InteractionGovernor::screenSize(ModelPart* part) const {
+    double bounds[6];
+    part->getActor()->GetBounds(bounds);
+    double center[3] = { (bounds[0] + bounds[1]) / 2.0, (bounds[2] + bounds[3]) / 2.0, (bounds[4] + bounds[5]) / 2.0 };
+    double radius = 0.5 * std::sqrt((bounds[1] - bounds[0]) * (bounds[1] - bounds[0]) +
+        (bounds[3] - bounds[2]) * (bounds[3] - bounds[2]) +
+        (bounds[5] - bounds[4]) * (bounds[5] - bounds[4]));
+
+    vtkCamera* camera = renderer->GetActiveCamera();
+    double halfHeight = renderer->GetSize()[1] / 2.0;
+    double extent;
+    if (camera->GetParallelProjection()) {
+        extent = camera->GetParallelScale();
+    }
+    else {
+        double distance = std::sqrt(vtkMath::Distance2BetweenPoints(center, camera->GetPosition()));
+        if (distance <= radius)
+            return halfHeight;
+        extent = distance * std::tan(vtkMath::RadiansFromDegrees(camera->GetViewAngle()) / 2.0);
+    }
+
+    return extent > 0.0 ? radius / extent * halfHeight : 0.0;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file InteractionGovernor.h
+ *
+ * Defines the InteractionGovernor class, which keeps camera interaction responsive on heavy scenes
+ * by swapping ModelParts for cheaper representations while the camera is moving and restoring full
+ * detail as soon as the interaction ends.
+ */
+
+#ifndef VIEWER_INTERACTIONGOVERNOR_H
+#define VIEWER_INTERACTIONGOVERNOR_H
+
+#include <QObject>
+#include <QList>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <vtkSmartPointer.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderer.h>
+#include "ModelPart.h"
+
+class vtkObject;
+
+/**
+ * @class InteractionGovernor
+ * @brief Adapts per-part detail levels to hold a target frame time during interaction.
+ *
+ * While a mouse button is held (or the wheel is turning) the governor measures the cost of each
+ * frame and lowers the detail level of the parts with the smallest on-screen size until the
+ * estimated cost fits the target. When the interaction ends every part is returned to full detail
+ * and a single still frame is rendered.
+ */
+class InteractionGovernor : public QObject {
+    Q_OBJECT
+
+public:
+    InteractionGovernor(vtkRenderWindow* renderWindow, vtkRenderer* renderer, QObject* parent = nullptr);
+    ~InteractionGovernor();
+
+    void setTargetFrameTime(double milliseconds);
+    double targetFrameTime() const;
+    void setParts(const QList<ModelPart*>& parts);
+    bool isInteracting() const;
+
+private:
+    void onInteractionStart(vtkObject* caller, unsigned long eventId, void* callData);
+    void onInteractionEnd(vtkObject* caller, unsigned long eventId, void* callData);
+    void onMouseWheel(vtkObject* caller, unsigned long eventId, void* callData);
+    void onRenderStart(vtkObject* caller, unsigned long eventId, void* callData);
+    void onRenderEnd(vtkObject* caller, unsigned long eventId, void* callData);
+    void endInteraction();
+    void rebalance(double frameTime);
+    void restoreFullDetail();
+    double screenSize(ModelPart* part) const;
+
+    vtkSmartPointer<vtkRenderWindow> renderWindow; ///< Window whose frames are timed.
+    vtkSmartPointer<vtkRenderer> renderer; ///< Renderer whose camera determines on-screen part size.
+    QList<ModelPart*> parts; ///< Parts currently in the scene.
+    QList<unsigned long> windowObservers; ///< Observer tags registered on the render window.
+    QList<unsigned long> interactorObservers; ///< Observer tags registered on the interactor.
+    QElapsedTimer frameTimer; ///< Measures the CPU cost of the current frame.
+    QTimer wheelIdleTimer; ///< Ends a wheel interaction once the wheel stops turning.
+    double targetTime; ///< Target frame time in milliseconds.
+    double lastFrameTime; ///< Measured cost of the previous frame in milliseconds.
+    int buttonsHeld; ///< Number of mouse buttons currently held in the view.
+    bool interacting; ///< True while the camera is being moved.
+};
+
+#endif // VIEWER_INTERACTIONGOVERNOR_H
@@ -16,24 +16,88 @@
 #include <vtkSTLReader.h>
 #include <vtkSmartPointer.h>
 #include <vtkDataSetMapper.h>
+#include <vtkQuadricClustering.h>
+#include <vtkMaskPoints.h>
+#include <vtkOutlineFilter.h>
+#include <vtkPolyData.h>
+#include <vtkWindow.h>
+#include <vtkTransform.h>
+#include "GeometryCache.h"
+#include "PartStateStore.h"
+#include "NodePool.h"
+#include "PartRegistry.h"
+#include "SceneSnapshot.h"
+#include "AmbientOcclusionBaker.h"
+#include <utility>
+#include <vector>
 
  /**
   * Constructor for the ModelPart class.
-  * Initializes a model part with the given data and parent.
+  * Initializes a visible, white, opaque model part with the given name and parent.
   *
-  * @param data A list of QVariant items to initialize the item's data.
+  * @param name The name shown in the tree.
   * @param parent The parent ModelPart, nullptr if it's the root.
   */
-ModelPart::ModelPart(const QList<QVariant>& data, ModelPart* parent)
-    : m_itemData(data), m_parentItem(parent), isVisible(false) {
+ModelPart::ModelPart(const QString& name, ModelPart* parent)
+    : partId(PartRegistry::instance().add(this)), stateId(PartStateStore::instance().allocate(name)), m_parentItem(parent) {
 }
 
 /**
  * Destructor for the ModelPart class.
- * Cleans up the child items by deleting them.
+ * Deletes the whole subtree from a flat list rather than recursively, so that a tree of any depth
+ * can be deleted: each descendant is emptied of its children before it is deleted.
  */
 ModelPart::~ModelPart() {
-    qDeleteAll(m_childItems);
+    std::vector<ModelPart*> stack(m_childItems.begin(), m_childItems.end());
+    m_childItems.clear();
+    while (!stack.empty()) {
+        ModelPart* part = stack.back();
+        stack.pop_back();
+        stack.insert(stack.end(), part->m_childItems.begin(), part->m_childItems.end());
+        part->m_childItems.clear();
+        delete part;
+    }
+    setMesh(nullptr);
+    PartRegistry::instance().remove(partId);
+    PartStateStore::instance().release(stateId);
+}
+
+/**
+ * Gets the part's stable ID.
+ *
+ * @return The ID, which looks up this part in the PartRegistry for as long as it exists.
+ */
+quint64 ModelPart::id() const {
+    return partId;
+}
+
+/**
+ * Allocates a part from the shared node pool.
+ *
+ * @param size The size of the object being created.
+ * @return Storage for the part.
+ */
+void* ModelPart::operator new(std::size_t size) {
+    return pool().allocate(size);
+}
+
+/**
+ * Returns a part's storage to the shared node pool.
+ *
+ * @param part The storage of the destroyed part.
+ */
+void ModelPart::operator delete(void* part) {
+    pool().deallocate(part);
+}
+
+/**
+ * Gets the pool every part is allocated from.
+ *
+ * @return The node pool.
+ */
+NodePool& ModelPart::pool() {
+    static NodePool parts(sizeof(ModelPart));
+    return parts;
 }
 
 /**
@@ -43,7 +107,101 @@ ModelPart::~ModelPart() {
  */
 void ModelPart::appendChild(ModelPart* item) {
     item->m_parentItem = this;
+    item->m_row = m_childItems.size();
     m_childItems.append(item);
+    item->markWorldDirty();
+    dropFrozenChunks(item->m_row);
+    markSnapshotStale();
+}
+
+/**
+ * Inserts a contiguous run of parts, which may carry subtrees of their own, before the given row.
+ *
+ * @param position The row the first inserted part will occupy, from 0 to childCount().
+ * @param items The parts to insert, in order. They must not have a parent yet.
+ */
+void ModelPart::insertChildren(int position, const QList<ModelPart*>& items) {
+    position = qBound(0, position, m_childItems.size());
+    QList<ModelPart*> children;
+    children.reserve(m_childItems.size() + items.size());
+    children.append(m_childItems.mid(0, position));
+    children.append(items);
+    children.append(m_childItems.mid(position));
+    m_childItems.swap(children);
+
+    for (ModelPart* item : items) {
+        item->m_parentItem = this;
+        item->markWorldDirty();
+    }
+    renumberChildren(position);
+    dropFrozenChunks(position);
+    markSnapshotStale();
+}
+
+/**
+ * Detaches a contiguous run of children without deleting them.
+ *
+ * @param position The index of the first child to detach.
+ * @param count The number of children to detach.
+ * @return The detached parts, which the caller now owns, or an empty list if the range is invalid.
+ */
+QList<ModelPart*> ModelPart::takeChildren(int position, int count) {
+    if (position < 0 || count <= 0 || position + count > m_childItems.size())
+        return {};
+
+    QList<ModelPart*> taken = m_childItems.mid(position, count);
+    m_childItems.erase(m_childItems.begin() + position, m_childItems.begin() + position + count);
+    for (ModelPart* item : taken) {
+        item->m_parentItem = nullptr;
+        item->m_row = 0;
+        item->markWorldDirty();
+    }
+    renumberChildren(position);
+    dropFrozenChunks(position);
+    markSnapshotStale();
+    return taken;
+}
+
+/**
+ * Gives the part a subtree that is only built when it is first needed.
+ *
+ * Until materializeChildren() runs, the part is a lightweight summary: it reports the number of
+ * children it will have, but none of them exist, so a collapsed group costs nothing however large.
+ *
+ * @param count The number of top-level children the loader will return, for display before loading.
+ * @param loader Function that builds the children, called at most once on the GUI thread.
+ */
+void ModelPart::setDeferredChildren(int count, std::function<QList<ModelPart*>()> loader) {
+    deferredCount = loader ? qMax(count, 0) : 0;
+    childLoader = std::move(loader);
+    markSnapshotStale();
+}
+
+/**
+ * Returns true if the part has children that have not been built yet.
+ */
+bool ModelPart::hasDeferredChildren() const {
+    return static_cast<bool>(childLoader);
+}
+
+/**
+ * Returns the number of children that have not been built yet.
+ */
+int ModelPart::deferredChildCount() const {
+    return childLoader ? deferredCount : 0;
+}
+
+/**
+ * Builds the deferred children, if any, and appends them after the existing ones.
+ */
+void ModelPart::materializeChildren() {
+    if (!childLoader)
+        return;
+
+    std::function<QList<ModelPart*>()> loader = std::move(childLoader);
+    childLoader = nullptr;
+    deferredCount = 0;
+    insertChildren(m_childItems.size(), loader());
 }
 
 /**
@@ -68,36 +226,22 @@ int ModelPart::childCount() const {
 }
 
 /**
- * Counts the number of columns of data.
+ * Gets the name of the model part.
  *
- * @return The number of columns of item data.
+ * @return The name shown in the tree.
  */
-int ModelPart::columnCount() const {
-    return m_itemData.count();
+QString ModelPart::name() const {
+    return PartStateStore::instance().name(stateId);
 }
 
 /**
- * Retrieves the data at the specified column.
+ * Sets the name of the model part.
  *
- * @param column The column from which to retrieve the data.
- * @return The data stored in the column.
+ * @param name The name shown in the tree.
  */
-QVariant ModelPart::data(int column) const {
-    if (column < 0 || column >= m_itemData.size())
-        return QVariant();
-    return m_itemData[column];
-}
-
-/**
- * Sets the data at a specified column.
- *
- * @param column The column where the data is to be set.
- * @param value The data value to set.
- */
-void ModelPart::set(int column, const QVariant& value) {
-    if (column >= 0 && column < m_itemData.size()) {
-        m_itemData[column] = value;
-    }
+void ModelPart::setName(const QString& name) {
+    PartStateStore::instance().setName(stateId, name);
+    markSnapshotStale();
 }
 
 /**
@@ -112,12 +256,13 @@ ModelPart* ModelPart::parentItem() {
 /**
  * Determines the row index of this item in the parent's child list.
  *
+ * The index is stored when the item is added and renumbered when an earlier sibling is removed,
+ * so views can look up parents without scanning the sibling list.
+ *
  * @return The index of this item.
  */
 int ModelPart::row() const {
-    if (m_parentItem)
-        return m_parentItem->m_childItems.indexOf(const_cast<ModelPart*>(this));
-    return 0;
+    return m_parentItem ? m_row : 0;
 }
 
 /**
@@ -127,8 +272,17 @@ int ModelPart::row() const {
  * @param count The number of children to remove.
  */
 void ModelPart::removeChildren(int position, int count) {
-    for (int row = 0; row < count; ++row) {
-        delete m_childItems.takeAt(position);
+    qDeleteAll(takeChildren(position, count));
+}
+
+/**
+ * Restores the stored row index of every child from the given position onwards.
+ *
+ * @param from The first index whose child may have moved.
+ */
+void ModelPart::renumberChildren(int from) {
+    for (int row = qMax(from, 0); row < m_childItems.size(); ++row) {
+        m_childItems[row]->m_row = row;
     }
 }
 
@@ -140,7 +294,8 @@ void ModelPart::removeChildren(int position, int count) {
  * @param B Blue component of the color.
  */
 void ModelPart::setColour(const unsigned char R, const unsigned char G, const unsigned char B) {
-    color = QColor(R, G, B);
+    PartStateStore::instance().setColour(stateId, qRgb(R, G, B));
+    markSnapshotStale();
 }
 
 /**
@@ -149,7 +304,7 @@ void ModelPart::setColour(const unsigned char R, const unsigned char G, const un
  * @return The red component value.
  */
 unsigned char ModelPart::getColourR() const {
-    return static_cast<unsigned char>(color.red());
+    return static_cast<unsigned char>(qRed(PartStateStore::instance().colour(stateId)));
 }
 
 /**
@@ -158,7 +313,7 @@ unsigned char ModelPart::getColourR() const {
  * @return The green component value.
  */
 unsigned char ModelPart::getColourG() const {
-    return static_cast<unsigned char>(color.green());
+    return static_cast<unsigned char>(qGreen(PartStateStore::instance().colour(stateId)));
 }
 
 /**
@@ -167,12 +322,12 @@ unsigned char ModelPart::getColourG() const {
  * @return The blue component value.
  */
 unsigned char ModelPart::getColourB() const {
-    return static_cast<unsigned char>(color.blue());
+    return static_cast<unsigned char>(qBlue(PartStateStore::instance().colour(stateId)));
 }
 
 
 QColor ModelPart::getColor() const {
-    return QColor(getColourR(), getColourG(), getColourB());
+    return QColor(PartStateStore::instance().colour(stateId));
 }
 /**
  * Sets the visibility of the model part.
@@ -180,7 +335,8 @@ QColor ModelPart::getColor() const {
  * @param isVisible Boolean indicating whether the part is visible.
  */
 void ModelPart::setVisible(bool isVisible) {
-    this->isVisible = isVisible;
+    PartStateStore::instance().setVisible(stateId, isVisible);
+    markSnapshotStale();
 }
 
 /**
@@ -188,26 +344,220 @@ void ModelPart::setVisible(bool isVisible) {
  *
  * @return True if visible, false otherwise.
  */
-bool ModelPart::visible() {
-    return isVisible;
+bool ModelPart::visible() const {
+    return PartStateStore::instance().visible(stateId);
+}
+
+/**
+ * Sets the opacity of the model part. Values outside 0 to 1 are clamped.
+ *
+ * @param value The opacity, from 0 (fully transparent) to 1 (opaque).
+ */
+void ModelPart::setOpacity(double value) {
+    PartStateStore::instance().setOpacity(stateId, static_cast<float>(qBound(0.0, value, 1.0)));
+    markSnapshotStale();
+}
+
+/**
+ * Returns the opacity of the model part.
+ *
+ * @return The opacity, from 0 (fully transparent) to 1 (opaque).
+ */
+double ModelPart::opacity() const {
+    return PartStateStore::instance().opacity(stateId);
 }
 
 /**
  * Loads an STL file and creates the associated VTK actor for rendering.
+ * The mesh comes from the GeometryCache, so parts loaded from the same file share it.
  *
  * @param fileName The path to the STL file.
  */
 void ModelPart::loadSTL(QString fileName) {
-    vtkNew<vtkSTLReader> reader;
-    reader->SetFileName(fileName.toStdString().c_str());
-    reader->Update();
+    setMesh(GeometryCache::instance().load(fileName));
+    sourceFileName = fileName;
+    markSnapshotStale();
 
     vtkNew<vtkPolyDataMapper> mapper;
-    mapper->SetInputConnection(reader->GetOutputPort());
+    mapper->SetInputData(polyData);
 
     vtkNew<vtkActor> actor;
     actor->SetMapper(mapper);
+    this->mapper = mapper;
     this->actor = actor;
+
+    buildLevelsOfDetail();
+    if (AmbientOcclusionBaker::hasOcclusion(polyData))
+        AmbientOcclusionBaker::enableShading(actor, lodMappers[0]);
+}
+
+/**
+ * Returns the STL file this part was loaded from.
+ *
+ * @return The file path, or an empty string for groups.
+ */
+QString ModelPart::sourceFile() const {
+    return sourceFileName;
+}
+
+/**
+ * Frees the GPU buffers held for this part in the given window.
+ * They are uploaded again the next time the part is drawn.
+ *
+ * @param window The render window whose context holds the buffers.
+ */
+void ModelPart::releaseGraphicsResources(vtkWindow* window) {
+    if (!actor)
+        return;
+
+    actor->ReleaseGraphicsResources(window);
+    for (const vtkSmartPointer<vtkPolyDataMapper>& lodMapper : lodMappers) {
+        if (lodMapper)
+            lodMapper->ReleaseGraphicsResources(window);
+    }
+}
+
+/**
+ * Drops this part's reference to its full-detail mesh.
+ * The cheaper detail levels are kept so that bounds and statistics stay available.
+ */
+void ModelPart::releaseGeometry() {
+    if (!polyData)
+        return;
+
+    lodMappers[0]->SetInputData(nullptr);
+    setMesh(nullptr);
+    markSnapshotStale(); // The frozen copy would otherwise keep the mesh alive in the cache
+}
+
+/**
+ * Reattaches a full-detail mesh previously dropped by releaseGeometry().
+ *
+ * @param geometry The mesh, normally obtained from the GeometryCache.
+ */
+void ModelPart::restoreGeometry(vtkSmartPointer<vtkPolyData> geometry) {
+    if (!lodMappers[0] || !geometry)
+        return;
+
+    setMesh(geometry);
+    lodMappers[0]->SetInputData(polyData);
+    if (AmbientOcclusionBaker::hasOcclusion(polyData))
+        AmbientOcclusionBaker::enableShading(actor, lodMappers[0]);
+    markSnapshotStale();
+}
+
+/**
+ * Replaces the full-detail mesh, keeping the GeometryCache's count of the parts holding each mesh.
+ *
+ * @param mesh The new mesh, or nullptr to hold none.
+ */
+void ModelPart::setMesh(vtkSmartPointer<vtkPolyData> mesh) {
+    if (mesh == polyData)
+        return;
+    if (polyData)
+        GeometryCache::instance().removeUser(polyData);
+    if (mesh)
+        GeometryCache::instance().addUser(mesh);
+    polyData = mesh;
+}
+
+/**
+ * Reports whether the full-detail mesh is held in memory.
+ *
+ * @return True if the part has geometry it can draw at full detail.
+ */
+bool ModelPart::geometryResident() const {
+    return polyData != nullptr;
+}
+
+/**
+ * Returns the memory used by the full-detail mesh.
+ *
+ * @return The size in bytes, or 0 if the mesh is not resident.
+ */
+qint64 ModelPart::geometryBytes() const {
+    return polyData ? static_cast<qint64>(polyData->GetActualMemorySize()) * 1024 : 0;
+}
+
+/**
+ * Builds the cheaper representations used while the camera is moving.
+ * Runs as part of loadSTL, so on the loader thread rather than mid-interaction.
+ */
+void ModelPart::buildLevelsOfDetail() {
+    lodMappers[0] = vtkPolyDataMapper::SafeDownCast(mapper);
+    lodPrimitives[0] = polyData->GetNumberOfPolys() + polyData->GetNumberOfStrips();
+
+    vtkNew<vtkQuadricClustering> clustering;
+    clustering->SetInputData(polyData);
+    clustering->SetNumberOfDivisions(32, 32, 32);
+    clustering->Update();
+
+    vtkNew<vtkMaskPoints> maskPoints;
+    maskPoints->SetInputData(polyData);
+    maskPoints->SetMaximumNumberOfPoints(4096);
+    maskPoints->RandomModeOn();
+    maskPoints->GenerateVerticesOn();
+    maskPoints->SingleVertexPerCellOn();
+    maskPoints->Update();
+
+    vtkNew<vtkOutlineFilter> outline;
+    outline->SetInputData(polyData);
+    outline->Update();
+
+    vtkPolyData* outputs[] = { clustering->GetOutput(), maskPoints->GetOutput(), outline->GetOutput() };
+    for (int level = 1; level < DetailLevelCount; ++level) {
+        vtkPolyData* output = outputs[level - 1];
+        lodMappers[level] = vtkSmartPointer<vtkPolyDataMapper>::New();
+        lodMappers[level]->SetInputData(output);
+        lodMappers[level]->ScalarVisibilityOff();
+        lodPrimitives[level] = output->GetNumberOfCells();
+    }
+}
+
+/**
+ * Swaps the mapper on the actor for the representation at the given detail level.
+ * Does nothing if the part has no geometry loaded.
+ *
+ * @param level The detail level to render with.
+ */
+void ModelPart::setDetailLevel(DetailLevel level) {
+    int slot = static_cast<int>(level);
+    if (level == currentDetail || !actor || !lodMappers[slot])
+        return;
+
+    actor->SetMapper(lodMappers[slot]);
+    currentDetail = level;
+}
+
+/**
+ * Returns the detail level currently attached to the actor.
+ *
+ * @return The current detail level.
+ */
+ModelPart::DetailLevel ModelPart::detailLevel() const {
+    return currentDetail;
+}
+
+/**
+ * Returns the mesh drawn at the given detail level.
+ * The meshes are shared, not copied, so other views can draw the part without reloading it.
+ *
+ * @param level The detail level to query.
+ * @return The mesh, or nullptr if no geometry is loaded.
+ */
+vtkPolyData* ModelPart::levelGeometry(DetailLevel level) const {
+    vtkPolyDataMapper* levelMapper = lodMappers[static_cast<int>(level)];
+    return levelMapper ? levelMapper->GetInput() : nullptr;
+}
+
+/**
+ * Returns the number of primitives the given detail level submits per frame.
+ *
+ * @param level The detail level to query.
+ * @return The primitive count, or 0 if no geometry is loaded.
+ */
+vtkIdType ModelPart::primitiveCount(DetailLevel level) const {
+    return lodPrimitives[static_cast<int>(level)];
 }
 
 /**
@@ -223,15 +573,15 @@ vtkSmartPointer<vtkActor> ModelPart::getActor() {
  * Creates and returns a new VTK actor based on the current model data.
  * Useful for creating duplicate representations of the model part.
  *
- * @return A new VTK actor, or nullptr if the original actor or reader is not set.
+ * @return A new VTK actor, or nullptr if the original actor or mesh is not set.
  */
 vtkSmartPointer<vtkActor> ModelPart::getNewActor() {
-    if (!this->actor || !this->reader) {
+    if (!this->actor || !this->polyData) {
         return nullptr;
     }
 
     vtkSmartPointer<vtkPolyDataMapper> newMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
-    newMapper->SetInputConnection(this->reader->GetOutputPort());
+    newMapper->SetInputData(this->polyData);
 
     vtkSmartPointer<vtkActor> newActor = vtkSmartPointer<vtkActor>::New();
     newActor->SetMapper(newMapper);
@@ -243,6 +593,224 @@ vtkSmartPointer<vtkActor> ModelPart::getNewActor() {
     return newActor;
 }
 
+/**
+ * Sets the part's transform relative to its parent.
+ * Descendants follow through their world matrices; no geometry is rewritten.
+ *
+ * @param position Translation relative to the parent.
+ * @param orientation Rotation about the X, Y and Z axes in degrees, applied in Z, Y, X order.
+ */
+void ModelPart::setLocalTransform(const double position[3], const double orientation[3]) {
+    for (int i = 0; i < 3; ++i) {
+        localPosition[i] = position[i];
+        localOrientation[i] = orientation[i];
+    }
+
+    bool identity = position[0] == 0.0 && position[1] == 0.0 && position[2] == 0.0 &&
+        orientation[0] == 0.0 && orientation[1] == 0.0 && orientation[2] == 0.0;
+    if (identity) {
+        localMatrix = nullptr;
+    }
+    else {
+        vtkNew<vtkTransform> transform;
+        transform->Translate(position[0], position[1], position[2]);
+        transform->RotateZ(orientation[2]);
+        transform->RotateY(orientation[1]);
+        transform->RotateX(orientation[0]);
+        if (!localMatrix)
+            localMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+        localMatrix->DeepCopy(transform->GetMatrix());
+    }
+    markWorldDirty();
+    markSnapshotStale();
+}
+
+/**
+ * Retrieves the part's transform relative to its parent.
+ *
+ * @param position Receives the translation relative to the parent.
+ * @param orientation Receives the rotation about the X, Y and Z axes in degrees.
+ */
+void ModelPart::getLocalTransform(double position[3], double orientation[3]) const {
+    for (int i = 0; i < 3; ++i) {
+        position[i] = localPosition[i];
+        orientation[i] = localOrientation[i];
+    }
+}
+
+/**
+ * Returns the part's transform from the root of the tree, recomposing it if needed.
+ *
+ * @return The world matrix, or nullptr if the part and all its ancestors are untransformed.
+ */
+vtkMatrix4x4* ModelPart::worldMatrix() {
+    if (!worldDirty)
+        return world;
+
+    // Recompose from the topmost dirty ancestor down; the parent of that one is up to date
+    std::vector<ModelPart*> chain;
+    for (ModelPart* part = this; part && part->worldDirty; part = part->m_parentItem)
+        chain.push_back(part);
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        ModelPart* part = *it;
+        vtkMatrix4x4* parentWorld = part->m_parentItem ? part->m_parentItem->world.GetPointer() : nullptr;
+        if (!parentWorld && !part->localMatrix) {
+            part->world = nullptr;
+        }
+        else {
+            if (!part->world)
+                part->world = vtkSmartPointer<vtkMatrix4x4>::New();
+            if (parentWorld && part->localMatrix)
+                vtkMatrix4x4::Multiply4x4(parentWorld, part->localMatrix, part->world);
+            else
+                part->world->DeepCopy(parentWorld ? parentWorld : part->localMatrix.GetPointer());
+        }
+        part->worldDirty = false;
+    }
+    return world;
+}
+
+/**
+ * Recomposes every dirty world matrix in this subtree and applies it to the actors.
+ * Only branches flagged as dirty are visited, so the call is cheap when nothing moved.
+ *
+ * @param moved If not null, receives every part with an actor whose world matrix was reapplied.
+ */
+void ModelPart::updateWorldTransforms(QList<ModelPart*>* moved) {
+    std::vector<ModelPart*> stack{ this };
+    while (!stack.empty()) {
+        ModelPart* part = stack.back();
+        stack.pop_back();
+        if (part->actorMatrixStale) {
+            vtkMatrix4x4* matrix = part->worldMatrix();
+            vtkActor* partActor = part->actor;
+            if (partActor && partActor->GetUserMatrix() != matrix)
+                partActor->SetUserMatrix(matrix);
+            else if (partActor && matrix)
+                partActor->Modified();
+            if (partActor && moved)
+                moved->append(part);
+            part->actorMatrixStale = false;
+        }
+
+        if (part->descendantsDirty) {
+            for (int row = part->m_childItems.size() - 1; row >= 0; --row)
+                stack.push_back(part->m_childItems[row]);
+            part->descendantsDirty = false;
+        }
+    }
+}
+
+/**
+ * Flags this part's subtree as needing new world matrices and tells the ancestors where to look.
+ */
+void ModelPart::markWorldDirty() {
+    std::vector<ModelPart*> stack{ this };
+    while (!stack.empty()) {
+        ModelPart* part = stack.back();
+        stack.pop_back();
+        part->worldDirty = true;
+        part->actorMatrixStale = true;
+        part->descendantsDirty = !part->m_childItems.isEmpty();
+        stack.insert(stack.end(), part->m_childItems.begin(), part->m_childItems.end());
+    }
+
+    for (ModelPart* ancestor = m_parentItem; ancestor && !ancestor->descendantsDirty; ancestor = ancestor->m_parentItem)
+        ancestor->descendantsDirty = true;
+}
+
+/**
+ * Returns an immutable copy of the part and its built subtree, for a SceneSnapshot.
+ *
+ * The copies made by earlier calls are reused for every part and run of children that has not
+ * changed since, so the cost is proportional to the parts changed. Changed parts are frozen
+ * children first from an explicit stack, so a tree of any depth can be frozen. GUI thread only.
+ *
+ * @return The frozen part.
+ */
+std::shared_ptr<const SnapshotNode> ModelPart::freeze() {
+    const int capacity = SnapshotChunk::Capacity;
+
+    // The flag marks parts whose changed children have been frozen
+    std::vector<std::pair<ModelPart*, bool>> stack{ { this, false } };
+    while (!stack.empty()) {
+        ModelPart* part = stack.back().first;
+        if (part->frozen) {
+            stack.pop_back();
+            continue;
+        }
+
+        const int childCount = part->m_childItems.size();
+        if (!stack.back().second) {
+            stack.back().second = true;
+            part->frozenChunks.resize((childCount + capacity - 1) / capacity);
+            for (std::size_t chunk = 0; chunk < part->frozenChunks.size(); ++chunk) {
+                if (part->frozenChunks[chunk])
+                    continue;
+                int first = static_cast<int>(chunk) * capacity;
+                int last = qMin(first + capacity, childCount);
+                for (int row = first; row < last; ++row)
+                    stack.push_back({ part->m_childItems[row], false });
+            }
+            continue;
+        }
+        stack.pop_back();
+
+        std::shared_ptr<SnapshotNode> node = std::make_shared<SnapshotNode>();
+        node->id = part->partId;
+        node->name = part->name();
+        node->visible = part->visible();
+        node->colour = PartStateStore::instance().colour(part->stateId);
+        node->opacity = static_cast<float>(part->opacity());
+        part->getLocalTransform(node->position, node->orientation);
+        node->sourceFile = part->sourceFileName;
+        node->geometry = part->polyData;
+        node->deferredChildren = part->deferredChildCount();
+        node->childCount = childCount;
+
+        for (std::size_t chunk = 0; chunk < part->frozenChunks.size(); ++chunk) {
+            if (part->frozenChunks[chunk])
+                continue;
+            std::shared_ptr<SnapshotChunk> children = std::make_shared<SnapshotChunk>();
+            int first = static_cast<int>(chunk) * capacity;
+            int last = qMin(first + capacity, childCount);
+            children->nodes.reserve(last - first);
+            for (int row = first; row < last; ++row)
+                children->nodes.push_back(part->m_childItems[row]->frozen);
+            part->frozenChunks[chunk] = children;
+        }
+        node->chunks = part->frozenChunks;
+        part->frozen = node;
+    }
+    return frozen;
+}
+
+/**
+ * Drops the frozen copies of this part and its ancestors, and the frozen chunks holding them.
+ * A part without a frozen copy never has an ancestor with one, so the walk stops at the first.
+ */
+void ModelPart::markSnapshotStale() {
+    for (ModelPart* part = this; part && part->frozen; part = part->m_parentItem) {
+        part->frozen = nullptr;
+        ModelPart* parent = part->m_parentItem;
+        std::size_t chunk = part->m_row / SnapshotChunk::Capacity;
+        if (parent && chunk < parent->frozenChunks.size())
+            parent->frozenChunks[chunk] = nullptr;
+    }
+}
+
+/**
+ * Drops the frozen chunks from the one holding the given row onwards, after rows were inserted
+ * or removed there.
+ *
+ * @param fromRow The first row that may have changed.
+ */
+void ModelPart::dropFrozenChunks(int fromRow) {
+    std::size_t chunk = qMax(fromRow, 0) / SnapshotChunk::Capacity;
+    if (chunk < frozenChunks.size())
+        frozenChunks.resize(chunk);
+}
+
 /**
  * Removes a single child from the model part at the specified position.
  *
@@ -253,4 +821,7 @@ void ModelPart::removeChild(int position) {
         return;
 
     delete m_childItems.takeAt(position);
+    renumberChildren(position);
+    dropFrozenChunks(position);
+    markSnapshotStale();
 }
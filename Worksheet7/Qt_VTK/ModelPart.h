@@ -12,15 +12,24 @@
 
 #include <QString>
 #include <QList>
-#include <QVariant>
 #include <QColor>
+#include <cstddef>
+#include <functional>
 #include <memory>
 #include <vector>
 #include <vtkSmartPointer.h>
 #include <vtkMapper.h>
+#include <vtkPolyDataMapper.h>
 #include <vtkActor.h>
 #include <vtkSTLReader.h>
 #include <vtkColor.h>
+#include <vtkPolyData.h>
+#include <vtkMatrix4x4.h>
+
+class vtkWindow;
+class NodePool;
+struct SnapshotNode;
+struct SnapshotChunk;
 
  /**
   * @class ModelPart
@@ -28,18 +37,43 @@
   *
   * This class encapsulates a part or component of a 3D model, supporting hierarchical structuring,
   * visualization properties like color and visibility, and the ability to load geometrical data from STL files.
+  * The name and visualization properties are kept in the PartStateStore under the part's state ID.
+  * Parts are allocated from a NodePool, so a tree is built and torn down in arenas of parts.
+  * Each part has a 64-bit ID, registered in the PartRegistry, that stays the same while the part
+  * moves in the tree and is never given to another part, so other subsystems keep IDs rather than
+  * pointers to parts they do not own.
+  * A part keeps the frozen copy of itself made for the last SceneSnapshot until it changes.
+  * Parts in the tree are read and changed on the GUI thread only; a detached part may be built on
+  * a worker before it is inserted. Other threads read the tree through snapshots.
   */
 class ModelPart {
 public:
-    ModelPart(const QList<QVariant>& data, ModelPart* parent = nullptr);
+    /**
+     * @brief Rendering representations of a part, ordered from most to least expensive.
+     */
+    enum class DetailLevel { Full, Decimated, Points, BoundingBox };
+    static constexpr int DetailLevelCount = 4; ///< Number of entries in DetailLevel.
+
+    explicit ModelPart(const QString& name, ModelPart* parent = nullptr);
     ~ModelPart();
 
+    static void* operator new(std::size_t size);
+    static void operator delete(void* part);
+    static NodePool& pool();
+
+    quint64 id() const;
+
     void appendChild(ModelPart* item);
+    void insertChildren(int position, const QList<ModelPart*>& items);
+    QList<ModelPart*> takeChildren(int position, int count);
+    void setDeferredChildren(int count, std::function<QList<ModelPart*>()> loader);
+    bool hasDeferredChildren() const;
+    int deferredChildCount() const;
+    void materializeChildren();
     ModelPart* child(int row);
     int childCount() const;
-    int columnCount() const;
-    QVariant data(int column) const;
-    void set(int column, const QVariant& value);
+    QString name() const;
+    void setName(const QString& name);
     ModelPart* parentItem();
     int row() const;
     void setColour(const unsigned char R, const unsigned char G, const unsigned char B);
@@ -47,23 +81,62 @@ public:
     unsigned char getColourG() const;
     unsigned char getColourB() const;
     void setVisible(bool isVisible);
-    bool visible();
+    bool visible() const;
+    void setOpacity(double value);
+    double opacity() const;
     void loadSTL(QString fileName);
     void removeChild(int position);
     void removeChildren(int position, int count);
     vtkSmartPointer<vtkActor> getActor();
     vtkSmartPointer<vtkActor> getNewActor();
     QColor getColor() const;
+    void setDetailLevel(DetailLevel level);
+    DetailLevel detailLevel() const;
+    vtkIdType primitiveCount(DetailLevel level) const;
+    vtkPolyData* levelGeometry(DetailLevel level) const;
+    QString sourceFile() const;
+    void releaseGraphicsResources(vtkWindow* window);
+    void releaseGeometry();
+    void restoreGeometry(vtkSmartPointer<vtkPolyData> geometry);
+    bool geometryResident() const;
+    qint64 geometryBytes() const;
+    void setLocalTransform(const double position[3], const double orientation[3]);
+    void getLocalTransform(double position[3], double orientation[3]) const;
+    vtkMatrix4x4* worldMatrix();
+    void updateWorldTransforms(QList<ModelPart*>* moved = nullptr);
+    std::shared_ptr<const SnapshotNode> freeze();
 
 private:
+    void setMesh(vtkSmartPointer<vtkPolyData> mesh);
+    void buildLevelsOfDetail();
+    void markWorldDirty();
+    void markSnapshotStale();
+    void dropFrozenChunks(int fromRow);
+    void renumberChildren(int from);
+
     QList<ModelPart*> m_childItems; ///< Child parts of this model part.
-    QList<QVariant> m_itemData; ///< Data associated with this part, like name and visibility.
+    quint64 partId; ///< Stable ID of this part in the PartRegistry.
+    quint32 stateId; ///< ID of this part's name, visibility, colour and opacity in the PartStateStore.
     ModelPart* m_parentItem; ///< Parent part of this model part.
-    bool isVisible; ///< Visibility state of this part.
-    QColor color; ///< Color of this part.
-    vtkSmartPointer<vtkSTLReader> reader; ///< STL reader for loading geometrical data.
+    int m_row = 0; ///< Index of this part in its parent's child list, kept current on insert and remove.
+    std::function<QList<ModelPart*>()> childLoader; ///< Builds the deferred children on first expansion, or empty.
+    int deferredCount = 0; ///< Number of children childLoader will build.
+    QString sourceFileName; ///< STL file the geometry was loaded from.
+    vtkSmartPointer<vtkPolyData> polyData; ///< Full-detail mesh, shared through the GeometryCache.
     vtkSmartPointer<vtkMapper> mapper; ///< Mapper for geometrical data.
     vtkSmartPointer<vtkActor> actor; ///< Actor for rendering.
+    vtkSmartPointer<vtkPolyDataMapper> lodMappers[DetailLevelCount]; ///< Mappers for each detail level, indexed by DetailLevel.
+    vtkIdType lodPrimitives[DetailLevelCount] = {}; ///< Primitives submitted by each detail level.
+    DetailLevel currentDetail = DetailLevel::Full; ///< Detail level currently attached to the actor.
+    double localPosition[3] = { 0.0, 0.0, 0.0 }; ///< Translation relative to the parent.
+    double localOrientation[3] = { 0.0, 0.0, 0.0 }; ///< Rotation about X, Y and Z relative to the parent, in degrees.
+    vtkSmartPointer<vtkMatrix4x4> localMatrix; ///< Transform relative to the parent, or nullptr for identity.
+    vtkSmartPointer<vtkMatrix4x4> world; ///< Composed transform from the root, or nullptr for identity.
+    bool worldDirty = false; ///< True if world must be recomposed because this part or an ancestor moved.
+    bool actorMatrixStale = false; ///< True if the actor has not yet been given the current world matrix.
+    bool descendantsDirty = false; ///< True if some descendant has a stale actor matrix.
+    std::shared_ptr<const SnapshotNode> frozen; ///< This part as of the last freeze(), or nullptr if it changed since.
+    std::vector<std::shared_ptr<const SnapshotChunk>> frozenChunks; ///< Children as of the last freeze(), by chunk; nullptr where they changed since.
 };
 
 #endif // VIEWER_MODELPART_H
@@ -8,8 +8,16 @@
  */
 
 #include "ModelPartList.h"
+#include <QColor>
 #include "ModelPart.h"
+#include "PartRegistry.h"
 #include <QStandardItem>
+#include <QLocale>
+#include <QTimer>
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <vector>
 
  /**
   * @brief Constructor for ModelPartList.
@@ -19,8 +27,10 @@
   * @param data String data used for initialization.
   * @param parent Pointer to the parent QObject.
   */
-ModelPartList::ModelPartList(const QString& data, QObject* parent) : QAbstractItemModel(parent) {
-    rootItem = new ModelPart({ tr("Part"), tr("Visible?"), tr("Colour") });
+ModelPartList::ModelPartList(const QString& data, QObject* parent)
+    : QAbstractItemModel(parent), pageSize(256), statisticsUpdateScheduled(false) {
+    rootItem = new ModelPart(tr("Parts"));
+    aggregates.insertSubtree(rootItem);
 }
 
 /**
@@ -39,7 +49,7 @@ ModelPartList::~ModelPartList() {
  * @return The number of columns under the given parent.
  */
 int ModelPartList::columnCount(const QModelIndex& parent) const {
-    return rootItem->columnCount();
+    return ColumnCount;
 }
 
 /**
@@ -50,11 +60,59 @@ int ModelPartList::columnCount(const QModelIndex& parent) const {
  * @return The data stored under the given role for the item referred to by the index.
  */
 QVariant ModelPartList::data(const QModelIndex& index, int role) const {
-    if (!index.isValid() || role != Qt::DisplayRole)
+    if (!index.isValid())
         return QVariant();
 
     auto* item = static_cast<ModelPart*>(index.internalPointer());
-    return item ? item->data(index.column()) : QVariant();
+    if (!item)
+        return QVariant();
+    if (role == Qt::ToolTipRole && index.column() == 0) {
+        // Summary of a group, available without expanding or loading it
+        int loaded = item->childCount();
+        int deferred = item->deferredChildCount();
+        if (deferred > 0)
+            return tr("%n part(s), not loaded", nullptr, loaded + deferred);
+        if (loaded > 0)
+            return tr("%n part(s)", nullptr, loaded);
+        return QVariant();
+    }
+    if (role == Qt::BackgroundRole)
+        return highlighted.contains(item->id()) ? QVariant(QColor(255, 236, 140)) : QVariant();
+    if (role == Qt::TextAlignmentRole && index.column() >= FirstStatisticsColumn)
+        return QVariant(Qt::AlignRight | Qt::AlignVCenter);
+    if (role != Qt::DisplayRole)
+        return QVariant();
+
+    if (index.column() >= FirstStatisticsColumn) {
+        SubtreeAggregates::Totals totals = aggregates.totals(item);
+        QLocale locale;
+        switch (index.column() - FirstStatisticsColumn) {
+        case 0:
+            return locale.toString(totals.parts);
+        case 1:
+            return locale.toString(totals.triangles);
+        case 2:
+            return locale.toString(totals.shownTriangles);
+        case 3:
+            return locale.toString(totals.vertices);
+        case 4:
+            return locale.formattedDataSize(totals.memory);
+        }
+        return QVariant();
+    }
+
+    // Display strings are built on demand from the part's typed state
+    switch (index.column()) {
+    case 0:
+        return item->name();
+    case 1:
+        return item->visible() ? QStringLiteral("true") : QStringLiteral("false");
+    case 2:
+        return QStringLiteral("%1,%2,%3").arg(item->getColourR()).arg(item->getColourG()).arg(item->getColourB());
+    case 3:
+        return QString::number(item->opacity(), 'f', 2);
+    }
+    return QVariant();
 }
 
 /**
@@ -76,8 +134,28 @@ Qt::ItemFlags ModelPartList::flags(const QModelIndex& index) const {
  * @return The data for the given header section.
  */
 QVariant ModelPartList::headerData(int section, Qt::Orientation orientation, int role) const {
-    if (orientation == Qt::Horizontal && role == Qt::DisplayRole)
-        return rootItem->data(section);
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        switch (section) {
+        case 0:
+            return tr("Part");
+        case 1:
+            return tr("Visible?");
+        case 2:
+            return tr("Colour");
+        case 3:
+            return tr("Opacity");
+        case 4:
+            return tr("Parts");
+        case 5:
+            return tr("Triangles");
+        case 6:
+            return tr("Shown Triangles");
+        case 7:
+            return tr("Vertices");
+        case 8:
+            return tr("Memory");
+        }
+    }
 
     return QVariant();
 }
@@ -124,8 +202,141 @@ int ModelPartList::rowCount(const QModelIndex& parent) const {
     if (parent.isValid() && parent.column() != 0)
         return 0;
 
+    return exposedRows(getItem(parent));
+}
+
+/**
+ * @brief Reports whether the given parent has children, fetched or not.
+ *
+ * Lets views draw an expander for groups whose children have not been fetched or built yet.
+ *
+ * @param parent The parent index.
+ * @return True if the parent has or will have children.
+ */
+bool ModelPartList::hasChildren(const QModelIndex& parent) const {
+    if (parent.isValid() && parent.column() != 0)
+        return false;
+
     ModelPart* parentItem = getItem(parent);
-    return parentItem ? parentItem->childCount() : 0;
+    return parentItem && (parentItem->childCount() > 0 || parentItem->hasDeferredChildren());
+}
+
+/**
+ * @brief Reports whether the given parent has children not yet exposed to views.
+ *
+ * @param parent The parent index.
+ * @return True if fetchMore() would add rows.
+ */
+bool ModelPartList::canFetchMore(const QModelIndex& parent) const {
+    if (parent.isValid() && parent.column() != 0)
+        return false;
+
+    ModelPart* parentItem = getItem(parent);
+    return parentItem && (parentItem->hasDeferredChildren() || exposedRows(parentItem) < parentItem->childCount());
+}
+
+/**
+ * @brief Exposes the next page of children of the given parent to views.
+ *
+ * Deferred children are built first, the first time the parent is fetched.
+ *
+ * @param parent The parent index.
+ */
+void ModelPartList::fetchMore(const QModelIndex& parent) {
+    ModelPart* parentItem = getItem(parent);
+    if (!parentItem)
+        return;
+
+    if (buildDeferredChildren(parentItem)) {
+        emit attributesChanged();
+        scheduleStatisticsUpdate();
+    }
+    int first = exposedRows(parentItem);
+    int count = qMin(pageSize, parentItem->childCount() - first);
+    if (count <= 0)
+        return;
+
+    beginInsertRows(parent, first, first + count - 1);
+    exposed[parentItem] = first + count;
+    endInsertRows();
+}
+
+/**
+ * @brief Builds every deferred child in a part's subtree, without exposing new rows to views.
+ *
+ * Edits that apply to a whole subtree call this first, so that parts not loaded yet are not
+ * left with their old properties. The new parts are indexed as fetchMore() would index them.
+ *
+ * @param part The root of the subtree.
+ */
+void ModelPartList::materializeSubtree(ModelPart* part) {
+    bool built = false;
+    std::vector<ModelPart*> stack{ part };
+    while (!stack.empty()) {
+        ModelPart* current = stack.back();
+        stack.pop_back();
+        if (buildDeferredChildren(current)) {
+            built = true;
+            notifyPartChanged(current); // Its summary no longer counts parts as not loaded
+        }
+        for (int row = current->childCount() - 1; row >= 0; --row)
+            stack.push_back(current->child(row));
+    }
+    if (built) {
+        emit attributesChanged();
+        scheduleStatisticsUpdate();
+    }
+}
+
+/**
+ * @brief Builds a part's deferred children and adds them to the name, attribute and statistics indexes.
+ *
+ * @param part The part whose children to build.
+ * @return True if the part had deferred children.
+ */
+bool ModelPartList::buildDeferredChildren(ModelPart* part) {
+    if (!part || !part->hasDeferredChildren())
+        return false;
+
+    int built = part->childCount();
+    part->materializeChildren();
+    for (int row = built; row < part->childCount(); ++row) {
+        names.insertSubtree(part->child(row));
+        attributeStore.insertSubtree(part->child(row));
+        aggregates.insertSubtree(part->child(row));
+    }
+    return true;
+}
+
+/**
+ * @brief Sets how many children each fetchMore() exposes.
+ *
+ * @param rows The page size, at least 1.
+ */
+void ModelPartList::setFetchPageSize(int rows) {
+    pageSize = qMax(rows, 1);
+}
+
+/**
+ * @brief Returns the number of leading children of a part that views have fetched.
+ */
+int ModelPartList::exposedRows(const ModelPart* part) const {
+    return part ? qMin(exposed.value(part, 0), part->childCount()) : 0;
+}
+
+/**
+ * @brief Drops the fetch state of a part and its descendants before they leave the model.
+ */
+void ModelPartList::forgetSubtree(ModelPart* part) {
+    std::vector<ModelPart*> stack{ part };
+    while (!stack.empty()) {
+        ModelPart* current = stack.back();
+        stack.pop_back();
+        if (exposed.remove(current) == 0)
+            continue; // Nothing below an unfetched part can have been fetched
+        for (int row = 0; row < current->childCount(); ++row)
+            stack.push_back(current->child(row));
+    }
 }
 
 /**
@@ -141,16 +352,81 @@ ModelPart* ModelPartList::getRootItem() {
  * @brief Appends a child to a given parent in the model.
  *
  * @param parent The parent index to which the child is appended.
- * @param data The data for the new child.
+ * @param name The name of the new child.
  * @return The index of the newly added child.
  */
-QModelIndex ModelPartList::appendChild(QModelIndex& parent, const QList<QVariant>& data) {
-    ModelPart* parentPart = getItem(parent);
-    beginInsertRows(parent, rowCount(parent), rowCount(parent));
-    ModelPart* childPart = new ModelPart(data, parentPart);
-    parentPart->appendChild(childPart);
-    endInsertRows();
-    return createIndex(rowCount(parent) - 1, 0, childPart);
+QModelIndex ModelPartList::appendChild(QModelIndex& parent, const QString& name) {
+    ModelPart* childPart = new ModelPart(name);
+    appendParts({ childPart }, parent);
+    return createIndex(childPart->row(), 0, childPart);
+}
+
+/**
+ * @brief Inserts prebuilt parts, with any subtrees they carry, as contiguous children of a parent.
+ *
+ * Views receive a single rowsInserted notification for the run, however many descendants it
+ * contains, or none if the run lies beyond the rows they have fetched. A run longer than a page
+ * is exposed one page at a time like any other children: views are shown its first page, and the
+ * fetched rows it displaces are withdrawn, to come back through fetchMore() after the run.
+ *
+ * @param position The row the first part will occupy, from 0 to the parent's row count.
+ * @param parts The parts to insert, in order. They must not have a parent yet; the model takes ownership.
+ * @param parentIndex The parent to insert under.
+ * @return True if the parts were inserted; otherwise false.
+ */
+bool ModelPartList::insertParts(int position, const QList<ModelPart*>& parts, const QModelIndex& parentIndex) {
+    ModelPart* parentItem = getItem(parentIndex);
+    if (!parentItem || position < 0 || position > parentItem->childCount())
+        return false;
+    if (parts.isEmpty())
+        return true;
+
+    for (ModelPart* part : parts) {
+        names.insertSubtree(part);
+        attributeStore.insertSubtree(part);
+    }
+    emit attributesChanged();
+
+    int fetched = exposedRows(parentItem);
+    if (position > fetched) {
+        parentItem->insertChildren(position, parts); // Beyond what views have fetched; they see it when they page on
+    }
+    else if (parts.size() <= pageSize) {
+        beginInsertRows(parentIndex, position, position + parts.size() - 1);
+        parentItem->insertChildren(position, parts);
+        exposed[parentItem] = fetched + parts.size();
+        endInsertRows();
+    }
+    else {
+        if (position < fetched) {
+            beginRemoveRows(parentIndex, position, fetched - 1);
+            for (int row = position; row < fetched; ++row)
+                forgetSubtree(parentItem->child(row));
+            exposed[parentItem] = position;
+            endRemoveRows();
+        }
+        beginInsertRows(parentIndex, position, position + pageSize - 1);
+        parentItem->insertChildren(position, parts);
+        exposed[parentItem] = position + pageSize;
+        endInsertRows();
+    }
+
+    for (ModelPart* part : parts)
+        aggregates.insertSubtree(part); // Once attached, so the parent chain is known
+    scheduleStatisticsUpdate();
+    return true;
+}
+
+/**
+ * @brief Appends prebuilt parts after the existing children of a parent.
+ *
+ * @param parts The parts to append, in order. They must not have a parent yet; the model takes ownership.
+ * @param parentIndex The parent to append to.
+ * @return True if the parts were appended; otherwise false.
+ */
+bool ModelPartList::appendParts(const QList<ModelPart*>& parts, const QModelIndex& parentIndex) {
+    ModelPart* parentItem = getItem(parentIndex);
+    return insertParts(parentItem ? parentItem->childCount() : 0, parts, parentIndex);
 }
 
 /**
@@ -166,13 +442,318 @@ bool ModelPartList::removeRows(int position, int rows, const QModelIndex& parent
     if (!parentItem || position < 0 || position + rows > parentItem->childCount())
         return false;
 
-    beginRemoveRows(parentIndex, position, position + rows - 1);
-    for (int row = 0; row < rows; ++row) {
-        parentItem->removeChild(position);
+    qDeleteAll(takeRows(position, rows, parentIndex));
+    return true;
+}
+
+/**
+ * @brief Deletes a set of parts, with their subtrees, from anywhere in the tree.
+ *
+ * @param parts The parts to delete. None may be a descendant of another, nor the root.
+ * @return The number of parts deleted, not counting their descendants.
+ */
+int ModelPartList::removeParts(const QList<ModelPart*>& parts) {
+    QList<ModelPart*> taken = takeParts(parts);
+    qDeleteAll(taken);
+    return taken.size();
+}
+
+/**
+ * @brief Detaches a set of parts, with their subtrees, from anywhere in the tree without deleting them.
+ *
+ * The parts are grouped by parent and each parent's rows are taken as contiguous runs, from the
+ * last run to the first so earlier rows keep their positions. A selection of adjacent siblings is
+ * therefore detached with one notification for the parent.
+ *
+ * @param parts The parts to detach. None may be a descendant of another, nor the root.
+ * @return The detached parts, which the caller now owns.
+ */
+QList<ModelPart*> ModelPartList::takeParts(const QList<ModelPart*>& parts) {
+    QHash<ModelPart*, QList<int>> rowsByParent;
+    for (ModelPart* part : parts) {
+        if (part && part != rootItem && part->parentItem())
+            rowsByParent[part->parentItem()].append(part->row());
+    }
+
+    QList<ModelPart*> taken;
+    for (auto it = rowsByParent.begin(); it != rowsByParent.end(); ++it) {
+        ModelPart* parentItem = it.key();
+        QList<int>& rows = it.value();
+        std::sort(rows.begin(), rows.end(), std::greater<int>());
+        rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+        QModelIndex parentIndex = parentItem == rootItem ? QModelIndex() : createIndex(parentItem->row(), 0, parentItem);
+        for (int first = 0; first < rows.size();) {
+            int last = first;
+            while (last + 1 < rows.size() && rows[last + 1] == rows[last] - 1)
+                ++last;
+            taken.append(takeRows(rows[last], last - first + 1, parentIndex));
+            first = last + 1;
+        }
+    }
+    return taken;
+}
+
+/**
+ * @brief Detaches a number of rows from the model without deleting their parts.
+ *
+ * @param position The position to start detaching rows.
+ * @param rows The number of rows to detach.
+ * @param parentIndex The parent from which the rows will be detached.
+ * @return The detached parts with their subtrees, which the caller now owns, or an empty list on failure.
+ */
+QList<ModelPart*> ModelPartList::takeRows(int position, int rows, const QModelIndex& parentIndex) {
+    ModelPart* parentItem = getItem(parentIndex);
+    if (!parentItem || rows <= 0 || position < 0 || position + rows > parentItem->childCount())
+        return {};
+
+    for (int row = position; row < position + rows; ++row) {
+        forgetSubtree(parentItem->child(row));
+        names.removeSubtree(parentItem->child(row));
+        attributeStore.removeSubtree(parentItem->child(row));
+        aggregates.removeSubtree(parentItem->child(row));
+        dropHighlight(parentItem->child(row));
     }
+    emit attributesChanged();
+    scheduleStatisticsUpdate();
+
+    int fetched = exposedRows(parentItem);
+    int visible = qMin(position + rows, fetched) - position;
+    if (visible <= 0)
+        return parentItem->takeChildren(position, rows);
+
+    beginRemoveRows(parentIndex, position, position + visible - 1);
+    QList<ModelPart*> taken = parentItem->takeChildren(position, rows);
+    exposed[parentItem] = fetched - visible;
     endRemoveRows();
 
-    return true;
+    return taken;
+}
+
+/**
+ * @brief Renames a part and updates the search index and views.
+ *
+ * @param part The part to rename.
+ * @param name The new name.
+ */
+void ModelPartList::renamePart(ModelPart* part, const QString& name) {
+    if (!part || part->name() == name)
+        return;
+
+    part->setName(name);
+    names.rename(part);
+    notifyPartChanged(part);
+}
+
+/**
+ * @brief Applies a batch of property edits to the model in a single pass.
+ *
+ * Each edited part is updated once. Views then get one dataChanged range per parent, spanning the
+ * edited rows they have fetched, and filters get one attributesChanged signal.
+ *
+ * @param transaction The edits to apply. Parts must belong to this model.
+ */
+void ModelPartList::applyProperties(const PropertyTransaction& transaction) {
+    if (transaction.isEmpty())
+        return;
+
+    struct RowRange {
+        int first = INT_MAX; ///< Lowest edited row views have fetched.
+        int last = -1; ///< Highest edited row views have fetched.
+        int exposedLimit = 0; ///< Rows of the parent views have fetched, 0 if the parent itself is not exposed.
+    };
+    QHash<ModelPart*, RowRange> changedRows;
+
+    for (const PropertyTransaction::Edit& edit : transaction.edits()) {
+        ModelPart* part = edit.part;
+        if (edit.fields & PropertyTransaction::Name && part->name() != edit.name) {
+            part->setName(edit.name);
+            names.rename(part);
+        }
+        if (edit.fields & PropertyTransaction::Visible)
+            part->setVisible(edit.visible);
+        if (edit.fields & PropertyTransaction::Colour)
+            part->setColour(edit.colour.red(), edit.colour.green(), edit.colour.blue());
+        if (edit.fields & PropertyTransaction::Opacity)
+            part->setOpacity(edit.opacity);
+        attributeStore.update(part);
+        aggregates.update(part);
+
+        ModelPart* parentItem = part->parentItem();
+        if (!parentItem)
+            continue;
+        auto it = changedRows.find(parentItem);
+        if (it == changedRows.end()) {
+            RowRange range;
+            range.exposedLimit = isExposed(parentItem) ? exposedRows(parentItem) : 0;
+            it = changedRows.insert(parentItem, range);
+        }
+        if (part->row() < it->exposedLimit) {
+            it->first = qMin(it->first, part->row());
+            it->last = qMax(it->last, part->row());
+        }
+    }
+
+    for (auto it = changedRows.cbegin(); it != changedRows.cend(); ++it) {
+        if (it->last < 0)
+            continue;
+        ModelPart* parentItem = it.key();
+        QModelIndex parentIndex = parentItem == rootItem ? QModelIndex() : createIndex(parentItem->row(), 0, parentItem);
+        emit dataChanged(index(it->first, 0, parentIndex), index(it->last, FirstStatisticsColumn - 1, parentIndex));
+    }
+    emit attributesChanged();
+    scheduleStatisticsUpdate();
+}
+
+/**
+ * @brief Returns a consistent, read-only version of the tree for background tasks.
+ *
+ * Only the parts changed since the last snapshot are copied, so this is cheap however large the
+ * tree is. Parts whose children have not been built yet appear without them.
+ *
+ * @return The snapshot, which may be read from any thread.
+ */
+SceneSnapshot ModelPartList::snapshot() {
+    return SceneSnapshot(rootItem->freeze());
+}
+
+/**
+ * @brief Returns the search index over the names of the parts in the model.
+ */
+const PartNameIndex& ModelPartList::nameIndex() const {
+    return names;
+}
+
+/**
+ * @brief Returns the attribute table of the parts in the model.
+ */
+const PartAttributeStore& ModelPartList::attributes() const {
+    return attributeStore;
+}
+
+/**
+ * @brief Copies a part's current geometry, residency and visibility into the attribute table.
+ *
+ * @param part The part whose attributes changed.
+ */
+void ModelPartList::refreshAttributes(ModelPart* part) {
+    attributeStore.update(part);
+    aggregates.update(part);
+    emit attributesChanged();
+    scheduleStatisticsUpdate();
+}
+
+/**
+ * @brief Measures the subtree statistics and bounds of parts again, such as after they moved.
+ *
+ * @param parts The parts that changed.
+ */
+void ModelPartList::refreshAggregates(const QList<ModelPart*>& parts) {
+    for (ModelPart* part : parts)
+        aggregates.update(part);
+    scheduleStatisticsUpdate();
+}
+
+/**
+ * @brief Returns the statistics of a part's subtree, including the part itself.
+ */
+SubtreeAggregates::Totals ModelPartList::subtreeTotals(const ModelPart* part) const {
+    return aggregates.totals(part);
+}
+
+/**
+ * @brief Returns the world bounds of a part's subtree, invalid if it has no geometry.
+ */
+vtkBoundingBox ModelPartList::subtreeBounds(ModelPart* part) {
+    return aggregates.bounds(part);
+}
+
+/**
+ * @brief Queues a repaint of the statistics of changed rows on the event loop.
+ */
+void ModelPartList::scheduleStatisticsUpdate() {
+    if (statisticsUpdateScheduled)
+        return;
+    statisticsUpdateScheduled = true;
+    QTimer::singleShot(0, this, &ModelPartList::notifyStatisticsChanged);
+}
+
+/**
+ * @brief Emits dataChanged for the statistics columns of every changed row views have fetched.
+ */
+void ModelPartList::notifyStatisticsChanged() {
+    statisticsUpdateScheduled = false;
+    const QSet<ModelPart*> changed = aggregates.takeChanged();
+    for (ModelPart* part : changed) {
+        if (part == rootItem || !isExposed(part))
+            continue;
+        QModelIndex parentIndex = part->parentItem() == rootItem ? QModelIndex() : createIndex(part->parentItem()->row(), 0, part->parentItem());
+        emit dataChanged(index(part->row(), FirstStatisticsColumn, parentIndex), index(part->row(), ColumnCount - 1, parentIndex));
+    }
+}
+
+/**
+ * @brief Sets the parts drawn with a highlighted background, replacing the previous set.
+ *
+ * Only rows views have fetched are repainted; the others pick up the highlight when fetched.
+ *
+ * @param parts The parts to highlight, or an empty list to clear the highlight.
+ */
+void ModelPartList::setHighlightedParts(const QList<ModelPart*>& parts) {
+    QSet<quint64> previous;
+    previous.swap(highlighted);
+    for (ModelPart* part : parts)
+        highlighted.insert(part->id());
+
+    PartRegistry& registry = PartRegistry::instance();
+    for (quint64 id : previous) {
+        if (!highlighted.contains(id))
+            notifyPartChanged(registry.find(id));
+    }
+    for (ModelPart* part : parts) {
+        if (!previous.contains(part->id()))
+            notifyPartChanged(part);
+    }
+}
+
+/**
+ * @brief Removes a part and its descendants from the highlighted set before they leave the model.
+ */
+void ModelPartList::dropHighlight(ModelPart* part) {
+    if (highlighted.isEmpty())
+        return;
+
+    std::vector<ModelPart*> stack{ part };
+    while (!stack.empty()) {
+        ModelPart* current = stack.back();
+        stack.pop_back();
+        highlighted.remove(current->id());
+        for (int row = 0; row < current->childCount(); ++row)
+            stack.push_back(current->child(row));
+    }
+}
+
+/**
+ * @brief Reports whether a part and all its ancestors are within the rows views have fetched.
+ */
+bool ModelPartList::isExposed(ModelPart* part) const {
+    for (; part && part != rootItem; part = part->parentItem()) {
+        ModelPart* parentItem = part->parentItem();
+        if (!parentItem || part->row() >= exposedRows(parentItem))
+            return false;
+    }
+    return part == rootItem;
+}
+
+/**
+ * @brief Emits dataChanged for every column of a part's row, if views have fetched it.
+ */
+void ModelPartList::notifyPartChanged(ModelPart* part) {
+    if (!isExposed(part))
+        return;
+
+    QModelIndex parentIndex = part->parentItem() == rootItem ? QModelIndex() : createIndex(part->parentItem()->row(), 0, part->parentItem());
+    emit dataChanged(index(part->row(), 0, parentIndex), index(part->row(), columnCount() - 1, parentIndex));
 }
 
 /**
@@ -187,3 +768,34 @@ ModelPart* ModelPartList::getItem(const QModelIndex& index) const {
 
     return static_cast<ModelPart*>(index.internalPointer());
 }
+
+/**
+ * @brief Builds the model index of a part that is already in the tree.
+ *
+ * If the part, or one of its ancestors, lies beyond the rows views have fetched, pages are fetched
+ * until it is exposed, so the index is always one views can use.
+ *
+ * @param part The part to locate.
+ * @return The index of the part's first column, or an invalid index for the root or nullptr.
+ */
+QModelIndex ModelPartList::indexForPart(ModelPart* part) {
+    if (!part || part == rootItem || !part->parentItem())
+        return QModelIndex();
+
+    // Fetched from the top down, walking up first rather than recursing through a deep tree
+    std::vector<ModelPart*> chain;
+    ModelPart* top = part;
+    for (; top && top != rootItem; top = top->parentItem())
+        chain.push_back(top);
+    if (!top)
+        return QModelIndex(); // Not in this model
+
+    QModelIndex parentIndex;
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        ModelPart* item = *it;
+        while (item->row() >= exposedRows(item->parentItem()) && canFetchMore(parentIndex))
+            fetchMore(parentIndex);
+        parentIndex = createIndex(item->row(), 0, item);
+    }
+    return parentIndex;
+}
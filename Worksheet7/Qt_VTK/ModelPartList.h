@@ -11,7 +11,14 @@
 #define VIEWER_MODELPARTLIST_H
 
 #include "ModelPart.h"
+#include "PartNameIndex.h"
+#include "PartAttributeStore.h"
+#include "PropertyTransaction.h"
+#include "SubtreeAggregates.h"
+#include "SceneSnapshot.h"
 #include <QAbstractItemModel>
+#include <QHash>
+#include <QSet>
 #include <QModelIndex>
 #include <QVariant>
 #include <QString>
@@ -23,11 +30,30 @@
   * Inherits from QAbstractItemModel and is designed to represent and manage a tree of ModelPart objects.
   * This class provides the necessary implementations to interface with Qt's view components, facilitating
   * the display and manipulation of a tree or list of ModelPart objects within the application.
+  *
+  * Children are exposed to views a page at a time through canFetchMore()/fetchMore(), so expanding
+  * a group with tens of thousands of parts only creates the rows the view asks to show. Parts with
+  * deferred children are shown as expandable summaries and build their subtree on first expansion.
+  *
+  * The model keeps a PartNameIndex and a PartAttributeStore of every part it holds, fetched or not,
+  * up to date as parts are inserted, removed, renamed and edited through it. Attribute changes made
+  * outside the model are reported with refreshAttributes().
+  *
+  * Columns from FirstStatisticsColumn on show the part count, triangles, shown triangles, vertices
+  * and memory of each part's subtree, read from SubtreeAggregates. Changed rows are repainted once
+  * per event loop pass.
+  *
+  * snapshot() returns a structurally shared, read-only version of the whole tree that background
+  * tasks can read while the model keeps changing. It is the only way for other threads to read the
+  * tree, so the model itself needs no locking.
   */
 class ModelPartList : public QAbstractItemModel {
     Q_OBJECT
 
 public:
+    static constexpr int FirstStatisticsColumn = 4; ///< First of the subtree statistics columns.
+    static constexpr int ColumnCount = 9; ///< Property columns followed by statistics columns.
+
     explicit ModelPartList(const QString& data, QObject* parent = nullptr);
     ~ModelPartList();
 
@@ -38,14 +64,54 @@ public:
     QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
     QModelIndex parent(const QModelIndex& index) const override;
     int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+    void setFetchPageSize(int rows);
+    void materializeSubtree(ModelPart* part);
 
     ModelPart* getRootItem();
     ModelPart* getItem(const QModelIndex& index) const;
-    QModelIndex appendChild(QModelIndex& parent, const QList<QVariant>& data);
+    QModelIndex indexForPart(ModelPart* part);
+    QModelIndex appendChild(QModelIndex& parent, const QString& name);
+    bool insertParts(int position, const QList<ModelPart*>& parts, const QModelIndex& parentIndex = QModelIndex());
+    bool appendParts(const QList<ModelPart*>& parts, const QModelIndex& parentIndex = QModelIndex());
     bool removeRows(int position, int rows, const QModelIndex& parentIndex = QModelIndex());
+    int removeParts(const QList<ModelPart*>& parts);
+    QList<ModelPart*> takeParts(const QList<ModelPart*>& parts);
+    QList<ModelPart*> takeRows(int position, int rows, const QModelIndex& parentIndex = QModelIndex());
+    void renamePart(ModelPart* part, const QString& name);
+    void applyProperties(const PropertyTransaction& transaction);
+    const PartNameIndex& nameIndex() const;
+    void setHighlightedParts(const QList<ModelPart*>& parts);
+    const PartAttributeStore& attributes() const;
+    void refreshAttributes(ModelPart* part);
+    void refreshAggregates(const QList<ModelPart*>& parts);
+    SubtreeAggregates::Totals subtreeTotals(const ModelPart* part) const;
+    vtkBoundingBox subtreeBounds(ModelPart* part);
+    SceneSnapshot snapshot();
+
+signals:
+    void attributesChanged();
 
 private:
+    int exposedRows(const ModelPart* part) const;
+    bool buildDeferredChildren(ModelPart* part);
+    bool isExposed(ModelPart* part) const;
+    void dropHighlight(ModelPart* part);
+    void notifyPartChanged(ModelPart* part);
+    void forgetSubtree(ModelPart* part);
+    void scheduleStatisticsUpdate();
+    void notifyStatisticsChanged();
+
     ModelPart* rootItem; ///< Pointer to the root item of the model tree.
+    QHash<const ModelPart*, int> exposed; ///< Number of leading children views have fetched, by parent; absent means none.
+    int pageSize; ///< Children exposed by each fetchMore().
+    PartNameIndex names; ///< Search index over the names of every built part.
+    PartAttributeStore attributeStore; ///< Numeric attributes of every built part, for filtering and sorting.
+    QSet<quint64> highlighted; ///< IDs of the parts drawn with a highlighted background, such as search matches.
+    SubtreeAggregates aggregates; ///< Statistics and bounds of every subtree.
+    bool statisticsUpdateScheduled; ///< True while notifyStatisticsChanged() is queued.
 };
 
 #endif // VIEWER_MODELPARTLIST_H
@@ -0,0 +1,156 @@
+/**
+ * @file NodePool.cpp
+ * @brief Implementation of the NodePool class.
+ */
+
+#include "NodePool.h"
+#include <QMutexLocker>
+#include <algorithm>
+#include <new>
+
+namespace {
+/// Bytes in front of every object, holding the arena it belongs to; keeps the object max-aligned.
+constexpr std::size_t HeaderSize = alignof(std::max_align_t) > sizeof(void*) ? alignof(std::max_align_t) : sizeof(void*);
+
+/// Rounds a size up to the alignment of std::max_align_t.
+constexpr std::size_t alignUp(std::size_t size) {
+    return (size + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+}
+}
+
+/**
+ * @brief One contiguous run of slots.
+ */
+struct NodePool::Arena {
+    std::unique_ptr<std::max_align_t[]> storage; ///< The slots, back to back.
+    FreeSlot* freeList = nullptr; ///< Slots freed since they were first handed out.
+    int used = 0; ///< Slots handed out at least once, from the start of storage.
+    int live = 0; ///< Slots currently in use.
+    bool listed = false; ///< True while the arena is in the available list.
+};
+
+/**
+ * @brief Creates an empty pool.
+ *
+ * @param objectSize The size of the objects to be allocated from it.
+ */
+NodePool::NodePool(std::size_t objectSize)
+    : objectSize(objectSize), slotSize(HeaderSize + alignUp(std::max(objectSize, sizeof(FreeSlot)))), live(0), spare(nullptr) {
+}
+
+/**
+ * @brief Frees every arena. Objects still alive at this point must not be used or deleted again.
+ */
+NodePool::~NodePool() {
+    for (Arena* arena : arenas)
+        delete arena;
+}
+
+/**
+ * @brief Returns storage for one object.
+ *
+ * @param size The size requested by operator new; sizes other than the pool's object size, as
+ *             for a derived class, are passed to the global allocator.
+ * @return Storage aligned for any object of that size.
+ */
+void* NodePool::allocate(std::size_t size) {
+    if (size != objectSize) {
+        // Mark the block as not owned by any arena so deallocate() hands it back to the heap
+        void* block = ::operator new(HeaderSize + size);
+        *static_cast<Arena**>(block) = nullptr;
+        return static_cast<char*>(block) + HeaderSize;
+    }
+
+    QMutexLocker locker(&mutex);
+    if (available.empty()) {
+        Arena* arena = new Arena;
+        arena->storage.reset(new std::max_align_t[slotSize * SlotsPerArena / sizeof(std::max_align_t)]);
+        arena->listed = true;
+        arenas.push_back(arena);
+        available.push_back(arena);
+    }
+
+    Arena* arena = available.back();
+    char* slot;
+    if (arena->freeList) {
+        FreeSlot* free = arena->freeList;
+        arena->freeList = free->next;
+        slot = reinterpret_cast<char*>(free) - HeaderSize;
+    }
+    else {
+        slot = reinterpret_cast<char*>(arena->storage.get()) + slotSize * arena->used++;
+    }
+    *reinterpret_cast<Arena**>(slot) = arena;
+
+    if (arena == spare)
+        spare = nullptr; // The spare arena is back in use
+    ++arena->live;
+    ++live;
+    if (!arena->freeList && arena->used == SlotsPerArena) {
+        available.pop_back();
+        arena->listed = false;
+    }
+    return slot + HeaderSize;
+}
+
+/**
+ * @brief Returns an object's storage to the arena it came from, releasing the arena if it is now empty.
+ *
+ * @param object Storage returned by allocate(), or nullptr.
+ */
+void NodePool::deallocate(void* object) {
+    if (!object)
+        return;
+
+    char* slot = static_cast<char*>(object) - HeaderSize;
+    Arena* arena = *reinterpret_cast<Arena**>(slot);
+    if (!arena) {
+        ::operator delete(slot);
+        return;
+    }
+
+    QMutexLocker locker(&mutex);
+    FreeSlot* free = static_cast<FreeSlot*>(object);
+    free->next = arena->freeList;
+    arena->freeList = free;
+    --arena->live;
+    --live;
+
+    if (arena->live == 0) {
+        if (spare) {
+            releaseArena(arena);
+            return;
+        }
+        spare = arena;
+    }
+    if (!arena->listed) {
+        arena->listed = true;
+        available.push_back(arena);
+    }
+}
+
+/**
+ * @brief Returns the number of objects currently allocated from arenas.
+ */
+qint64 NodePool::liveCount() const {
+    QMutexLocker locker(&mutex);
+    return live;
+}
+
+/**
+ * @brief Returns the number of arenas currently held.
+ */
+int NodePool::arenaCount() const {
+    QMutexLocker locker(&mutex);
+    return static_cast<int>(arenas.size());
+}
+
+/**
+ * @brief Frees an arena with no live slots and drops it from the lists. The mutex must be held.
+ */
+void NodePool::releaseArena(Arena* arena) {
+    arenas.erase(std::find(arenas.begin(), arenas.end(), arena));
+    if (arena->listed)
+        available.erase(std::find(available.begin(), available.end(), arena));
+    delete arena;
+}
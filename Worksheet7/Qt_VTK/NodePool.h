@@ -0,0 +1,64 @@
+/**
+ * @file NodePool.h
+ *
+ * Defines the NodePool class, a fixed-size block allocator that carves tree nodes out of large
+ * arenas instead of allocating each one from the heap.
+ */
+
+#ifndef VIEWER_NODEPOOL_H
+#define VIEWER_NODEPOOL_H
+
+#include <QMutex>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * @class NodePool
+ * @brief Pool of equally sized object slots grouped in arenas.
+ *
+ * Each arena holds SlotsPerArena slots in one allocation. Slots are handed out from the arena's
+ * free list, or from its unused tail, and return to the arena they came from. When the last slot
+ * of an arena is freed the whole arena is released at once, so tearing down a large tree returns
+ * memory to the system a few thousand nodes at a time rather than node by node. One empty arena
+ * is kept back to avoid churn when a single node is repeatedly created and deleted.
+ *
+ * All methods are safe to call from loader threads.
+ */
+class NodePool {
+public:
+    static constexpr int SlotsPerArena = 4096; ///< Slots allocated together.
+
+    explicit NodePool(std::size_t objectSize);
+    ~NodePool();
+
+    void* allocate(std::size_t size);
+    void deallocate(void* object);
+    qint64 liveCount() const;
+    int arenaCount() const;
+
+private:
+    struct Arena;
+
+    /**
+     * @brief Link through a free slot; a slot in use holds the object instead.
+     */
+    struct FreeSlot {
+        FreeSlot* next; ///< Next free slot of the same arena.
+    };
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    void releaseArena(Arena* arena);
+
+    const std::size_t objectSize; ///< Size of the objects the pool serves.
+    const std::size_t slotSize; ///< Bytes per slot: the owning-arena header plus the object, aligned.
+    mutable QMutex mutex; ///< Guards every arena and list below.
+    std::vector<Arena*> arenas; ///< Every arena, in creation order.
+    std::vector<Arena*> available; ///< Arenas with at least one free slot; the last is used first.
+    qint64 live; ///< Slots currently in use across all arenas.
+    Arena* spare; ///< The one empty arena kept back, or nullptr.
+};
+
+#endif // VIEWER_NODEPOOL_H
@@ -0,0 +1,144 @@
+/**
+ * @file OctreeFormat.h
+ *
+ * Defines the on-disk layout of the mesh octrees written by the stl2octree tool and read by the
+ * OctreeStreamer. The header has no Qt or VTK dependencies so the offline tool can be built alone.
+ *
+ * A file starts with a Header, followed by the chunk data of every node, followed by the node
+ * table at Header::tableOffset. A chunk is vertexCount float triples followed by triangleCount
+ * triples of 32-bit vertex indices. All values are little-endian.
+ */
+
+#ifndef VIEWER_OCTREEFORMAT_H
+#define VIEWER_OCTREEFORMAT_H
+
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+namespace OctreeFormat {
+
+    const char Magic[8] = { 'V', 'W', 'O', 'C', 'T', 'R', 'E', 'E' }; ///< File signature.
+    const std::uint32_t Version = 1; ///< Layout version written by this code.
+
+    /**
+     * @struct Header
+     * @brief Fixed-size block at the start of an octree file.
+     */
+    struct Header {
+        std::uint32_t version = Version; ///< Layout version.
+        std::uint32_t nodeCount = 0; ///< Number of entries in the node table.
+        std::uint64_t tableOffset = 0; ///< File offset of the node table.
+        std::uint64_t triangleCount = 0; ///< Triangles in the source mesh.
+        float bounds[6] = {}; ///< Bounds of the whole mesh as xmin, xmax, ymin, ymax, zmin, zmax.
+    };
+
+    /**
+     * @struct Node
+     * @brief One octree cell and the mesh chunk that represents it.
+     *
+     * Leaves hold the original triangles of their cell. Inner nodes hold a simplification of their
+     * children's chunks, whose largest deviation from the original surface is geometricError.
+     */
+    struct Node {
+        float bounds[6] = {}; ///< Tight bounds of the chunk's triangles.
+        float geometricError = 0.0f; ///< Largest deviation of this chunk from the full-resolution surface.
+        std::int32_t children[8] = { -1, -1, -1, -1, -1, -1, -1, -1 }; ///< Child node indices, -1 where empty.
+        std::uint64_t dataOffset = 0; ///< File offset of the chunk data.
+        std::uint32_t vertexCount = 0; ///< Vertices in the chunk.
+        std::uint32_t triangleCount = 0; ///< Triangles in the chunk.
+
+        /**
+         * @brief Returns true if the node has no children.
+         */
+        bool isLeaf() const {
+            for (std::int32_t child : children) {
+                if (child >= 0)
+                    return false;
+            }
+            return true;
+        }
+
+        /**
+         * @brief Returns the size of the chunk data in bytes.
+         */
+        std::uint64_t dataSize() const {
+            return std::uint64_t(vertexCount) * 3 * sizeof(float) + std::uint64_t(triangleCount) * 3 * sizeof(std::uint32_t);
+        }
+    };
+
+    /**
+     * @brief Writes a plain value in its in-memory (little-endian) representation.
+     */
+    template <typename T>
+    void writeValue(std::ostream& out, const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    /**
+     * @brief Reads a plain value written by writeValue().
+     */
+    template <typename T>
+    bool readValue(std::istream& in, T& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    /**
+     * @brief Writes a header field by field, so the layout does not depend on struct padding.
+     */
+    inline void writeHeader(std::ostream& out, const Header& header) {
+        out.write(Magic, sizeof(Magic));
+        writeValue(out, header.version);
+        writeValue(out, header.nodeCount);
+        writeValue(out, header.tableOffset);
+        writeValue(out, header.triangleCount);
+        for (float bound : header.bounds)
+            writeValue(out, bound);
+    }
+
+    /**
+     * @brief Reads a header and checks its signature and version.
+     *
+     * @return False if the stream is not an octree file this code can read.
+     */
+    inline bool readHeader(std::istream& in, Header& header) {
+        char magic[sizeof(Magic)];
+        if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, Magic, sizeof(Magic)) != 0)
+            return false;
+        bool ok = readValue(in, header.version) && readValue(in, header.nodeCount) &&
+            readValue(in, header.tableOffset) && readValue(in, header.triangleCount);
+        for (float& bound : header.bounds)
+            ok = ok && readValue(in, bound);
+        return ok && header.version == Version;
+    }
+
+    /**
+     * @brief Writes a node table entry field by field.
+     */
+    inline void writeNode(std::ostream& out, const Node& node) {
+        for (float bound : node.bounds)
+            writeValue(out, bound);
+        writeValue(out, node.geometricError);
+        for (std::int32_t child : node.children)
+            writeValue(out, child);
+        writeValue(out, node.dataOffset);
+        writeValue(out, node.vertexCount);
+        writeValue(out, node.triangleCount);
+    }
+
+    /**
+     * @brief Reads a node table entry written by writeNode().
+     */
+    inline bool readNode(std::istream& in, Node& node) {
+        bool ok = true;
+        for (float& bound : node.bounds)
+            ok = ok && readValue(in, bound);
+        ok = ok && readValue(in, node.geometricError);
+        for (std::int32_t& child : node.children)
+            ok = ok && readValue(in, child);
+        return ok && readValue(in, node.dataOffset) && readValue(in, node.vertexCount) && readValue(in, node.triangleCount);
+    }
+}
+
+#endif // VIEWER_OCTREEFORMAT_H
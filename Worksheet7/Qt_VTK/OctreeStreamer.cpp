@@ -0,0 +1,452 @@
+/**
+ * @file OctreeStreamer.cpp
+ * @brief Implementation of the OctreeStreamer class.
+ *
+ * Implements the per-frame traversal that chooses which octree chunks to draw, the background
+ * chunk loader and the least-recently-drawn cache eviction.
+ */
+
+#include "OctreeStreamer.h"
+#include <QMetaObject>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentRun>
+#include <vtkCamera.h>
+#include <vtkCellArray.h>
+#include <vtkCommand.h>
+#include <vtkFloatArray.h>
+#include <vtkMath.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkTypeInt64Array.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <queue>
+
+namespace {
+    const int MaxConcurrentLoads = 4; ///< Chunks read at the same time.
+
+    /**
+     * @brief Reads one chunk from an octree file into a triangle mesh.
+     *
+     * @return The mesh, or nullptr if the file could not be read.
+     */
+    vtkSmartPointer<vtkPolyData> readChunk(const QString& fileName, const OctreeFormat::Node& node) {
+        std::ifstream in(fileName.toStdString(), std::ios::binary);
+        if (!in || !in.seekg(static_cast<std::streamoff>(node.dataOffset)))
+            return nullptr;
+
+        vtkSmartPointer<vtkFloatArray> coordinates = vtkSmartPointer<vtkFloatArray>::New();
+        coordinates->SetNumberOfComponents(3);
+        coordinates->SetNumberOfTuples(node.vertexCount);
+        std::vector<std::uint32_t> indices(std::size_t(node.triangleCount) * 3);
+        if (!in.read(reinterpret_cast<char*>(coordinates->GetPointer(0)), std::streamsize(node.vertexCount) * 3 * sizeof(float)) ||
+            !in.read(reinterpret_cast<char*>(indices.data()), std::streamsize(indices.size() * sizeof(std::uint32_t))))
+            return nullptr;
+
+        vtkSmartPointer<vtkTypeInt64Array> offsets = vtkSmartPointer<vtkTypeInt64Array>::New();
+        offsets->SetNumberOfValues(vtkIdType(node.triangleCount) + 1);
+        for (vtkIdType i = 0; i <= vtkIdType(node.triangleCount); ++i)
+            offsets->SetValue(i, i * 3);
+        vtkSmartPointer<vtkTypeInt64Array> connectivity = vtkSmartPointer<vtkTypeInt64Array>::New();
+        connectivity->SetNumberOfValues(vtkIdType(indices.size()));
+        for (std::size_t i = 0; i < indices.size(); ++i) {
+            if (indices[i] >= node.vertexCount)
+                return nullptr;
+            connectivity->SetValue(vtkIdType(i), indices[i]);
+        }
+
+        vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+        points->SetData(coordinates);
+        vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+        polys->SetData(offsets, connectivity);
+
+        vtkSmartPointer<vtkPolyData> mesh = vtkSmartPointer<vtkPolyData>::New();
+        mesh->SetPoints(points);
+        mesh->SetPolys(polys);
+        mesh->GetBounds();
+        return mesh;
+    }
+}
+
+/**
+ * @brief Constructs a streamer that draws into the given renderer.
+ *
+ * Nothing is drawn until open() succeeds. The streamer re-evaluates the tree after every frame
+ * rendered by the window.
+ *
+ * @param renderWindow Window whose frames drive the streaming.
+ * @param renderer Renderer the chunks are added to.
+ * @param parent Parent object.
+ */
+OctreeStreamer::OctreeStreamer(vtkRenderWindow* renderWindow, vtkRenderer* renderer, QObject* parent)
+    : QObject(parent), renderWindow(renderWindow), renderer(renderer),
+    property(vtkSmartPointer<vtkProperty>::New()), memoryBudget(qint64(2) << 30),
+    graphicsBudget(qint64(512) << 20), memoryUsed(0), graphicsUsed(0), errorThreshold(2.0),
+    frame(0), generation(0), updateScheduled(false), visible(true) {
+    observer = renderWindow->AddObserver(vtkCommand::EndEvent, this, &OctreeStreamer::onRenderEnd);
+}
+
+/**
+ * @brief Removes the chunk actors from the renderer and stops following the window.
+ */
+OctreeStreamer::~OctreeStreamer() {
+    renderWindow->RemoveObserver(observer);
+    for (int node : drawn)
+        renderer->RemoveActor(resident[node].actor);
+    for (Chunk& chunk : resident)
+        chunk.actor->ReleaseGraphicsResources(renderWindow);
+}
+
+/**
+ * @brief Opens an octree file, dropping any file streamed before.
+ *
+ * Only the header and node table are read; chunks are loaded as the camera needs them.
+ *
+ * @param fileName Path of a file written by stl2octree.
+ * @return False if the file could not be read.
+ */
+bool OctreeStreamer::open(const QString& fileName) {
+    std::ifstream in(fileName.toStdString(), std::ios::binary);
+    OctreeFormat::Header header;
+    if (!in || !OctreeFormat::readHeader(in, header) || header.nodeCount == 0 ||
+        !in.seekg(static_cast<std::streamoff>(header.tableOffset)))
+        return false;
+
+    std::vector<OctreeFormat::Node> table(header.nodeCount);
+    for (OctreeFormat::Node& node : table) {
+        if (!OctreeFormat::readNode(in, node))
+            return false;
+        for (std::int32_t child : node.children) {
+            if (child >= std::int32_t(header.nodeCount))
+                return false;
+        }
+    }
+
+    for (int node : drawn)
+        renderer->RemoveActor(resident[node].actor);
+    for (Chunk& chunk : resident)
+        chunk.actor->ReleaseGraphicsResources(renderWindow);
+    drawn.clear();
+    resident.clear();
+    loading.clear();
+    memoryUsed = 0;
+    graphicsUsed = 0;
+    ++generation;
+
+    file = fileName;
+    nodes = std::move(table);
+    scheduleUpdate();
+    return true;
+}
+
+/**
+ * @brief Returns the file being streamed, or an empty string before open().
+ */
+QString OctreeStreamer::fileName() const {
+    return file;
+}
+
+/**
+ * @brief Gets the bounds of the whole mesh, or an empty box before open().
+ */
+void OctreeStreamer::bounds(double bounds[6]) const {
+    for (int i = 0; i < 6; ++i)
+        bounds[i] = nodes.empty() ? (i % 2 ? -1.0 : 1.0) : nodes[0].bounds[i];
+}
+
+/**
+ * @brief Sets the largest total size of the chunks kept in memory.
+ *
+ * Chunks being drawn are never dropped, so the graphics budget should not exceed this.
+ */
+void OctreeStreamer::setMemoryBudget(qint64 bytes) {
+    memoryBudget = bytes;
+    evict();
+}
+
+/**
+ * @brief Sets the largest total size of the chunks drawn in one frame.
+ */
+void OctreeStreamer::setGraphicsBudget(qint64 bytes) {
+    graphicsBudget = bytes;
+    scheduleUpdate();
+}
+
+/**
+ * @brief Sets the projected geometric error, in pixels, above which a node is refined.
+ */
+void OctreeStreamer::setErrorThreshold(double pixels) {
+    errorThreshold = std::max(pixels, 0.1);
+    scheduleUpdate();
+}
+
+/**
+ * @brief Shows or hides the mesh. A hidden mesh releases its GPU buffers and loads nothing.
+ */
+void OctreeStreamer::setVisible(bool visible) {
+    this->visible = visible;
+    scheduleUpdate();
+}
+
+/**
+ * @brief Sets the colour of the whole mesh.
+ */
+void OctreeStreamer::setColour(const QColor& colour) {
+    property->SetColor(colour.redF(), colour.greenF(), colour.blueF());
+}
+
+/**
+ * @brief Sets the opacity of the whole mesh.
+ */
+void OctreeStreamer::setOpacity(double opacity) {
+    property->SetOpacity(opacity);
+}
+
+/**
+ * @brief Returns the total size of the chunks in memory.
+ */
+qint64 OctreeStreamer::residentBytes() const {
+    return memoryUsed;
+}
+
+/**
+ * @brief Returns the total size of the chunks drawn in the last frame.
+ */
+qint64 OctreeStreamer::drawnBytes() const {
+    return graphicsUsed;
+}
+
+/**
+ * @brief Chooses the chunks to draw for the current camera and requests missing ones.
+ *
+ * Emits needsRender() if the set of drawn chunks changed.
+ */
+void OctreeStreamer::update() {
+    updateScheduled = false;
+    if (nodes.empty())
+        return;
+    ++frame;
+
+    struct Candidate {
+        int node;
+        double error;
+        bool operator<(const Candidate& other) const { return error < other.error; }
+    };
+
+    QSet<int> wanted;
+    qint64 wantedBytes = 0;
+    std::vector<Candidate> requests;
+
+    int* size = renderer->GetSize();
+    vtkCamera* camera = renderer->GetActiveCamera();
+    if (visible && size[0] > 0 && size[1] > 0) {
+        double planes[24];
+        camera->GetFrustumPlanes(double(size[0]) / size[1], planes);
+
+        std::priority_queue<Candidate> open;
+        if (inFrustum(nodes[0], planes)) {
+            double rootError = screenSpaceError(nodes[0], camera, size[1]);
+            if (resident.contains(0)) {
+                wanted.insert(0);
+                wantedBytes = resident[0].bytes;
+                open.push({ 0, rootError });
+            }
+            else {
+                requests.push_back({ 0, std::numeric_limits<double>::infinity() });
+            }
+        }
+
+        while (!open.empty()) {
+            Candidate candidate = open.top();
+            open.pop();
+            const OctreeFormat::Node& node = nodes[candidate.node];
+            if (candidate.error <= errorThreshold || node.isLeaf())
+                continue;
+
+            QList<int> children;
+            qint64 childBytes = 0;
+            bool ready = true;
+            for (std::int32_t child : node.children) {
+                if (child < 0 || !inFrustum(nodes[child], planes))
+                    continue;
+                children.append(child);
+                if (resident.contains(child)) {
+                    childBytes += resident[child].bytes;
+                }
+                else {
+                    ready = false;
+                    requests.push_back({ child, candidate.error });
+                }
+            }
+            if (!ready)
+                continue;
+
+            qint64 refinedBytes = wantedBytes - resident[candidate.node].bytes + childBytes;
+            if (refinedBytes > graphicsBudget)
+                continue;
+            wanted.remove(candidate.node);
+            wantedBytes = refinedBytes;
+            for (int child : children) {
+                wanted.insert(child);
+                open.push({ child, screenSpaceError(nodes[child], camera, size[1]) });
+            }
+        }
+    }
+
+    bool changed = false;
+    for (int node : drawn) {
+        if (!wanted.contains(node)) {
+            renderer->RemoveActor(resident[node].actor);
+            resident[node].actor->ReleaseGraphicsResources(renderWindow);
+            changed = true;
+        }
+    }
+    for (int node : wanted) {
+        if (!drawn.contains(node)) {
+            renderer->AddActor(resident[node].actor);
+            changed = true;
+        }
+        resident[node].lastDrawn = frame;
+    }
+    drawn = wanted;
+    graphicsUsed = wantedBytes;
+
+    std::sort(requests.begin(), requests.end(), [](const Candidate& a, const Candidate& b) { return a.error > b.error; });
+    for (const Candidate& request : requests) {
+        if (loading.size() >= MaxConcurrentLoads)
+            break;
+        if (!loading.contains(request.node))
+            load(request.node);
+    }
+
+    evict();
+    if (changed)
+        emit needsRender();
+}
+
+/**
+ * @brief Render window observer that re-evaluates the tree once the frame is finished.
+ */
+void OctreeStreamer::onRenderEnd(vtkObject*, unsigned long, void*) {
+    scheduleUpdate();
+}
+
+/**
+ * @brief Queues an update on the event loop, unless one is already queued.
+ *
+ * Updating from the event loop rather than inside the render keeps the renderer's actor list
+ * unchanged while it draws.
+ */
+void OctreeStreamer::scheduleUpdate() {
+    if (updateScheduled)
+        return;
+    updateScheduled = true;
+    QTimer::singleShot(0, this, &OctreeStreamer::update);
+}
+
+/**
+ * @brief Reads a node's chunk on the global thread pool and attaches it when done.
+ */
+void OctreeStreamer::load(int node) {
+    loading.insert(node);
+    QString fileName = file;
+    OctreeFormat::Node info = nodes[node];
+    quint64 openedGeneration = generation;
+    QtConcurrent::run([this, fileName, info, node, openedGeneration] {
+        vtkSmartPointer<vtkPolyData> mesh = readChunk(fileName, info);
+        QMetaObject::invokeMethod(this, [this, node, mesh, openedGeneration] {
+            if (openedGeneration != generation)
+                return;
+            loading.remove(node);
+            if (mesh)
+                attach(node, mesh);
+        }, Qt::QueuedConnection);
+    });
+}
+
+/**
+ * @brief Makes a loaded chunk resident, ready to be drawn by the next update.
+ */
+void OctreeStreamer::attach(int node, vtkSmartPointer<vtkPolyData> mesh) {
+    vtkSmartPointer<vtkPolyDataMapper> mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+    mapper->SetInputData(mesh);
+    mapper->ScalarVisibilityOff();
+
+    Chunk chunk;
+    chunk.actor = vtkSmartPointer<vtkActor>::New();
+    chunk.actor->SetMapper(mapper);
+    chunk.actor->SetProperty(property);
+    chunk.bytes = qint64(mesh->GetActualMemorySize()) * 1024;
+    chunk.lastDrawn = frame;
+    resident.insert(node, chunk);
+    memoryUsed += chunk.bytes;
+    scheduleUpdate();
+}
+
+/**
+ * @brief Drops the least recently drawn chunks that are not being drawn until memory fits the budget.
+ */
+void OctreeStreamer::evict() {
+    while (memoryUsed > memoryBudget) {
+        int oldest = -1;
+        for (auto it = resident.constBegin(); it != resident.constEnd(); ++it) {
+            if (drawn.contains(it.key()))
+                continue;
+            if (oldest < 0 || it.value().lastDrawn < resident[oldest].lastDrawn)
+                oldest = it.key();
+        }
+        if (oldest < 0)
+            break;
+        memoryUsed -= resident[oldest].bytes;
+        resident[oldest].actor->ReleaseGraphicsResources(renderWindow);
+        resident.remove(oldest);
+    }
+}
+
+/**
+ * @brief Tests a node's bounds against the camera frustum.
+ *
+ * @param planes Frustum planes from vtkCamera::GetFrustumPlanes(), with normals pointing inwards.
+ * @return False only if the bounds are entirely outside one of the planes.
+ */
+bool OctreeStreamer::inFrustum(const OctreeFormat::Node& node, const double planes[24]) const {
+    for (int i = 0; i < 6; ++i) {
+        const double* plane = planes + 4 * i;
+        double distance = plane[3];
+        for (int axis = 0; axis < 3; ++axis)
+            distance += plane[axis] * (plane[axis] >= 0.0 ? node.bounds[2 * axis + 1] : node.bounds[2 * axis]);
+        if (distance < 0.0)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Projects a node's geometric error onto the screen.
+ *
+ * The error is measured at the point of the node's bounds nearest the camera, so it is the
+ * largest the node can show.
+ *
+ * @param viewportHeight Height of the renderer in pixels.
+ * @return The projected error in pixels, infinite if the camera is inside the bounds.
+ */
+double OctreeStreamer::screenSpaceError(const OctreeFormat::Node& node, vtkCamera* camera, double viewportHeight) const {
+    if (camera->GetParallelProjection())
+        return node.geometricError * viewportHeight / (2.0 * camera->GetParallelScale());
+
+    double position[3];
+    camera->GetPosition(position);
+    double squared = 0.0;
+    for (int axis = 0; axis < 3; ++axis) {
+        double nearest = std::clamp(position[axis], double(node.bounds[2 * axis]), double(node.bounds[2 * axis + 1]));
+        squared += (position[axis] - nearest) * (position[axis] - nearest);
+    }
+    if (squared <= 0.0)
+        return std::numeric_limits<double>::infinity();
+
+    double halfAngle = vtkMath::RadiansFromDegrees(camera->GetViewAngle()) / 2.0;
+    return node.geometricError * viewportHeight / (2.0 * std::sqrt(squared) * std::tan(halfAngle));
+}
@@ -0,0 +1,102 @@
+/**
+ * @file OctreeStreamer.h
+ *
+ * Defines the OctreeStreamer class, which draws a mesh octree written by stl2octree by paging its
+ * chunks in and out of memory as the camera moves, so meshes far larger than RAM can be viewed.
+ */
+
+#ifndef VIEWER_OCTREESTREAMER_H
+#define VIEWER_OCTREESTREAMER_H
+
+#include <QObject>
+#include <QColor>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <vector>
+#include <vtkSmartPointer.h>
+#include <vtkActor.h>
+#include <vtkProperty.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderer.h>
+#include "OctreeFormat.h"
+
+class vtkObject;
+class vtkPolyData;
+
+/**
+ * @class OctreeStreamer
+ * @brief Screen-space-error driven renderer for out-of-core mesh octrees.
+ *
+ * Only the node table is read when a file is opened. After every frame the tree is walked from
+ * the root, largest screen-space error first: a visible node is replaced by its children while its
+ * projected geometric error exceeds the threshold, the children are in memory and the chunks drawn
+ * still fit the graphics budget. Children that are needed but not in memory are requested from a
+ * background loader, nearest to being drawn first, and the parent is drawn until they arrive.
+ *
+ * Chunks are kept in memory after they stop being drawn, as a cache for when the camera comes
+ * back, until the memory budget is exceeded; then the least recently drawn are dropped. Chunks
+ * that stop being drawn release their GPU buffers straight away.
+ */
+class OctreeStreamer : public QObject {
+    Q_OBJECT
+
+public:
+    OctreeStreamer(vtkRenderWindow* renderWindow, vtkRenderer* renderer, QObject* parent = nullptr);
+    ~OctreeStreamer();
+
+    bool open(const QString& fileName);
+    QString fileName() const;
+    void bounds(double bounds[6]) const;
+    void setMemoryBudget(qint64 bytes);
+    void setGraphicsBudget(qint64 bytes);
+    void setErrorThreshold(double pixels);
+    void setVisible(bool visible);
+    void setColour(const QColor& colour);
+    void setOpacity(double opacity);
+    qint64 residentBytes() const;
+    qint64 drawnBytes() const;
+    void update();
+
+signals:
+    void needsRender();
+
+private:
+    /**
+     * @brief A chunk held in memory.
+     */
+    struct Chunk {
+        vtkSmartPointer<vtkActor> actor; ///< Actor drawing the chunk, sharing the streamer's property.
+        qint64 bytes = 0; ///< Size of the chunk's mesh.
+        quint64 lastDrawn = 0; ///< Frame in which the chunk was last drawn.
+    };
+
+    void onRenderEnd(vtkObject* caller, unsigned long eventId, void* callData);
+    void scheduleUpdate();
+    void load(int node);
+    void attach(int node, vtkSmartPointer<vtkPolyData> mesh);
+    void evict();
+    bool inFrustum(const OctreeFormat::Node& node, const double planes[24]) const;
+    double screenSpaceError(const OctreeFormat::Node& node, vtkCamera* camera, double viewportHeight) const;
+
+    vtkSmartPointer<vtkRenderWindow> renderWindow; ///< Window the chunks are drawn in.
+    vtkSmartPointer<vtkRenderer> renderer; ///< Renderer the chunk actors are added to.
+    vtkSmartPointer<vtkProperty> property; ///< Appearance shared by every chunk actor.
+    QString file; ///< Octree file being streamed.
+    std::vector<OctreeFormat::Node> nodes; ///< Node table of the file.
+    QHash<int, Chunk> resident; ///< Chunks in memory, by node index.
+    QSet<int> loading; ///< Nodes whose chunks are being read.
+    QSet<int> drawn; ///< Nodes whose chunks are in the renderer.
+    unsigned long observer; ///< Tag of the render window observer.
+    qint64 memoryBudget; ///< Largest total size of the chunks in memory.
+    qint64 graphicsBudget; ///< Largest total size of the chunks drawn.
+    qint64 memoryUsed; ///< Total size of the chunks in memory.
+    qint64 graphicsUsed; ///< Total size of the chunks drawn.
+    double errorThreshold; ///< Screen-space error in pixels above which a node is refined.
+    quint64 frame; ///< Number of updates so far, used for least-recently-drawn eviction.
+    quint64 generation; ///< Incremented by open(), so loads from a previous file are discarded.
+    bool updateScheduled; ///< True while an update is queued on the event loop.
+    bool visible; ///< False to draw nothing and load nothing.
+};
+
+#endif // VIEWER_OCTREESTREAMER_H
@@ -0,0 +1,250 @@
+/**
+ * @file PartAttributeStore.cpp
+ * @brief Implementation of the PartAttributeStore class.
+ */
+
+#include "PartAttributeStore.h"
+#include "ModelPart.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Adds a part with its current attributes, or returns its ID if it is already stored.
+ *
+ * @param part The part to add.
+ * @return The part's ID.
+ */
+int PartAttributeStore::insert(ModelPart* part) {
+    auto it = ids.constFind(part);
+    if (it != ids.constEnd())
+        return it.value();
+
+    int id;
+    if (!freeIds.empty()) {
+        id = freeIds.back();
+        freeIds.pop_back();
+        parts[id] = part;
+    }
+    else {
+        id = static_cast<int>(parts.size());
+        parts.push_back(part);
+        triangles.push_back(0);
+        boundsSize.push_back(0.0f);
+        memory.push_back(0);
+        visible.push_back(0);
+        loadState.push_back(0);
+    }
+    ids.insert(part, id);
+    boundsSize[id] = 0.0f;
+    update(part);
+    return id;
+}
+
+/**
+ * @brief Adds a part and all of its built descendants.
+ *
+ * @param part The root of the subtree to add.
+ */
+void PartAttributeStore::insertSubtree(ModelPart* part) {
+    if (!part)
+        return;
+
+    std::vector<ModelPart*> stack{ part };
+    while (!stack.empty()) {
+        ModelPart* current = stack.back();
+        stack.pop_back();
+        insert(current);
+        for (int row = current->childCount() - 1; row >= 0; --row)
+            stack.push_back(current->child(row));
+    }
+}
+
+/**
+ * @brief Removes a part, freeing its ID for reuse.
+ *
+ * @param part The part to remove.
+ */
+void PartAttributeStore::remove(ModelPart* part) {
+    auto it = ids.find(part);
+    if (it == ids.end())
+        return;
+
+    int id = it.value();
+    ids.erase(it);
+    parts[id] = nullptr;
+    triangles[id] = 0;
+    boundsSize[id] = 0.0f;
+    memory[id] = 0;
+    visible[id] = 0;
+    loadState[id] = 0;
+    freeIds.push_back(id);
+}
+
+/**
+ * @brief Removes a part and all of its descendants, before the subtree is deleted.
+ *
+ * @param part The root of the subtree to remove.
+ */
+void PartAttributeStore::removeSubtree(ModelPart* part) {
+    if (!part)
+        return;
+
+    std::vector<ModelPart*> stack{ part };
+    while (!stack.empty()) {
+        ModelPart* current = stack.back();
+        stack.pop_back();
+        remove(current);
+        for (int row = current->childCount() - 1; row >= 0; --row)
+            stack.push_back(current->child(row));
+    }
+}
+
+/**
+ * @brief Copies a part's current attributes into the store.
+ *
+ * The bounds are kept from the last time they were known while the part's mesh is released.
+ *
+ * @param part The part whose attributes changed. Parts not in the store are ignored.
+ */
+void PartAttributeStore::update(ModelPart* part) {
+    auto it = ids.constFind(part);
+    if (it == ids.constEnd())
+        return;
+
+    int id = it.value();
+    triangles[id] = part->primitiveCount(ModelPart::DetailLevel::Full);
+    memory[id] = part->geometryBytes();
+    visible[id] = part->visible() ? 1 : 0;
+
+    LoadState state = LoadState::NoGeometry;
+    if (part->geometryResident())
+        state = LoadState::Resident;
+    else if (!part->sourceFile().isEmpty())
+        state = LoadState::Released;
+    loadState[id] = static_cast<std::uint8_t>(state);
+
+    vtkPolyData* outline = part->levelGeometry(ModelPart::DetailLevel::BoundingBox);
+    if (!outline)
+        outline = part->levelGeometry(ModelPart::DetailLevel::Full);
+    if (outline && outline->GetNumberOfPoints() > 0)
+        boundsSize[id] = static_cast<float>(outline->GetLength());
+}
+
+/**
+ * @brief Returns the ID of a part, or -1 if it is not in the store.
+ */
+int PartAttributeStore::id(const ModelPart* part) const {
+    return ids.value(part, -1);
+}
+
+/**
+ * @brief Returns the part with an ID, or nullptr for a free or out-of-range ID.
+ */
+ModelPart* PartAttributeStore::part(int id) const {
+    return id >= 0 && id < capacity() ? parts[id] : nullptr;
+}
+
+/**
+ * @brief Returns one past the largest ID in use, the length of every column and of evaluate() masks.
+ */
+int PartAttributeStore::capacity() const {
+    return static_cast<int>(parts.size());
+}
+
+/**
+ * @brief Returns one attribute of a part.
+ *
+ * @param id The part's ID.
+ * @param attribute The attribute to read.
+ * @return The value, with Visible as 0 or 1 and LoadState as its enum value.
+ */
+double PartAttributeStore::value(int id, Attribute attribute) const {
+    if (id < 0 || id >= capacity())
+        return 0.0;
+
+    switch (attribute) {
+    case Attribute::Triangles:
+        return static_cast<double>(triangles[id]);
+    case Attribute::BoundsSize:
+        return boundsSize[id];
+    case Attribute::Memory:
+        return static_cast<double>(memory[id]);
+    case Attribute::Visible:
+        return visible[id];
+    case Attribute::LoadState:
+        return loadState[id];
+    }
+    return 0.0;
+}
+
+/**
+ * @brief Evaluates the AND of the conditions for every ID.
+ *
+ * @param conditions The conditions to combine; an empty list matches every stored part.
+ * @return One byte per ID, 1 where the part exists and meets every condition.
+ */
+std::vector<std::uint8_t> PartAttributeStore::evaluate(const QList<Condition>& conditions) const {
+    std::vector<std::uint8_t> mask(parts.size());
+    for (std::size_t id = 0; id < parts.size(); ++id)
+        mask[id] = parts[id] ? 1 : 0;
+
+    for (const Condition& condition : conditions) {
+        switch (condition.attribute) {
+        case Attribute::Triangles:
+            scan(triangles, condition.comparison, static_cast<std::int64_t>(std::llround(condition.value)), mask);
+            break;
+        case Attribute::BoundsSize:
+            scan(boundsSize, condition.comparison, static_cast<float>(condition.value), mask);
+            break;
+        case Attribute::Memory:
+            scan(memory, condition.comparison, static_cast<std::int64_t>(std::llround(condition.value)), mask);
+            break;
+        case Attribute::Visible:
+            scan(visible, condition.comparison, static_cast<std::uint8_t>(condition.value != 0.0), mask);
+            break;
+        case Attribute::LoadState:
+            scan(loadState, condition.comparison, static_cast<std::uint8_t>(condition.value), mask);
+            break;
+        }
+    }
+    return mask;
+}
+
+/**
+ * @brief ANDs the mask with one comparison over a whole column.
+ *
+ * Each comparison gets its own branch-free loop over contiguous arrays, so the compiler turns it
+ * into vector instructions.
+ */
+template <typename T>
+void PartAttributeStore::scan(const std::vector<T>& column, Comparison comparison, T value, std::vector<std::uint8_t>& mask) {
+    const T* data = column.data();
+    std::uint8_t* out = mask.data();
+    const std::size_t count = mask.size();
+    switch (comparison) {
+    case Comparison::Less:
+        for (std::size_t i = 0; i < count; ++i)
+            out[i] &= static_cast<std::uint8_t>(data[i] < value);
+        break;
+    case Comparison::LessEqual:
+        for (std::size_t i = 0; i < count; ++i)
+            out[i] &= static_cast<std::uint8_t>(data[i] <= value);
+        break;
+    case Comparison::Equal:
+        for (std::size_t i = 0; i < count; ++i)
+            out[i] &= static_cast<std::uint8_t>(data[i] == value);
+        break;
+    case Comparison::NotEqual:
+        for (std::size_t i = 0; i < count; ++i)
+            out[i] &= static_cast<std::uint8_t>(data[i] != value);
+        break;
+    case Comparison::GreaterEqual:
+        for (std::size_t i = 0; i < count; ++i)
+            out[i] &= static_cast<std::uint8_t>(data[i] >= value);
+        break;
+    case Comparison::Greater:
+        for (std::size_t i = 0; i < count; ++i)
+            out[i] &= static_cast<std::uint8_t>(data[i] > value);
+        break;
+    }
+}
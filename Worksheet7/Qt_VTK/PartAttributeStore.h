@@ -0,0 +1,86 @@
+/**
+ * @file PartAttributeStore.h
+ *
+ * Defines the PartAttributeStore class, which keeps the numeric attributes of every part in the
+ * tree in one array per attribute, so filters and sorts can scan them without visiting the tree.
+ */
+
+#ifndef VIEWER_PARTATTRIBUTESTORE_H
+#define VIEWER_PARTATTRIBUTESTORE_H
+
+#include <QHash>
+#include <QList>
+#include <cstdint>
+#include <vector>
+
+class ModelPart;
+
+/**
+ * @class PartAttributeStore
+ * @brief Column-oriented table of part attributes, indexed by a dense part ID.
+ *
+ * Each part added to the store gets the next free ID, reused after the part is removed, and its
+ * attributes are copied into one array per attribute at that position. A filter condition is then
+ * a single loop over one contiguous array that the compiler vectorises, and conditions combine by
+ * AND-ing byte masks, so evaluating a filter over hundreds of thousands of parts takes well under
+ * a frame.
+ *
+ * The store holds copies: owners call update() when a part's geometry, residency or visibility
+ * changes. Its IDs are row numbers for the filter's masks rather than part identities, and are
+ * only meaningful to this store and the masks it produces; other subsystems refer to parts by
+ * their PartRegistry ID.
+ */
+class PartAttributeStore {
+public:
+    /**
+     * @brief Attributes held for every part.
+     */
+    enum class Attribute { Triangles, BoundsSize, Memory, Visible, LoadState };
+
+    /**
+     * @brief Whether a part's full-detail mesh is in memory.
+     */
+    enum class LoadState { NoGeometry, Resident, Released };
+
+    /**
+     * @brief How a condition compares an attribute with its value.
+     */
+    enum class Comparison { Less, LessEqual, Equal, NotEqual, GreaterEqual, Greater };
+
+    /**
+     * @brief One term of a filter: attribute, comparison, value.
+     *
+     * Visible compares as 0 or 1 and LoadState as the integer value of the enum.
+     */
+    struct Condition {
+        Attribute attribute; ///< Attribute to test.
+        Comparison comparison; ///< Comparison applied to the attribute.
+        double value; ///< Value the attribute is compared with.
+    };
+
+    int insert(ModelPart* part);
+    void insertSubtree(ModelPart* part);
+    void remove(ModelPart* part);
+    void removeSubtree(ModelPart* part);
+    void update(ModelPart* part);
+    int id(const ModelPart* part) const;
+    ModelPart* part(int id) const;
+    int capacity() const;
+    double value(int id, Attribute attribute) const;
+    std::vector<std::uint8_t> evaluate(const QList<Condition>& conditions) const;
+
+private:
+    template <typename T>
+    static void scan(const std::vector<T>& column, Comparison comparison, T value, std::vector<std::uint8_t>& mask);
+
+    std::vector<ModelPart*> parts; ///< Part with each ID, nullptr for free IDs.
+    std::vector<std::int64_t> triangles; ///< Triangles in the full-detail mesh.
+    std::vector<float> boundsSize; ///< Diagonal of the mesh bounds, 0 for parts without geometry.
+    std::vector<std::int64_t> memory; ///< Bytes of mesh currently held.
+    std::vector<std::uint8_t> visible; ///< 1 if the part is visible.
+    std::vector<std::uint8_t> loadState; ///< LoadState of the full-detail mesh.
+    std::vector<int> freeIds; ///< IDs released by remove(), reused by insert().
+    QHash<const ModelPart*, int> ids; ///< ID of each part in the store.
+};
+
+#endif // VIEWER_PARTATTRIBUTESTORE_H
@@ -0,0 +1,199 @@
+/**
+ * @file PartFilterProxy.cpp
+ * @brief Implementation of the PartFilterProxy class.
+ */
+
+#include "PartFilterProxy.h"
+#include <QTimer>
+
+/**
+ * @brief Constructs an unfiltered, unsorted proxy over the parts tree.
+ *
+ * @param parts The model to filter.
+ * @param parent The parent object.
+ */
+PartFilterProxy::PartFilterProxy(ModelPartList* parts, QObject* parent)
+    : QSortFilterProxyModel(parent), parts(parts), matches(0), sortKey(SortKey::TreeOrder), evaluateScheduled(false) {
+    setSourceModel(parts);
+    setDynamicSortFilter(false); // Re-filtering is driven by attributesChanged instead
+    connect(parts, &ModelPartList::attributesChanged, this, &PartFilterProxy::scheduleEvaluate);
+}
+
+/**
+ * @brief Shows only the parts meeting every condition, with their ancestors.
+ *
+ * @param conditions The filter terms; an empty list removes the filter.
+ */
+void PartFilterProxy::setConditions(const QList<PartAttributeStore::Condition>& conditions) {
+    this->conditions = conditions;
+    evaluate();
+}
+
+/**
+ * @brief Removes the filter, showing every part.
+ */
+void PartFilterProxy::clearConditions() {
+    setConditions({});
+}
+
+/**
+ * @brief Returns true while a filter is applied.
+ */
+bool PartFilterProxy::filterActive() const {
+    return !conditions.isEmpty();
+}
+
+/**
+ * @brief Returns the number of parts meeting the filter, not counting the ancestors kept for them.
+ */
+int PartFilterProxy::matchCount() const {
+    return matches;
+}
+
+/**
+ * @brief Sorts siblings by a key, or restores the tree order.
+ *
+ * @param key The sort key.
+ * @param order The sort direction.
+ */
+void PartFilterProxy::setSortKey(SortKey key, Qt::SortOrder order) {
+    sortKey = key;
+    if (key == SortKey::TreeOrder) {
+        sort(-1);
+        return;
+    }
+    invalidate(); // The key is not part of the column, so force a re-sort even if the column is unchanged
+    sort(0, order);
+}
+
+/**
+ * @brief Returns the part shown at a proxy index.
+ *
+ * @param index An index of this proxy.
+ * @return The part, or nullptr for an invalid index.
+ */
+ModelPart* PartFilterProxy::partForIndex(const QModelIndex& index) const {
+    if (!index.isValid())
+        return nullptr;
+    return parts->getItem(mapToSource(index));
+}
+
+/**
+ * @brief Returns the proxy index at which a part is shown.
+ *
+ * @param part The part to locate.
+ * @return The index, or an invalid index if the part is the root or is filtered out.
+ */
+QModelIndex PartFilterProxy::indexForPart(ModelPart* part) {
+    return mapFromSource(parts->indexForPart(part));
+}
+
+/**
+ * @brief Reports whether a parent has shown children that views have not fetched yet.
+ *
+ * Without a filter, or for the root, this is the source model's answer.
+ */
+bool PartFilterProxy::canFetchMore(const QModelIndex& parent) const {
+    QModelIndex sourceParent = mapToSource(parent);
+    int id = conditions.isEmpty() || !sourceParent.isValid() ? -1 : parts->attributes().id(parts->getItem(sourceParent));
+    if (id < 0 || id >= static_cast<int>(lastShownRow.size()))
+        return QSortFilterProxyModel::canFetchMore(parent);
+    return lastShownRow[id] >= parts->rowCount(sourceParent);
+}
+
+/**
+ * @brief Fetches children of a parent until one of them is shown.
+ *
+ * Pages of the source model may hold no match at all; paging on until a shown row arrives means
+ * expanding a group never leaves it looking empty while matches remain further down.
+ */
+void PartFilterProxy::fetchMore(const QModelIndex& parent) {
+    QModelIndex sourceParent = mapToSource(parent);
+    int shownBefore = rowCount(parent);
+    do {
+        QSortFilterProxyModel::fetchMore(parent);
+    } while (!conditions.isEmpty() && rowCount(parent) == shownBefore && canFetchMore(parent) && parts->canFetchMore(sourceParent));
+}
+
+/**
+ * @brief Accepts rows whose part matches the filter or has a matching descendant.
+ */
+bool PartFilterProxy::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const {
+    if (conditions.isEmpty())
+        return true;
+
+    ModelPart* part = parts->getItem(sourceParent)->child(sourceRow);
+    int id = parts->attributes().id(part);
+    return id >= 0 && id < static_cast<int>(accepted.size()) && accepted[id];
+}
+
+/**
+ * @brief Orders siblings by the current sort key, falling back to the name.
+ */
+bool PartFilterProxy::lessThan(const QModelIndex& left, const QModelIndex& right) const {
+    PartAttributeStore::Attribute attribute;
+    switch (sortKey) {
+    case SortKey::Triangles:
+        attribute = PartAttributeStore::Attribute::Triangles;
+        break;
+    case SortKey::BoundsSize:
+        attribute = PartAttributeStore::Attribute::BoundsSize;
+        break;
+    case SortKey::Memory:
+        attribute = PartAttributeStore::Attribute::Memory;
+        break;
+    default:
+        return QSortFilterProxyModel::lessThan(left, right);
+    }
+
+    const PartAttributeStore& store = parts->attributes();
+    double a = store.value(store.id(parts->getItem(left)), attribute);
+    double b = store.value(store.id(parts->getItem(right)), attribute);
+    return a != b ? a < b : QSortFilterProxyModel::lessThan(left, right);
+}
+
+/**
+ * @brief Recomputes which parts are shown and refreshes the proxy.
+ *
+ * Matches are found with one scan per condition; each match then marks its ancestors, stopping at
+ * the first one already marked, so the marking costs at most one visit per shown part. Nothing is
+ * fetched here: views page in shown rows through fetchMore() when they need them.
+ */
+void PartFilterProxy::evaluate() {
+    evaluateScheduled = false;
+    accepted.clear();
+    lastShownRow.clear();
+    matches = 0;
+
+    if (!conditions.isEmpty()) {
+        const PartAttributeStore& store = parts->attributes();
+        std::vector<std::uint8_t> mask = store.evaluate(conditions);
+        accepted.assign(mask.size(), 0);
+        lastShownRow.assign(mask.size(), -1);
+        for (int id = 0; id < static_cast<int>(mask.size()); ++id) {
+            if (!mask[id])
+                continue;
+            ++matches;
+            for (ModelPart* part = store.part(id); part; part = part->parentItem()) {
+                int partId = store.id(part);
+                if (partId < 0 || accepted[partId])
+                    break;
+                accepted[partId] = 1;
+                int parentId = part->parentItem() ? store.id(part->parentItem()) : -1;
+                if (parentId >= 0)
+                    lastShownRow[parentId] = qMax(lastShownRow[parentId], part->row());
+            }
+        }
+    }
+    invalidateFilter();
+}
+
+/**
+ * @brief Queues a re-evaluation on the event loop while a filter is applied.
+ */
+void PartFilterProxy::scheduleEvaluate() {
+    if (conditions.isEmpty() || evaluateScheduled)
+        return;
+    evaluateScheduled = true;
+    QTimer::singleShot(0, this, &PartFilterProxy::evaluate);
+}
@@ -0,0 +1,71 @@
+/**
+ * @file PartFilterProxy.h
+ *
+ * Defines the PartFilterProxy class, which filters and sorts the parts tree by the attributes in
+ * the model's PartAttributeStore.
+ */
+
+#ifndef VIEWER_PARTFILTERPROXY_H
+#define VIEWER_PARTFILTERPROXY_H
+
+#include <QSortFilterProxyModel>
+#include <vector>
+#include "ModelPartList.h"
+#include "PartAttributeStore.h"
+
+/**
+ * @class PartFilterProxy
+ * @brief Attribute filter and sort over a ModelPartList.
+ *
+ * QSortFilterProxyModel asks filterAcceptsRow() about every row, and a tree filter that keeps
+ * ancestors would have to search each row's subtree from there. Instead, setConditions() scans
+ * the attribute store once and marks every matching part and its ancestors in a byte per part ID;
+ * filterAcceptsRow() then only looks up the mark. Sorting compares attribute values read straight
+ * from the store.
+ *
+ * Applying the filter fetches nothing. Matches beyond the rows the tree view has fetched are paged
+ * in when the view expands their parent or scrolls to them: while a filter is applied, fetchMore()
+ * keeps paging until it reaches a shown row, and canFetchMore() is false once every shown child
+ * has been fetched. indexForPart() fetches the rows leading to the one part it is asked for. The
+ * filter is re-evaluated, once per event loop pass, when the model reports that part attributes
+ * changed.
+ */
+class PartFilterProxy : public QSortFilterProxyModel {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief What the tree is sorted by.
+     */
+    enum class SortKey { TreeOrder, Name, Triangles, BoundsSize, Memory };
+
+    explicit PartFilterProxy(ModelPartList* parts, QObject* parent = nullptr);
+
+    void setConditions(const QList<PartAttributeStore::Condition>& conditions);
+    void clearConditions();
+    bool filterActive() const;
+    int matchCount() const;
+    void setSortKey(SortKey key, Qt::SortOrder order);
+    ModelPart* partForIndex(const QModelIndex& index) const;
+    QModelIndex indexForPart(ModelPart* part);
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+    bool lessThan(const QModelIndex& left, const QModelIndex& right) const override;
+
+private:
+    void evaluate();
+    void scheduleEvaluate();
+
+    ModelPartList* parts; ///< Source model.
+    QList<PartAttributeStore::Condition> conditions; ///< Filter terms, combined with AND; empty for no filter.
+    std::vector<std::uint8_t> accepted; ///< 1 for each part ID that matches or has a matching descendant.
+    std::vector<int> lastShownRow; ///< Last row of a shown child, by the parent's part ID; -1 if none.
+    int matches; ///< Number of parts meeting the conditions.
+    SortKey sortKey; ///< Current sort key.
+    bool evaluateScheduled; ///< True while a re-evaluation is queued.
+};
+
+#endif // VIEWER_PARTFILTERPROXY_H
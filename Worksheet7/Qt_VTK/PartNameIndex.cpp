@@ -0,0 +1,219 @@
+/**
+ * @file PartNameIndex.cpp
+ * @brief Implementation of the PartNameIndex class.
+ */
+
+#include "PartNameIndex.h"
+#include "ModelPart.h"
+#include <QSet>
+#include <algorithm>
+
+/**
+ * @brief Adds a part under its current name. Does nothing if the part is already indexed.
+ *
+ * @param part The part to add.
+ */
+void PartNameIndex::insert(ModelPart* part) {
+    if (!part || slotOf.contains(part))
+        return;
+
+    quint32 slot = static_cast<quint32>(parts.size());
+    QString name = part->name().toCaseFolded();
+    parts.push_back(part);
+    names.push_back(name);
+    slotOf.insert(part, slot);
+
+    std::vector<quint64> keys;
+    keys.reserve(std::size_t(std::max(int(name.size()) - 2, 0)));
+    for (int i = 0; i + 3 <= name.size(); ++i)
+        keys.push_back(trigram(name.constData() + i));
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    for (quint64 key : keys)
+        postings[key].push_back(slot);
+}
+
+/**
+ * @brief Adds a part and all of its built descendants.
+ *
+ * @param part The root of the subtree to add.
+ */
+void PartNameIndex::insertSubtree(ModelPart* part) {
+    if (!part)
+        return;
+
+    std::vector<ModelPart*> stack{ part };
+    while (!stack.empty()) {
+        ModelPart* current = stack.back();
+        stack.pop_back();
+        insert(current);
+        for (int row = current->childCount() - 1; row >= 0; --row)
+            stack.push_back(current->child(row));
+    }
+}
+
+/**
+ * @brief Removes a part from the index.
+ *
+ * @param part The part to remove.
+ */
+void PartNameIndex::remove(ModelPart* part) {
+    auto it = slotOf.find(part);
+    if (it == slotOf.end())
+        return;
+
+    parts[it.value()] = nullptr;
+    names[it.value()].clear();
+    slotOf.erase(it);
+    if (parts.size() > 1024 && parts.size() > 2 * std::size_t(slotOf.size()))
+        compact();
+}
+
+/**
+ * @brief Removes a part and all of its descendants, before the subtree is deleted.
+ *
+ * @param part The root of the subtree to remove.
+ */
+void PartNameIndex::removeSubtree(ModelPart* part) {
+    if (!part)
+        return;
+
+    std::vector<ModelPart*> stack{ part };
+    while (!stack.empty()) {
+        ModelPart* current = stack.back();
+        stack.pop_back();
+        remove(current);
+        for (int row = current->childCount() - 1; row >= 0; --row)
+            stack.push_back(current->child(row));
+    }
+}
+
+/**
+ * @brief Re-indexes a part after its name changed.
+ *
+ * @param part The renamed part.
+ */
+void PartNameIndex::rename(ModelPart* part) {
+    if (!slotOf.contains(part))
+        return;
+
+    remove(part);
+    insert(part);
+}
+
+/**
+ * @brief Finds every indexed part whose name contains the text, ignoring case.
+ *
+ * @param text The text to search for.
+ * @return The matching parts in tree order, or an empty list for empty text.
+ */
+QList<ModelPart*> PartNameIndex::find(const QString& text) const {
+    QList<ModelPart*> matches;
+    QString query = text.toCaseFolded();
+    if (query.isEmpty())
+        return matches;
+
+    if (query.size() < 3) {
+        for (std::size_t slot = 0; slot < parts.size(); ++slot) {
+            if (parts[slot] && names[slot].contains(query))
+                matches.append(parts[slot]);
+        }
+        return inTreeOrder(matches);
+    }
+
+    const std::vector<quint32>* candidates = nullptr;
+    for (int i = 0; i + 3 <= query.size(); ++i) {
+        auto it = postings.constFind(trigram(query.constData() + i));
+        if (it == postings.constEnd())
+            return matches; // Some trigram of the query appears in no name
+        if (!candidates || it.value().size() < candidates->size())
+            candidates = &it.value();
+    }
+
+    for (quint32 slot : *candidates) {
+        if (parts[slot] && names[slot].contains(query))
+            matches.append(parts[slot]);
+    }
+    return inTreeOrder(matches);
+}
+
+/**
+ * @brief Sorts parts into the order a depth-first walk of the tree reaches them.
+ *
+ * Slots follow the order parts were indexed in, and a renamed part moves to the last slot, so
+ * matches are put back in tree order here. The ancestors of all the parts are collected once,
+ * each ancestor's listed children are sorted by row, and that partial tree is walked in preorder,
+ * so the cost grows with the parts and their shared ancestors rather than with their depth times
+ * their number.
+ *
+ * @param matches The parts to sort.
+ * @return The parts in tree order.
+ */
+QList<ModelPart*> PartNameIndex::inTreeOrder(const QList<ModelPart*>& matches) {
+    if (matches.size() < 2)
+        return matches;
+
+    QSet<ModelPart*> wanted(matches.begin(), matches.end());
+    QSet<ModelPart*> seen;
+    QHash<ModelPart*, std::vector<ModelPart*>> below; // Children leading to a match, per ancestor
+    std::vector<ModelPart*> tops;
+    for (ModelPart* part : matches) {
+        for (ModelPart* current = part; current && !seen.contains(current); current = current->parentItem()) {
+            seen.insert(current);
+            if (ModelPart* parent = current->parentItem())
+                below[parent].push_back(current);
+            else
+                tops.push_back(current);
+        }
+    }
+
+    auto byRow = [](ModelPart* a, ModelPart* b) { return a->row() < b->row(); };
+    QList<ModelPart*> ordered;
+    ordered.reserve(matches.size());
+    std::vector<ModelPart*> stack(tops.rbegin(), tops.rend());
+    while (!stack.empty()) {
+        ModelPart* current = stack.back();
+        stack.pop_back();
+        if (wanted.contains(current))
+            ordered.append(current);
+        auto children = below.find(current);
+        if (children == below.end())
+            continue;
+        std::sort(children->begin(), children->end(), byRow);
+        stack.insert(stack.end(), children->rbegin(), children->rend());
+    }
+    return ordered;
+}
+
+/**
+ * @brief Returns the number of indexed parts.
+ */
+int PartNameIndex::size() const {
+    return slotOf.size();
+}
+
+/**
+ * @brief Packs three UTF-16 code units into a posting list key.
+ */
+quint64 PartNameIndex::trigram(const QChar* characters) {
+    return (quint64(characters[0].unicode()) << 32) | (quint64(characters[1].unicode()) << 16) | characters[2].unicode();
+}
+
+/**
+ * @brief Rebuilds the index without emptied slots, keeping the parts in the same order.
+ */
+void PartNameIndex::compact() {
+    std::vector<ModelPart*> live;
+    live.reserve(slotOf.size());
+    for (ModelPart* part : parts) {
+        if (part)
+            live.push_back(part);
+    }
+
+    parts.clear();
+    names.clear();
+    slotOf.clear();
+    postings.clear();
+    for (ModelPart* part : live)
+        insert(part);
+}
@@ -0,0 +1,53 @@
+/**
+ * @file PartNameIndex.h
+ *
+ * Defines the PartNameIndex class, a trigram index over the names of the parts in the tree that
+ * answers substring searches without visiting every part.
+ */
+
+#ifndef VIEWER_PARTNAMEINDEX_H
+#define VIEWER_PARTNAMEINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <vector>
+
+class ModelPart;
+
+/**
+ * @class PartNameIndex
+ * @brief Case-insensitive substring search over part names.
+ *
+ * Every part gets a slot holding its case-folded name, and every distinct three-character
+ * sequence of the name lists the slot in a posting list. A query looks up the postings of each of
+ * its trigrams, takes the shortest and checks only those candidates, so its cost depends on how
+ * rare the query is rather than on the size of the tree. Queries shorter than three characters,
+ * which match most names anyway, check every slot.
+ *
+ * Removing or renaming a part only empties its slot; the stale postings are skipped by queries
+ * and dropped when the index is compacted, which happens once empty slots outnumber used ones.
+ * Results are returned in tree order, whatever order the parts were indexed or renamed in.
+ */
+class PartNameIndex {
+public:
+    void insert(ModelPart* part);
+    void insertSubtree(ModelPart* part);
+    void remove(ModelPart* part);
+    void removeSubtree(ModelPart* part);
+    void rename(ModelPart* part);
+    QList<ModelPart*> find(const QString& text) const;
+    int size() const;
+
+private:
+    static QList<ModelPart*> inTreeOrder(const QList<ModelPart*>& matches);
+    static quint64 trigram(const QChar* characters);
+    void compact();
+
+    std::vector<ModelPart*> parts; ///< Part in each slot, nullptr for emptied slots.
+    std::vector<QString> names; ///< Case-folded name of the part in each slot.
+    QHash<ModelPart*, quint32> slotOf; ///< Slot of each indexed part.
+    QHash<quint64, std::vector<quint32>> postings; ///< Slots whose names contain each trigram, ascending.
+};
+
+#endif // VIEWER_PARTNAMEINDEX_H
@@ -0,0 +1,231 @@
+/**
+ * @file PartPicker.cpp
+ * @brief Implementation of the PartPicker class.
+ *
+ * Captures the hardware prop ID buffer on demand and turns hover and click events in the VTK view
+ * into ModelPart lookups.
+ */
+
+#include "PartPicker.h"
+#include "PartRegistry.h"
+#include <vtkCamera.h>
+#include <vtkCommand.h>
+#include <vtkDataObject.h>
+#include <vtkProperty.h>
+#include <vtkRenderWindowInteractor.h>
+#include <cstdlib>
+
+ /**
+  * @brief Constructs the picker and attaches it to the interactor of the given window.
+  *
+  * @param renderWindow The render window to pick in.
+  * @param renderer The renderer to pick in when the interactor cannot tell which view was used.
+  * @param parent The parent QObject.
+  */
+PartPicker::PartPicker(vtkRenderWindow* renderWindow, vtkRenderer* renderer, QObject* parent)
+    : QObject(parent), renderWindow(renderWindow), renderer(renderer), capturedRenderer(nullptr), hovered(0),
+    savedAmbient(0.0), savedAmbientColour{ 1.0, 1.0, 1.0 }, capturedCameraTime(0), capturedSize{ 0, 0 }, buffersValid(false), buttonsHeld(0), pressPosition{ 0, 0 } {
+    selector = vtkSmartPointer<vtkHardwareSelector>::New();
+    selector->SetRenderer(renderer);
+    selector->SetFieldAssociation(vtkDataObject::FIELD_ASSOCIATION_CELLS);
+    selector->SetActorPassOnly(true);
+
+    vtkRenderWindowInteractor* interactor = renderWindow->GetInteractor();
+    if (interactor) {
+        observers.append(interactor->AddObserver(vtkCommand::MouseMoveEvent, this, &PartPicker::onMouseMove));
+        const unsigned long pressEvents[] = { vtkCommand::LeftButtonPressEvent, vtkCommand::MiddleButtonPressEvent, vtkCommand::RightButtonPressEvent };
+        const unsigned long releaseEvents[] = { vtkCommand::LeftButtonReleaseEvent, vtkCommand::MiddleButtonReleaseEvent, vtkCommand::RightButtonReleaseEvent };
+        for (unsigned long event : pressEvents)
+            observers.append(interactor->AddObserver(event, this, &PartPicker::onButtonPress));
+        for (unsigned long event : releaseEvents)
+            observers.append(interactor->AddObserver(event, this, &PartPicker::onButtonRelease));
+    }
+}
+
+/**
+ * @brief Detaches the picker from the interactor.
+ */
+PartPicker::~PartPicker() {
+    vtkRenderWindowInteractor* interactor = renderWindow->GetInteractor();
+    if (interactor) {
+        for (unsigned long tag : observers)
+            interactor->RemoveObserver(tag);
+    }
+}
+
+/**
+ * @brief Makes a part pickable by recording which actor belongs to it.
+ *
+ * @param part The part to register; parts without an actor are ignored.
+ */
+void PartPicker::registerPart(ModelPart* part) {
+    if (part && part->getActor()) {
+        actorToPart.insert(part->getActor(), part->id());
+        invalidate();
+    }
+}
+
+/**
+ * @brief Stops a part from being picked, typically because it is about to be deleted.
+ *
+ * @param part The part to unregister.
+ */
+void PartPicker::unregisterPart(ModelPart* part) {
+    if (!part || !part->getActor())
+        return;
+
+    if (hovered == part->id())
+        clearHighlight(); // The part may come back, for example when its deletion is undone
+    actorToPart.remove(part->getActor());
+    invalidate();
+}
+
+/**
+ * @brief Looks up the part that owns an actor.
+ *
+ * @param actor The actor to look up.
+ * @return The owning part, or nullptr if the actor does not belong to a registered part.
+ */
+ModelPart* PartPicker::partForActor(vtkProp* actor) const {
+    return PartRegistry::instance().find(actorToPart.value(actor, 0));
+}
+
+/**
+ * @brief Returns the part drawn at a display position.
+ *
+ * @param x The horizontal display coordinate in pixels.
+ * @param y The vertical display coordinate in pixels, measured from the bottom of the window.
+ * @return The part at that pixel, or nullptr if there is none.
+ */
+ModelPart* PartPicker::pick(int x, int y) {
+    vtkRenderWindowInteractor* interactor = renderWindow->GetInteractor();
+    vtkRenderer* target = interactor ? interactor->FindPokedRenderer(x, y) : nullptr;
+    if (!target)
+        target = renderer;
+    if (x < 0 || y < 0 || !ensureBuffers(target))
+        return nullptr;
+
+    unsigned int position[2] = { static_cast<unsigned int>(x), static_cast<unsigned int>(y) };
+    unsigned int selected[2];
+    vtkHardwareSelector::PixelInformation info = selector->GetPixelInformation(position, 0, selected);
+    return info.Valid ? partForActor(info.Prop) : nullptr;
+}
+
+/**
+ * @brief Discards the captured ID buffer, for example after parts were added, removed or hidden.
+ */
+void PartPicker::invalidate() {
+    if (buffersValid)
+        selector->ClearBuffers();
+    buffersValid = false;
+}
+
+/**
+ * @brief Highlights the part under the mouse while no button is held.
+ */
+void PartPicker::onMouseMove(vtkObject*, unsigned long, void*) {
+    if (buttonsHeld > 0)
+        return;
+
+    int* position = renderWindow->GetInteractor()->GetEventPosition();
+    setHovered(pick(position[0], position[1]));
+}
+
+/**
+ * @brief Records a button press so that drags are not treated as clicks or hovers.
+ */
+void PartPicker::onButtonPress(vtkObject*, unsigned long eventId, void*) {
+    ++buttonsHeld;
+    if (eventId == vtkCommand::LeftButtonPressEvent) {
+        int* position = renderWindow->GetInteractor()->GetEventPosition();
+        pressPosition[0] = position[0];
+        pressPosition[1] = position[1];
+    }
+}
+
+/**
+ * @brief Reports a pick when the left button is released where it was pressed.
+ *
+ * Holding Ctrl or Shift asks for the part to be added to the current selection.
+ */
+void PartPicker::onButtonRelease(vtkObject*, unsigned long eventId, void*) {
+    buttonsHeld = buttonsHeld > 0 ? buttonsHeld - 1 : 0;
+    if (eventId != vtkCommand::LeftButtonReleaseEvent)
+        return;
+
+    vtkRenderWindowInteractor* interactor = renderWindow->GetInteractor();
+    int* position = interactor->GetEventPosition();
+    if (std::abs(position[0] - pressPosition[0]) > 2 || std::abs(position[1] - pressPosition[1]) > 2)
+        return;
+
+    ModelPart* part = pick(position[0], position[1]);
+    if (part)
+        emit partPicked(part, interactor->GetControlKey() || interactor->GetShiftKey());
+}
+
+/**
+ * @brief Captures the prop ID buffer of a view if it has changed since the last capture.
+ *
+ * @param target The view to capture.
+ * @return True if a valid buffer is available.
+ */
+bool PartPicker::ensureBuffers(vtkRenderer* target) {
+    int* size = target->GetSize();
+    vtkMTimeType cameraTime = target->GetActiveCamera()->GetMTime();
+    if (buffersValid && target == capturedRenderer && cameraTime == capturedCameraTime &&
+        size[0] == capturedSize[0] && size[1] == capturedSize[1])
+        return true;
+
+    invalidate();
+    if (size[0] <= 0 || size[1] <= 0)
+        return false;
+
+    capturedRenderer = target;
+    selector->SetRenderer(target);
+    int* origin = target->GetOrigin();
+    selector->SetArea(origin[0], origin[1], origin[0] + size[0] - 1, origin[1] + size[1] - 1);
+    buffersValid = selector->CaptureBuffers();
+    capturedCameraTime = cameraTime;
+    capturedSize[0] = size[0];
+    capturedSize[1] = size[1];
+    return buffersValid;
+}
+
+/**
+ * @brief Moves the hover highlight to a new part and emits partHovered() if it changed.
+ *
+ * The highlight is drawn with the ambient term so that it does not disturb the part's colour. The
+ * part's own ambient settings are saved and put back when the highlight moves on.
+ *
+ * @param part The part now under the mouse, or nullptr.
+ */
+void PartPicker::setHovered(ModelPart* part) {
+    quint64 id = part ? part->id() : 0;
+    if (id == hovered)
+        return;
+
+    clearHighlight();
+    if (part) {
+        vtkProperty* property = part->getActor()->GetProperty();
+        savedAmbient = property->GetAmbient();
+        property->GetAmbientColor(savedAmbientColour);
+        property->SetAmbientColor(1.0, 0.85, 0.2);
+        property->SetAmbient(0.4);
+        hovered = id;
+    }
+
+    emit partHovered(part);
+}
+
+/**
+ * @brief Gives the hovered part back its own ambient settings and forgets it.
+ */
+void PartPicker::clearHighlight() {
+    ModelPart* previous = PartRegistry::instance().find(hovered);
+    if (previous && previous->getActor()) {
+        vtkProperty* property = previous->getActor()->GetProperty();
+        property->SetAmbientColor(savedAmbientColour);
+        property->SetAmbient(savedAmbient);
+    }
+    hovered = 0;
+}
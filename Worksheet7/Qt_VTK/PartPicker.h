@@ -0,0 +1,77 @@
+/**
+ * @file PartPicker.h
+ *
+ * Defines the PartPicker class, which identifies the ModelPart under the mouse in the VTK view using
+ * hardware selection, highlights it while hovered and reports clicks on it.
+ */
+
+#ifndef VIEWER_PARTPICKER_H
+#define VIEWER_PARTPICKER_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <vtkSmartPointer.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderer.h>
+#include <vtkHardwareSelector.h>
+#include "ModelPart.h"
+
+class vtkObject;
+class vtkProp;
+
+/**
+ * @class PartPicker
+ * @brief Maps pixels in the view to ModelParts through a hardware ID buffer.
+ *
+ * The selector renders prop IDs into an offscreen buffer once and keeps it until the camera, the
+ * window size or the scene changes, so each hover or click afterwards is a single pixel read plus
+ * a hash lookup from actor to part ID, independent of the number of parts in the scene. In a split
+ * layout the buffer is captured for whichever view is under the mouse. Parts are held by ID and
+ * resolved through the PartRegistry, so a stale entry never reaches a deleted part.
+ *
+ * The picker changes the hovered actor's ambient lighting but does not render; the owner queues
+ * a frame when partHovered() is emitted.
+ */
+class PartPicker : public QObject {
+    Q_OBJECT
+
+public:
+    PartPicker(vtkRenderWindow* renderWindow, vtkRenderer* renderer, QObject* parent = nullptr);
+    ~PartPicker();
+
+    void registerPart(ModelPart* part);
+    void unregisterPart(ModelPart* part);
+    ModelPart* partForActor(vtkProp* actor) const;
+    ModelPart* pick(int x, int y);
+    void invalidate();
+
+signals:
+    void partPicked(ModelPart* part, bool extendSelection);
+    void partHovered(ModelPart* part);
+
+private:
+    void onMouseMove(vtkObject* caller, unsigned long eventId, void* callData);
+    void onButtonPress(vtkObject* caller, unsigned long eventId, void* callData);
+    void onButtonRelease(vtkObject* caller, unsigned long eventId, void* callData);
+    bool ensureBuffers(vtkRenderer* target);
+    void setHovered(ModelPart* part);
+    void clearHighlight();
+
+    vtkSmartPointer<vtkRenderWindow> renderWindow; ///< Window the picks are made in.
+    vtkSmartPointer<vtkRenderer> renderer; ///< Renderer picked in when the position is in no other view.
+    vtkRenderer* capturedRenderer; ///< View the current buffers were captured for.
+    vtkSmartPointer<vtkHardwareSelector> selector; ///< Renders and holds the prop ID buffer.
+    QHash<vtkProp*, quint64> actorToPart; ///< Lookup from actor to the ID of the part that owns it.
+    QList<unsigned long> observers; ///< Observer tags registered on the interactor.
+    quint64 hovered; ///< ID of the part currently highlighted under the mouse, or 0.
+    double savedAmbient; ///< Ambient coefficient of the hovered part before it was highlighted.
+    double savedAmbientColour[3]; ///< Ambient colour of the hovered part before it was highlighted.
+    vtkMTimeType capturedCameraTime; ///< Camera modification time when the buffers were captured.
+    int capturedSize[2]; ///< Renderer size when the buffers were captured.
+    bool buffersValid; ///< True while the captured ID buffer matches the view.
+    int buttonsHeld; ///< Number of mouse buttons currently held in the view.
+    int pressPosition[2]; ///< Where the left button went down, to tell clicks from drags.
+};
+
+#endif // VIEWER_PARTPICKER_H
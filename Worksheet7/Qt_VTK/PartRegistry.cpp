@@ -0,0 +1,128 @@
+/**
+ * @file PartRegistry.cpp
+ * @brief Implementation of the PartRegistry class.
+ */
+
+#include "PartRegistry.h"
+#include <QMutexLocker>
+
+/**
+ * @brief Returns the process-wide registry.
+ */
+PartRegistry& PartRegistry::instance() {
+    static PartRegistry registry;
+    return registry;
+}
+
+/**
+ * @brief Creates an empty registry.
+ */
+PartRegistry::PartRegistry() : table(1024), count(0), nextId(1) {
+}
+
+/**
+ * @brief Registers a part under a new ID.
+ *
+ * @param part The part being constructed.
+ * @return The part's ID, never 0.
+ */
+quint64 PartRegistry::add(ModelPart* part) {
+    QMutexLocker locker(&mutex);
+    if (2 * (count + 1) > static_cast<int>(table.size()))
+        grow();
+    quint64 id = nextId++;
+    place(id, part);
+    ++count;
+    return id;
+}
+
+/**
+ * @brief Unregisters a part that is being destroyed.
+ *
+ * @param id The part's ID. Unknown IDs are ignored.
+ */
+void PartRegistry::remove(quint64 id) {
+    QMutexLocker locker(&mutex);
+    const std::size_t mask = table.size() - 1;
+    std::size_t hole = hash(id) & mask;
+    while (table[hole].id != id) {
+        if (table[hole].id == 0)
+            return;
+        hole = (hole + 1) & mask;
+    }
+
+    // Shift back every later entry of the run whose home slot does not lie between the hole and it
+    for (std::size_t next = (hole + 1) & mask; table[next].id != 0; next = (next + 1) & mask) {
+        std::size_t home = hash(table[next].id) & mask;
+        bool staysPut = hole <= next ? (hole < home && home <= next) : (hole < home || home <= next);
+        if (staysPut)
+            continue;
+        table[hole] = table[next];
+        hole = next;
+    }
+    table[hole] = Slot();
+    --count;
+}
+
+/**
+ * @brief Looks up a part by ID.
+ *
+ * @param id The ID to look up.
+ * @return The part, or nullptr if it has been deleted or the ID was never issued.
+ */
+ModelPart* PartRegistry::find(quint64 id) const {
+    if (id == 0)
+        return nullptr;
+
+    QMutexLocker locker(&mutex);
+    const std::size_t mask = table.size() - 1;
+    for (std::size_t slot = hash(id) & mask; table[slot].id != 0; slot = (slot + 1) & mask) {
+        if (table[slot].id == id)
+            return table[slot].part;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Returns the number of live parts.
+ */
+int PartRegistry::size() const {
+    QMutexLocker locker(&mutex);
+    return count;
+}
+
+/**
+ * @brief Scrambles an ID so consecutive IDs spread over the table (the SplitMix64 finalizer).
+ */
+quint64 PartRegistry::hash(quint64 id) {
+    id ^= id >> 30;
+    id *= 0xbf58476d1ce4e5b9ULL;
+    id ^= id >> 27;
+    id *= 0x94d049bb133111ebULL;
+    id ^= id >> 31;
+    return id;
+}
+
+/**
+ * @brief Stores an entry in the first free slot of its probe run. The mutex must be held.
+ */
+void PartRegistry::place(quint64 id, ModelPart* part) {
+    const std::size_t mask = table.size() - 1;
+    std::size_t slot = hash(id) & mask;
+    while (table[slot].id != 0)
+        slot = (slot + 1) & mask;
+    table[slot].id = id;
+    table[slot].part = part;
+}
+
+/**
+ * @brief Doubles the table and reinserts every entry. The mutex must be held.
+ */
+void PartRegistry::grow() {
+    std::vector<Slot> old(table.size() * 2);
+    old.swap(table);
+    for (const Slot& slot : old) {
+        if (slot.id != 0)
+            place(slot.id, slot.part);
+    }
+}
@@ -0,0 +1,60 @@
+/**
+ * @file PartRegistry.h
+ *
+ * Defines the PartRegistry class, which maps the stable 64-bit ID of every live ModelPart to the
+ * part, so that other subsystems can refer to parts without holding pointers to them.
+ */
+
+#ifndef VIEWER_PARTREGISTRY_H
+#define VIEWER_PARTREGISTRY_H
+
+#include <QMutex>
+#include <QtGlobal>
+#include <vector>
+
+class ModelPart;
+
+/**
+ * @class PartRegistry
+ * @brief Process-wide open-addressing hash map from part ID to part.
+ *
+ * IDs are handed out from a counter and never reused, so an ID kept after its part was deleted
+ * looks up to nullptr rather than to whichever part now occupies the same memory. The table uses
+ * linear probing over a power-of-two array kept at most half full, and removes entries by shifting
+ * later entries of the same probe run back, so lookups never have to skip tombstones.
+ *
+ * All methods are safe to call from loader threads.
+ */
+class PartRegistry {
+public:
+    static PartRegistry& instance();
+
+    quint64 add(ModelPart* part);
+    void remove(quint64 id);
+    ModelPart* find(quint64 id) const;
+    int size() const;
+
+private:
+    /**
+     * @brief One table entry; an ID of 0 marks an empty slot.
+     */
+    struct Slot {
+        quint64 id = 0; ///< The part's ID, or 0 if the slot is empty.
+        ModelPart* part = nullptr; ///< The part.
+    };
+
+    PartRegistry();
+    PartRegistry(const PartRegistry&) = delete;
+    PartRegistry& operator=(const PartRegistry&) = delete;
+
+    static quint64 hash(quint64 id);
+    void place(quint64 id, ModelPart* part);
+    void grow();
+
+    mutable QMutex mutex; ///< Guards the table and the counter.
+    std::vector<Slot> table; ///< Slots, a power of two in number.
+    int count; ///< Occupied slots.
+    quint64 nextId; ///< ID given to the next part.
+};
+
+#endif // VIEWER_PARTREGISTRY_H
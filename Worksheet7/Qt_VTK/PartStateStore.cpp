@@ -0,0 +1,137 @@
+/**
+ * @file PartStateStore.cpp
+ * @brief Implementation of the PartStateStore class.
+ */
+
+#include "PartStateStore.h"
+#include <QMutexLocker>
+#include <stdexcept>
+
+/**
+ * @brief Returns the process-wide store.
+ */
+PartStateStore& PartStateStore::instance() {
+    static PartStateStore store;
+    return store;
+}
+
+/**
+ * @brief Creates an empty store.
+ */
+PartStateStore::PartStateStore() : nextId(0) {
+    for (std::atomic<Block*>& entry : blocks)
+        entry.store(nullptr, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Frees every block.
+ */
+PartStateStore::~PartStateStore() {
+    for (std::atomic<Block*>& entry : blocks)
+        delete entry.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Reserves a node ID with default state: visible, white and opaque.
+ *
+ * @param name The node's display name.
+ * @return The new node's ID.
+ */
+quint32 PartStateStore::allocate(const QString& name) {
+    QMutexLocker locker(&mutex);
+    quint32 id;
+    if (!freeIds.empty()) {
+        id = freeIds.back();
+        freeIds.pop_back();
+    }
+    else {
+        if (nextId >= BlockSize * MaxBlocks)
+            throw std::length_error("PartStateStore: too many parts");
+        id = nextId++;
+        std::atomic<Block*>& entry = blocks[id >> BlockBits];
+        if (!entry.load(std::memory_order_relaxed))
+            entry.store(new Block, std::memory_order_release);
+    }
+
+    Block* b = block(id);
+    quint32 slot = id & (BlockSize - 1);
+    b->names[slot] = name;
+    b->visible[slot] = 1;
+    b->colours[slot] = qRgb(255, 255, 255);
+    b->opacities[slot] = 1.0f;
+    return id;
+}
+
+/**
+ * @brief Returns a node ID to the store for reuse.
+ *
+ * @param id The ID of the node being destroyed.
+ */
+void PartStateStore::release(quint32 id) {
+    QMutexLocker locker(&mutex);
+    block(id)->names[id & (BlockSize - 1)] = QString(); // Free the string now rather than on reuse
+    freeIds.push_back(id);
+}
+
+/**
+ * @brief Returns a node's display name.
+ */
+const QString& PartStateStore::name(quint32 id) const {
+    return block(id)->names[id & (BlockSize - 1)];
+}
+
+/**
+ * @brief Sets a node's display name.
+ */
+void PartStateStore::setName(quint32 id, const QString& name) {
+    block(id)->names[id & (BlockSize - 1)] = name;
+}
+
+/**
+ * @brief Returns whether a node is shown.
+ */
+bool PartStateStore::visible(quint32 id) const {
+    return block(id)->visible[id & (BlockSize - 1)] != 0;
+}
+
+/**
+ * @brief Sets whether a node is shown.
+ */
+void PartStateStore::setVisible(quint32 id, bool visible) {
+    block(id)->visible[id & (BlockSize - 1)] = visible ? 1 : 0;
+}
+
+/**
+ * @brief Returns a node's colour.
+ */
+QRgb PartStateStore::colour(quint32 id) const {
+    return block(id)->colours[id & (BlockSize - 1)];
+}
+
+/**
+ * @brief Sets a node's colour.
+ */
+void PartStateStore::setColour(quint32 id, QRgb colour) {
+    block(id)->colours[id & (BlockSize - 1)] = colour;
+}
+
+/**
+ * @brief Returns a node's opacity, from 0 to 1.
+ */
+float PartStateStore::opacity(quint32 id) const {
+    return block(id)->opacities[id & (BlockSize - 1)];
+}
+
+/**
+ * @brief Sets a node's opacity, from 0 to 1.
+ */
+void PartStateStore::setOpacity(quint32 id, float opacity) {
+    block(id)->opacities[id & (BlockSize - 1)] = opacity;
+}
+
+/**
+ * @brief Returns the block holding a node ID.
+ */
+PartStateStore::Block* PartStateStore::block(quint32 id) const {
+    return blocks[id >> BlockBits].load(std::memory_order_acquire);
+}
@@ -0,0 +1,76 @@
+/**
+ * @file PartStateStore.h
+ *
+ * Defines the PartStateStore class, which holds the name, visibility, colour and opacity of every
+ * ModelPart as typed arrays indexed by node ID instead of inside each part.
+ */
+
+#ifndef VIEWER_PARTSTATESTORE_H
+#define VIEWER_PARTSTATESTORE_H
+
+#include <QMutex>
+#include <QRgb>
+#include <QString>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class PartStateStore
+ * @brief Process-wide structure-of-arrays table of part display state.
+ *
+ * Node IDs are slots in this table, not part identities: they are handed out densely, reused after
+ * release and private to ModelPart. Other subsystems refer to parts by their PartRegistry ID. The
+ * state lives in fixed-size blocks, each holding one array per field, so a tree-wide change such
+ * as hiding a subtree writes a run of bytes rather than a string per part, and the blocks never
+ * move once created.
+ *
+ * Allocation and release may be called from loader threads. A node's fields may be read and
+ * written without locking by whichever thread currently owns the part; blocks are published
+ * atomically, so other nodes being allocated at the same time do not disturb them.
+ */
+class PartStateStore {
+public:
+    static PartStateStore& instance();
+
+    quint32 allocate(const QString& name);
+    void release(quint32 id);
+
+    const QString& name(quint32 id) const;
+    void setName(quint32 id, const QString& name);
+    bool visible(quint32 id) const;
+    void setVisible(quint32 id, bool visible);
+    QRgb colour(quint32 id) const;
+    void setColour(quint32 id, QRgb colour);
+    float opacity(quint32 id) const;
+    void setOpacity(quint32 id, float opacity);
+
+private:
+    static constexpr int BlockBits = 12; ///< log2 of the nodes per block.
+    static constexpr quint32 BlockSize = 1u << BlockBits; ///< Nodes per block.
+    static constexpr quint32 MaxBlocks = 1u << 14; ///< Blocks addressable, for up to 64M live nodes.
+
+    /**
+     * @brief State of BlockSize consecutive node IDs, one array per field.
+     */
+    struct Block {
+        QString names[BlockSize]; ///< Display name.
+        std::uint8_t visible[BlockSize]; ///< 1 if the part is shown.
+        QRgb colours[BlockSize]; ///< Diffuse colour as 0xAARRGGBB.
+        float opacities[BlockSize]; ///< Opacity from 0 to 1.
+    };
+
+    PartStateStore();
+    ~PartStateStore();
+    PartStateStore(const PartStateStore&) = delete;
+    PartStateStore& operator=(const PartStateStore&) = delete;
+
+    Block* block(quint32 id) const;
+
+    std::atomic<Block*> blocks[MaxBlocks]; ///< Blocks created so far, nullptr beyond them.
+    QMutex mutex; ///< Guards allocation and the free list.
+    std::vector<quint32> freeIds; ///< Released IDs, reused before new ones.
+    quint32 nextId; ///< First never-used ID.
+};
+
+#endif // VIEWER_PARTSTATESTORE_H
@@ -0,0 +1,97 @@
+/**
+ * @file PropertyTransaction.cpp
+ * @brief Implementation of the PropertyTransaction class.
+ */
+
+#include "PropertyTransaction.h"
+#include "ModelPart.h"
+
+/**
+ * @brief Records a new name for a part.
+ */
+void PropertyTransaction::setName(ModelPart* part, const QString& name) {
+    Edit& edit = editFor(part);
+    edit.fields |= Name;
+    edit.name = name;
+}
+
+/**
+ * @brief Records a new visibility for a part.
+ */
+void PropertyTransaction::setVisible(ModelPart* part, bool visible) {
+    Edit& edit = editFor(part);
+    edit.fields |= Visible;
+    edit.visible = visible;
+}
+
+/**
+ * @brief Records a new colour for a part.
+ */
+void PropertyTransaction::setColour(ModelPart* part, const QColor& colour) {
+    Edit& edit = editFor(part);
+    edit.fields |= Colour;
+    edit.colour = colour;
+}
+
+/**
+ * @brief Records a new opacity for a part. Values outside 0 to 1 are clamped when applied.
+ */
+void PropertyTransaction::setOpacity(ModelPart* part, double opacity) {
+    Edit& edit = editFor(part);
+    edit.fields |= Opacity;
+    edit.opacity = opacity;
+}
+
+/**
+ * @brief Records the same visibility, colour and opacity for a part and all of its built descendants.
+ *
+ * Deferred children are not built here; callers that need them edited too build them first with
+ * ModelPartList::materializeSubtree().
+ *
+ * @param part The root of the subtree.
+ * @param visible The visibility to apply.
+ * @param colour The colour to apply.
+ * @param opacity The opacity to apply.
+ */
+void PropertyTransaction::setSubtreeProperties(ModelPart* part, bool visible, const QColor& colour, double opacity) {
+    std::vector<ModelPart*> stack{ part };
+    while (!stack.empty()) {
+        ModelPart* next = stack.back();
+        stack.pop_back();
+        Edit& edit = editFor(next);
+        edit.fields |= Visible | Colour | Opacity;
+        edit.visible = visible;
+        edit.colour = colour;
+        edit.opacity = opacity;
+        for (int row = next->childCount() - 1; row >= 0; --row)
+            stack.push_back(next->child(row));
+    }
+}
+
+/**
+ * @brief Returns true if no edits have been recorded.
+ */
+bool PropertyTransaction::isEmpty() const {
+    return entries.empty();
+}
+
+/**
+ * @brief Returns the recorded edits, one per part.
+ */
+const std::vector<PropertyTransaction::Edit>& PropertyTransaction::edits() const {
+    return entries;
+}
+
+/**
+ * @brief Returns the edit for a part, adding an empty one on first use.
+ */
+PropertyTransaction::Edit& PropertyTransaction::editFor(ModelPart* part) {
+    auto it = entryOf.constFind(part);
+    if (it != entryOf.constEnd())
+        return entries[it.value()];
+
+    entryOf.insert(part, static_cast<int>(entries.size()));
+    entries.push_back(Edit());
+    entries.back().part = part;
+    return entries.back();
+}
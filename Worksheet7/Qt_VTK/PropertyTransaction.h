@@ -0,0 +1,66 @@
+/**
+ * @file PropertyTransaction.h
+ *
+ * Defines the PropertyTransaction class, which records name, visibility, colour and opacity edits
+ * to many parts so they can be applied together.
+ */
+
+#ifndef VIEWER_PROPERTYTRANSACTION_H
+#define VIEWER_PROPERTYTRANSACTION_H
+
+#include <QColor>
+#include <QHash>
+#include <QString>
+#include <vector>
+
+class ModelPart;
+
+/**
+ * @class PropertyTransaction
+ * @brief Batch of property edits, applied in one pass by ModelPartList::applyProperties().
+ *
+ * Recording an edit only stores it; nothing is changed until the transaction is applied. Several
+ * edits to the same part are merged into one entry, the last value of each property winning, so
+ * each part is visited once however many edits touched it. Applying a transaction notifies views
+ * with one dataChanged range per parent and the renderer with one batch of changes.
+ */
+class PropertyTransaction {
+public:
+    /**
+     * @brief The properties an edit sets, combined as bit flags.
+     */
+    enum Field {
+        Name = 1, ///< The display name.
+        Visible = 2, ///< Whether the part is shown.
+        Colour = 4, ///< The diffuse colour.
+        Opacity = 8 ///< The opacity.
+    };
+
+    /**
+     * @brief New property values for one part.
+     */
+    struct Edit {
+        ModelPart* part = nullptr; ///< The part to change.
+        int fields = 0; ///< The Field flags that are set.
+        QString name; ///< New name, if Name is set.
+        bool visible = true; ///< New visibility, if Visible is set.
+        QColor colour; ///< New colour, if Colour is set.
+        double opacity = 1.0; ///< New opacity, if Opacity is set.
+    };
+
+    void setName(ModelPart* part, const QString& name);
+    void setVisible(ModelPart* part, bool visible);
+    void setColour(ModelPart* part, const QColor& colour);
+    void setOpacity(ModelPart* part, double opacity);
+    void setSubtreeProperties(ModelPart* part, bool visible, const QColor& colour, double opacity);
+    bool isEmpty() const;
+    const std::vector<Edit>& edits() const;
+
+private:
+    Edit& editFor(ModelPart* part);
+
+    std::vector<Edit> entries; ///< One merged edit per part, in the order the parts were first edited.
+    QHash<ModelPart*, int> entryOf; ///< Position of each part's edit in entries.
+};
+
+#endif // VIEWER_PROPERTYTRANSACTION_H
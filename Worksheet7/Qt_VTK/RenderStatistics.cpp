@@ -0,0 +1,323 @@
+/**
+ * @file RenderStatistics.cpp
+ * @brief Implementation of the RenderStatistics class.
+ *
+ * Times frames on the CPU and GPU, counts what the scene submitted, and keeps a rolling history
+ * that backs the overlay and the CSV exports.
+ */
+
+#include "RenderStatistics.h"
+#include <QFile>
+#include <QTextStream>
+#include <vtkCamera.h>
+#include <vtkCellArray.h>
+#include <vtkCommand.h>
+#include <vtkMapper.h>
+#include <vtkPolyData.h>
+#include <vtkTextProperty.h>
+#include <algorithm>
+#include <vector>
+
+ /**
+  * @brief Constructs the statistics collector and attaches it to the given window.
+  *
+  * Adds an overlay layer to the render window and observes the window and the scene renderer so
+  * that every frame is measured. The overlay starts hidden.
+  *
+  * @param renderWindow The render window to measure.
+  * @param sceneRenderer The renderer that holds the model parts.
+  * @param parent The parent QObject.
+  */
+RenderStatistics::RenderStatistics(vtkRenderWindow* renderWindow, vtkRenderer* sceneRenderer, QObject* parent)
+    : QObject(parent), renderWindow(renderWindow), sceneRenderer(sceneRenderer),
+    activeGpuTimer(-1), frameCount(0), historyLength(1000) {
+    overlayText = vtkSmartPointer<vtkTextActor>::New();
+    overlayText->SetDisplayPosition(10, 10);
+    overlayText->GetTextProperty()->SetFontFamilyToCourier();
+    overlayText->GetTextProperty()->SetFontSize(14);
+    overlayText->GetTextProperty()->SetColor(1.0, 1.0, 0.0);
+    overlayText->SetVisibility(false);
+
+    overlayRenderer = vtkSmartPointer<vtkRenderer>::New();
+    overlayRenderer->SetLayer(1);
+    overlayRenderer->InteractiveOff();
+    overlayRenderer->AddViewProp(overlayText);
+    renderWindow->SetNumberOfLayers(std::max(2, renderWindow->GetNumberOfLayers()));
+    renderWindow->AddRenderer(overlayRenderer);
+
+    windowObservers.append(renderWindow->AddObserver(vtkCommand::StartEvent, this, &RenderStatistics::onFrameStart));
+    windowObservers.append(renderWindow->AddObserver(vtkCommand::EndEvent, this, &RenderStatistics::onFrameEnd));
+    rendererObservers.append(sceneRenderer->AddObserver(vtkCommand::StartEvent, this, &RenderStatistics::onSceneStart));
+    rendererObservers.append(sceneRenderer->AddObserver(vtkCommand::EndEvent, this, &RenderStatistics::onSceneEnd));
+}
+
+/**
+ * @brief Detaches the collector and removes the overlay layer.
+ */
+RenderStatistics::~RenderStatistics() {
+    for (unsigned long tag : windowObservers)
+        renderWindow->RemoveObserver(tag);
+    for (unsigned long tag : rendererObservers)
+        sceneRenderer->RemoveObserver(tag);
+    renderWindow->RemoveRenderer(overlayRenderer);
+}
+
+/**
+ * @brief Replaces the set of parts counted in each frame.
+ *
+ * @param parts The parts currently in the scene.
+ */
+void RenderStatistics::setParts(const QList<ModelPart*>& parts) {
+    this->parts = parts;
+}
+
+/**
+ * @brief Shows or hides the statistics overlay.
+ *
+ * @param visible True to draw the overlay on top of the scene.
+ */
+void RenderStatistics::setOverlayVisible(bool visible) {
+    overlayText->SetVisibility(visible);
+    updateOverlayText();
+    renderWindow->Render();
+}
+
+/**
+ * @brief Reports whether the statistics overlay is shown.
+ *
+ * @return True if the overlay is visible.
+ */
+bool RenderStatistics::overlayVisible() const {
+    return overlayText->GetVisibility();
+}
+
+/**
+ * @brief Sets how many frames the rolling history keeps.
+ *
+ * @param frames The maximum number of frames to keep, at least 1.
+ */
+void RenderStatistics::setHistoryLength(int frames) {
+    historyLength = std::max(1, frames);
+    while (this->frames.size() > historyLength)
+        this->frames.removeFirst();
+}
+
+/**
+ * @brief Returns the statistics of the most recently completed frame.
+ *
+ * @return The last frame's statistics, or default values if nothing has been rendered.
+ */
+FrameStatistics RenderStatistics::lastFrame() const {
+    return frames.isEmpty() ? FrameStatistics() : frames.last();
+}
+
+/**
+ * @brief Returns the rolling history of frame statistics.
+ *
+ * @return The recorded frames, oldest first.
+ */
+QList<FrameStatistics> RenderStatistics::history() const {
+    return frames;
+}
+
+/**
+ * @brief Writes every frame in the rolling history to a CSV file.
+ *
+ * @param fileName The path of the CSV file to write.
+ * @return True if the file was written.
+ */
+bool RenderStatistics::exportFramesCsv(const QString& fileName) const {
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+
+    QTextStream out(&file);
+    out << "frame,cpu_ms,gpu_ms,draw_calls,triangles,visible_parts,culled_parts,gpu_memory_mb\n";
+    qint64 firstFrame = frameCount - frames.size();
+    for (int i = 0; i < frames.size(); ++i) {
+        const FrameStatistics& frame = frames[i];
+        out << (firstFrame + i) << ',' << frame.cpuFrameTime << ',' << frame.gpuFrameTime << ','
+            << frame.drawCalls << ',' << frame.triangles << ',' << frame.visibleParts << ','
+            << frame.culledParts << ',' << frame.gpuMemory << '\n';
+    }
+    return true;
+}
+
+/**
+ * @brief Writes histograms of CPU and GPU frame times over the rolling history to a CSV file.
+ *
+ * Frames slower than the last bin are counted in a final overflow row.
+ *
+ * @param fileName The path of the CSV file to write.
+ * @param binWidth The width of each bin in milliseconds.
+ * @param binCount The number of bins before the overflow row.
+ * @return True if the file was written.
+ */
+bool RenderStatistics::exportHistogramCsv(const QString& fileName, double binWidth, int binCount) const {
+    if (binWidth <= 0.0 || binCount <= 0)
+        return false;
+
+    std::vector<int> cpuBins(binCount + 1, 0);
+    std::vector<int> gpuBins(binCount + 1, 0);
+    for (const FrameStatistics& frame : frames) {
+        cpuBins[std::min(binCount, static_cast<int>(frame.cpuFrameTime / binWidth))]++;
+        if (frame.gpuFrameTime >= 0.0)
+            gpuBins[std::min(binCount, static_cast<int>(frame.gpuFrameTime / binWidth))]++;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+
+    QTextStream out(&file);
+    out << "bin_start_ms,bin_end_ms,cpu_frames,gpu_frames\n";
+    for (int bin = 0; bin <= binCount; ++bin) {
+        out << bin * binWidth << ',';
+        if (bin < binCount)
+            out << (bin + 1) * binWidth;
+        out << ',' << cpuBins[bin] << ',' << gpuBins[bin] << '\n';
+    }
+    return true;
+}
+
+/**
+ * @brief Starts timing a frame and refreshes the overlay with the previous frame's results.
+ */
+void RenderStatistics::onFrameStart(vtkObject*, unsigned long, void*) {
+    current = FrameStatistics();
+    frameTimer.start();
+    if (overlayText->GetVisibility())
+        updateOverlayText();
+}
+
+/**
+ * @brief Completes the current frame and appends it to the history.
+ */
+void RenderStatistics::onFrameEnd(vtkObject*, unsigned long, void*) {
+    if (!frameTimer.isValid())
+        return;
+
+    current.cpuFrameTime = frameTimer.nsecsElapsed() / 1.0e6;
+    frames.append(current);
+    while (frames.size() > historyLength)
+        frames.removeFirst();
+    ++frameCount;
+
+    emit frameRecorded(current);
+}
+
+/**
+ * @brief Starts a GPU timer query around the scene renderer.
+ *
+ * Results of earlier queries are collected first. If every timer is still waiting for its result
+ * the frame is left without a GPU time rather than stalling the pipeline.
+ */
+void RenderStatistics::onSceneStart(vtkObject*, unsigned long, void*) {
+    collectGpuTimes();
+
+    activeGpuTimer = -1;
+    for (int i = 0; i < static_cast<int>(gpuTimers.size()); ++i) {
+        if (!gpuTimers[i].Started()) {
+            gpuTimers[i].Start();
+            gpuTimerFrame[i] = frameCount;
+            activeGpuTimer = i;
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Stops the GPU timer query and counts what the scene submitted.
+ */
+void RenderStatistics::onSceneEnd(vtkObject*, unsigned long, void*) {
+    if (activeGpuTimer >= 0)
+        gpuTimers[activeGpuTimer].Stop();
+    activeGpuTimer = -1;
+
+    measureScene(current);
+}
+
+/**
+ * @brief Stores the results of finished GPU timer queries against the frames they measured.
+ */
+void RenderStatistics::collectGpuTimes() {
+    for (int i = 0; i < static_cast<int>(gpuTimers.size()); ++i) {
+        vtkOpenGLRenderTimer& timer = gpuTimers[i];
+        if (!timer.Stopped() || !timer.Ready())
+            continue;
+
+        qint64 index = frames.size() - (frameCount - gpuTimerFrame[i]);
+        if (index >= 0 && index < frames.size())
+            frames[index].gpuFrameTime = timer.GetElapsedMilliseconds();
+        timer.Reset();
+    }
+}
+
+/**
+ * @brief Counts visible, culled and submitted geometry for the current camera.
+ *
+ * Parts are tested against the camera frustum with their bounding boxes. Draw calls are estimated
+ * as one per primitive type present in each drawn part, and buffer memory from the point and
+ * connectivity counts of the mapper input.
+ *
+ * @param frame The frame statistics to fill in.
+ */
+void RenderStatistics::measureScene(FrameStatistics& frame) const {
+    double planes[24];
+    sceneRenderer->GetActiveCamera()->GetFrustumPlanes(sceneRenderer->GetTiledAspectRatio(), planes);
+
+    double bytes = 0.0;
+    for (ModelPart* part : parts) {
+        vtkActor* actor = part->getActor();
+        if (!actor || !actor->GetVisibility())
+            continue;
+        ++frame.visibleParts;
+
+        double bounds[6];
+        actor->GetBounds(bounds);
+        bool outside = false;
+        for (int p = 0; p < 6 && !outside; ++p) {
+            const double* plane = planes + 4 * p;
+            double x = plane[0] >= 0.0 ? bounds[1] : bounds[0];
+            double y = plane[1] >= 0.0 ? bounds[3] : bounds[2];
+            double z = plane[2] >= 0.0 ? bounds[5] : bounds[4];
+            outside = plane[0] * x + plane[1] * y + plane[2] * z + plane[3] < 0.0;
+        }
+        if (outside) {
+            ++frame.culledParts;
+            continue;
+        }
+
+        frame.triangles += part->primitiveCount(part->detailLevel());
+        vtkPolyData* polyData = vtkPolyData::SafeDownCast(actor->GetMapper() ? actor->GetMapper()->GetInput() : nullptr);
+        if (!polyData)
+            continue;
+
+        vtkCellArray* cells[] = { polyData->GetVerts(), polyData->GetLines(), polyData->GetPolys(), polyData->GetStrips() };
+        for (vtkCellArray* cellArray : cells) {
+            if (cellArray && cellArray->GetNumberOfCells() > 0) {
+                ++frame.drawCalls;
+                bytes += cellArray->GetNumberOfConnectivityIds() * sizeof(unsigned int);
+            }
+        }
+        bytes += polyData->GetNumberOfPoints() * 3 * sizeof(float);
+    }
+    frame.gpuMemory = bytes / (1024.0 * 1024.0);
+}
+
+/**
+ * @brief Writes the last completed frame's statistics into the overlay text.
+ */
+void RenderStatistics::updateOverlayText() {
+    FrameStatistics frame = lastFrame();
+    QString gpu = frame.gpuFrameTime >= 0.0 ? QString::number(frame.gpuFrameTime, 'f', 1) + " ms" : QString("n/a");
+    QString text = QString("CPU %1 ms   GPU %2\nDraw calls %3   Triangles %4\nParts %5 visible / %6 culled\nGPU buffers %7 MB (est.)")
+        .arg(frame.cpuFrameTime, 0, 'f', 1)
+        .arg(gpu)
+        .arg(frame.drawCalls)
+        .arg(static_cast<qlonglong>(frame.triangles))
+        .arg(frame.visibleParts)
+        .arg(frame.culledParts)
+        .arg(frame.gpuMemory, 0, 'f', 1);
+    overlayText->SetInput(text.toStdString().c_str());
+}
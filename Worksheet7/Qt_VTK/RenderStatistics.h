@@ -0,0 +1,93 @@
+/**
+ * @file RenderStatistics.h
+ *
+ * Defines the RenderStatistics class, which measures every frame rendered by the VTK view and keeps a
+ * rolling history of the results. The statistics can be read programmatically, drawn as an overlay on
+ * top of the scene and exported to CSV for performance tracking.
+ */
+
+#ifndef VIEWER_RENDERSTATISTICS_H
+#define VIEWER_RENDERSTATISTICS_H
+
+#include <QObject>
+#include <QList>
+#include <QString>
+#include <QElapsedTimer>
+#include <array>
+#include <vtkSmartPointer.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderer.h>
+#include <vtkTextActor.h>
+#include <vtkOpenGLRenderTimer.h>
+#include "ModelPart.h"
+
+class vtkObject;
+
+/**
+ * @struct FrameStatistics
+ * @brief Measurements taken for a single rendered frame.
+ */
+struct FrameStatistics {
+    double cpuFrameTime = 0.0; ///< Wall-clock time spent in the render call, in milliseconds.
+    double gpuFrameTime = -1.0; ///< GPU time of the scene pass from timer queries, in milliseconds, or -1 if not yet available.
+    int drawCalls = 0; ///< Estimated number of draw calls issued for the scene.
+    vtkIdType triangles = 0; ///< Primitives submitted by the parts that were drawn.
+    int visibleParts = 0; ///< Parts with visibility switched on.
+    int culledParts = 0; ///< Visible parts that lie outside the view frustum.
+    double gpuMemory = 0.0; ///< Estimated size of the vertex and index buffers in use, in megabytes.
+};
+
+/**
+ * @class RenderStatistics
+ * @brief Collects per-frame render statistics and presents them as an overlay.
+ *
+ * Observes the render window to time each frame on the CPU and wraps the scene renderer in GPU
+ * timer queries. The overlay lives in its own renderer layer so that clearing the scene does not
+ * remove it.
+ */
+class RenderStatistics : public QObject {
+    Q_OBJECT
+
+public:
+    RenderStatistics(vtkRenderWindow* renderWindow, vtkRenderer* sceneRenderer, QObject* parent = nullptr);
+    ~RenderStatistics();
+
+    void setParts(const QList<ModelPart*>& parts);
+    void setOverlayVisible(bool visible);
+    bool overlayVisible() const;
+    void setHistoryLength(int frames);
+    FrameStatistics lastFrame() const;
+    QList<FrameStatistics> history() const;
+    bool exportFramesCsv(const QString& fileName) const;
+    bool exportHistogramCsv(const QString& fileName, double binWidth = 1.0, int binCount = 100) const;
+
+signals:
+    void frameRecorded(const FrameStatistics& frame);
+
+private:
+    void onFrameStart(vtkObject* caller, unsigned long eventId, void* callData);
+    void onFrameEnd(vtkObject* caller, unsigned long eventId, void* callData);
+    void onSceneStart(vtkObject* caller, unsigned long eventId, void* callData);
+    void onSceneEnd(vtkObject* caller, unsigned long eventId, void* callData);
+    void collectGpuTimes();
+    void measureScene(FrameStatistics& frame) const;
+    void updateOverlayText();
+
+    vtkSmartPointer<vtkRenderWindow> renderWindow; ///< Window whose frames are measured.
+    vtkSmartPointer<vtkRenderer> sceneRenderer; ///< Renderer holding the parts.
+    vtkSmartPointer<vtkRenderer> overlayRenderer; ///< Renderer layer that draws the overlay.
+    vtkSmartPointer<vtkTextActor> overlayText; ///< Text actor showing the latest statistics.
+    std::array<vtkOpenGLRenderTimer, 3> gpuTimers; ///< Timer queries in flight, reused round-robin.
+    std::array<qint64, 3> gpuTimerFrame = {}; ///< Frame number each timer was started in.
+    int activeGpuTimer; ///< Index of the timer started for the current frame, or -1.
+    qint64 frameCount; ///< Number of frames completed since construction.
+    QList<unsigned long> windowObservers; ///< Observer tags registered on the render window.
+    QList<unsigned long> rendererObservers; ///< Observer tags registered on the scene renderer.
+    QList<ModelPart*> parts; ///< Parts currently in the scene.
+    QList<FrameStatistics> frames; ///< Rolling history of measured frames, oldest first.
+    FrameStatistics current; ///< Frame being measured.
+    QElapsedTimer frameTimer; ///< Measures the CPU cost of the current frame.
+    int historyLength; ///< Maximum number of frames kept in the history.
+};
+
+#endif // VIEWER_RENDERSTATISTICS_H
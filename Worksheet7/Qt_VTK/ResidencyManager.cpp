@@ -0,0 +1,229 @@
+/**
+ * @file ResidencyManager.cpp
+ * @brief Implementation of the ResidencyManager class.
+ *
+ * Implements the release sweep over hidden parts and the background restore of dropped meshes.
+ */
+
+#include "ResidencyManager.h"
+#include "GeometryCache.h"
+#include "PartRegistry.h"
+#include <QtConcurrent/QtConcurrentRun>
+
+ /**
+  * @brief Constructs the residency manager and starts its release sweep.
+  *
+  * @param renderWindow The render window whose context holds the parts' GPU buffers.
+  * @param parent The parent QObject.
+  */
+ResidencyManager::ResidencyManager(vtkRenderWindow* renderWindow, QObject* parent)
+    : QObject(parent), renderWindow(renderWindow) {
+    sweepTimer.setInterval(1000);
+    connect(&sweepTimer, &QTimer::timeout, this, &ResidencyManager::sweep);
+    sweepTimer.start();
+}
+
+/**
+ * @brief Replaces the release policy. Takes effect at the next sweep.
+ *
+ * @param policy The new policy.
+ */
+void ResidencyManager::setPolicy(const ResidencyPolicy& policy) {
+    currentPolicy = policy;
+}
+
+/**
+ * @brief Returns the active release policy.
+ *
+ * @return The current policy.
+ */
+ResidencyPolicy ResidencyManager::policy() const {
+    return currentPolicy;
+}
+
+/**
+ * @brief Starts tracking a part that has geometry. Parts without an actor are ignored.
+ *
+ * A part whose mesh was already dropped, such as one put back by undoing its deletion, is tracked
+ * as CPU released, so showing it restores the mesh.
+ *
+ * @param part The part to track.
+ */
+void ResidencyManager::track(ModelPart* part) {
+    if (!part || !part->getActor() || entries.contains(part->id()))
+        return;
+
+    Entry entry;
+    if (!part->geometryResident() && !part->sourceFile().isEmpty())
+        entry.state = State::CpuReleased;
+    entry.hidden = !part->visible();
+    if (entry.hidden)
+        entry.hiddenTimer.start();
+    entries.insert(part->id(), entry);
+}
+
+/**
+ * @brief Stops tracking a part, typically because it is about to be deleted.
+ *
+ * A restore still in flight for the part is discarded when it completes.
+ *
+ * @param part The part to forget.
+ */
+void ResidencyManager::forget(ModelPart* part) {
+    if (part)
+        entries.remove(part->id());
+}
+
+/**
+ * @brief Records a visibility change and restores resources if a released part is shown.
+ *
+ * @param part The part whose visibility changed.
+ * @param visible The new visibility.
+ * @return True if the part can be drawn immediately, false if its mesh is still being restored.
+ */
+bool ResidencyManager::notifyVisibility(ModelPart* part, bool visible) {
+    auto it = part ? entries.find(part->id()) : entries.end();
+    if (it == entries.end())
+        return true;
+
+    Entry& entry = it.value();
+    if (!visible) {
+        if (!entry.hidden)
+            entry.hiddenTimer.start();
+        entry.hidden = true;
+        return true;
+    }
+
+    entry.hidden = false;
+    entry.hiddenTimer.invalidate();
+    switch (entry.state) {
+    case State::Resident:
+        return true;
+    case State::GpuReleased:
+        entry.state = State::Resident; // Buffers are uploaded again on the next draw
+        return true;
+    case State::CpuReleased:
+        restore(part);
+        return false;
+    case State::Restoring:
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Returns the residency of every tracked part for the dashboard.
+ *
+ * @return One record per tracked part.
+ */
+QList<ResidencyManager::Record> ResidencyManager::records() const {
+    QList<Record> result;
+    result.reserve(entries.size());
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        ModelPart* part = PartRegistry::instance().find(it.key());
+        if (!part)
+            continue;
+        const Entry& entry = it.value();
+        Record record;
+        record.partId = it.key();
+        record.name = part->name();
+        record.state = entry.state;
+        record.hidden = entry.hidden;
+        record.hiddenFor = entry.hidden && entry.hiddenTimer.isValid() ? entry.hiddenTimer.elapsed() : 0;
+        record.cpuBytes = part->geometryBytes();
+        result.append(record);
+    }
+    return result;
+}
+
+/**
+ * @brief Returns a display name for a residency state.
+ *
+ * @param state The state to name.
+ * @return The name shown in the dashboard.
+ */
+QString ResidencyManager::stateName(State state) {
+    switch (state) {
+    case State::Resident:
+        return tr("Resident");
+    case State::GpuReleased:
+        return tr("GPU released");
+    case State::CpuReleased:
+        return tr("CPU released");
+    case State::Restoring:
+        return tr("Restoring");
+    }
+    return QString();
+}
+
+/**
+ * @brief Releases the resources of parts that have been hidden for longer than the policy allows.
+ *
+ * Other views holding a part's mesh, such as a VR session, drop their reference asynchronously
+ * after geometryReleased(), so the GeometryCache is trimmed on every sweep while CPU release is
+ * enabled rather than only on the sweep that released the parts.
+ */
+void ResidencyManager::sweep() {
+    bool contextCurrent = false;
+
+    for (auto it = entries.begin(); it != entries.end();) {
+        ModelPart* part = PartRegistry::instance().find(it.key());
+        if (!part) {
+            it = entries.erase(it); // Deleted without being forgotten
+            continue;
+        }
+        Entry& entry = it.value();
+        if (!entry.hidden || !entry.hiddenTimer.isValid()) {
+            ++it;
+            continue;
+        }
+
+        qint64 hiddenFor = entry.hiddenTimer.elapsed();
+        if (entry.state == State::Resident && hiddenFor >= currentPolicy.gpuReleaseDelay) {
+            if (!contextCurrent) {
+                renderWindow->MakeCurrent();
+                contextCurrent = true;
+            }
+            part->releaseGraphicsResources(renderWindow);
+            entry.state = State::GpuReleased;
+        }
+        if (currentPolicy.releaseCpuGeometry && entry.state == State::GpuReleased &&
+            hiddenFor >= currentPolicy.cpuReleaseDelay && part->geometryResident() && !part->sourceFile().isEmpty()) {
+            part->releaseGeometry();
+            entry.state = State::CpuReleased;
+            emit geometryReleased(part);
+        }
+        ++it;
+    }
+
+    if (currentPolicy.releaseCpuGeometry)
+        GeometryCache::instance().trim();
+}
+
+/**
+ * @brief Reloads a part's mesh from the GeometryCache on a worker thread.
+ *
+ * The mesh is attached on the GUI thread once loaded, and only if the part still exists and is
+ * still tracked. The part is captured by ID, since its address may have been reused by a new part
+ * by the time the load completes.
+ *
+ * @param part The part to restore.
+ */
+void ResidencyManager::restore(ModelPart* part) {
+    entries[part->id()].state = State::Restoring;
+    QString fileName = part->sourceFile();
+    quint64 partId = part->id();
+
+    QtConcurrent::run([this, partId, fileName] {
+        vtkSmartPointer<vtkPolyData> geometry = GeometryCache::instance().load(fileName);
+        QMetaObject::invokeMethod(this, [this, partId, geometry] {
+            auto it = entries.find(partId);
+            ModelPart* part = PartRegistry::instance().find(partId);
+            if (!part || it == entries.end() || it.value().state != State::Restoring)
+                return;
+            part->restoreGeometry(geometry);
+            it.value().state = State::Resident;
+            emit partRestored(part);
+            }, Qt::QueuedConnection);
+        });
+}
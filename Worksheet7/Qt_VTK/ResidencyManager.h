@@ -0,0 +1,103 @@
+/**
+ * @file ResidencyManager.h
+ *
+ * Defines the ResidencyManager class, which frees the GPU buffers and, optionally, the CPU meshes of
+ * parts that have stayed hidden for longer than a configurable delay, and brings them back in the
+ * background when the parts are shown again.
+ */
+
+#ifndef VIEWER_RESIDENCYMANAGER_H
+#define VIEWER_RESIDENCYMANAGER_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <vtkSmartPointer.h>
+#include <vtkRenderWindow.h>
+#include "ModelPart.h"
+
+/**
+ * @struct ResidencyPolicy
+ * @brief Settings that decide when a hidden part gives up its resources.
+ */
+struct ResidencyPolicy {
+    int gpuReleaseDelay = 30000; ///< Milliseconds a part must be hidden before its GPU buffers are freed.
+    bool releaseCpuGeometry = false; ///< Whether hidden parts also drop their full-detail mesh.
+    int cpuReleaseDelay = 120000; ///< Milliseconds a part must be hidden before its mesh is dropped.
+};
+
+/**
+ * @class ResidencyManager
+ * @brief Tracks hidden parts and releases or restores their resources according to a policy.
+ *
+ * MainWindow reports every visibility change. A periodic sweep releases resources of parts that
+ * have been hidden long enough. Showing a part whose mesh was dropped starts an asynchronous reload
+ * from the GeometryCache and emits partRestored() once the mesh is back, so the part can be drawn.
+ * Parts are tracked by their PartRegistry ID, so an entry left behind by a deleted part is dropped
+ * by the next sweep instead of being followed to freed memory.
+ */
+class ResidencyManager : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief What a tracked part currently holds.
+     */
+    enum class State {
+        Resident, ///< GPU buffers and mesh are held.
+        GpuReleased, ///< GPU buffers have been freed; the mesh is held.
+        CpuReleased, ///< GPU buffers and the full-detail mesh have been freed.
+        Restoring ///< The mesh is being reloaded in the background.
+    };
+
+    /**
+     * @struct Record
+     * @brief One row of the residency dashboard.
+     */
+    struct Record {
+        quint64 partId; ///< ID of the tracked part.
+        QString name; ///< The part's name.
+        State state; ///< What the part currently holds.
+        bool hidden; ///< Whether the part is hidden.
+        qint64 hiddenFor; ///< Milliseconds the part has been hidden, or 0 if visible.
+        qint64 cpuBytes; ///< Bytes of full-detail mesh held by the part.
+    };
+
+    ResidencyManager(vtkRenderWindow* renderWindow, QObject* parent = nullptr);
+
+    void setPolicy(const ResidencyPolicy& policy);
+    ResidencyPolicy policy() const;
+    void track(ModelPart* part);
+    void forget(ModelPart* part);
+    bool notifyVisibility(ModelPart* part, bool visible);
+    QList<Record> records() const;
+    static QString stateName(State state);
+
+signals:
+    void partRestored(ModelPart* part);
+    void geometryReleased(ModelPart* part);
+
+private:
+    void sweep();
+    void restore(ModelPart* part);
+
+    /**
+     * @struct Entry
+     * @brief Residency bookkeeping for one tracked part.
+     */
+    struct Entry {
+        State state = State::Resident; ///< What the part currently holds.
+        bool hidden = false; ///< Whether the part is hidden.
+        QElapsedTimer hiddenTimer; ///< Started when the part was hidden.
+    };
+
+    vtkSmartPointer<vtkRenderWindow> renderWindow; ///< Window whose context holds the GPU buffers.
+    QHash<quint64, Entry> entries; ///< Tracked parts, by part ID.
+    ResidencyPolicy currentPolicy; ///< Active release policy.
+    QTimer sweepTimer; ///< Drives the periodic release sweep.
+};
+
+#endif // VIEWER_RESIDENCYMANAGER_H
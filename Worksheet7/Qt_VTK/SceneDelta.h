@@ -0,0 +1,58 @@
+/**
+ * @file SceneDelta.h
+ *
+ * Defines the SceneDelta structure, a single change to the rendered scene. The GUI describes every
+ * scene change as a delta and hands it to the scene delta queue rather than touching the renderer
+ * directly, which lets bursts of changes be coalesced into one frame.
+ */
+
+#ifndef VIEWER_SCENEDELTA_H
+#define VIEWER_SCENEDELTA_H
+
+#include <QColor>
+#include <QList>
+#include <QMetaType>
+#include <vtkSmartPointer.h>
+#include <vtkActor.h>
+#include <vtkMatrix4x4.h>
+#include <vtkPolyData.h>
+
+/**
+ * @struct SceneDelta
+ * @brief One change to the rendered scene or its camera.
+ *
+ * Deltas carry the actor they affect by reference count, so a delta stays valid even if the
+ * ModelPart it came from is deleted before the delta is applied. The part is named by its stable
+ * ID, which looks up to nullptr in the PartRegistry once the part is gone.
+ */
+struct SceneDelta {
+    /**
+     * @brief The kind of change a delta describes.
+     */
+    enum class Type {
+        AddPart, ///< Add the actor to the scene.
+        RemovePart, ///< Remove the actor from the scene.
+        UpdatePart, ///< Apply new visibility, colour and opacity to the actor.
+        SetTransform, ///< Apply a new world matrix to the actor. The desktop view reads it from the part instead.
+        ReleaseGeometry, ///< Drop the full-detail mesh of the actor. Only views holding their own copy of the part act on it.
+        ResetCamera, ///< Fit the camera to the scene using the default viewing angle.
+        SetCamera, ///< Move the camera to the given position, focal point and view-up.
+        Render ///< Render a frame even if nothing else changed.
+    };
+
+    Type type = Type::Render; ///< The kind of change.
+    quint64 partId = 0; ///< ID of the part the change came from.
+    vtkSmartPointer<vtkActor> actor; ///< The actor the change applies to.
+    bool visible = true; ///< New visibility for UpdatePart.
+    QColor colour; ///< New colour for UpdatePart.
+    double opacity = 1.0; ///< New opacity for UpdatePart.
+    vtkSmartPointer<vtkMatrix4x4> matrix; ///< Copy of the world matrix for SetTransform, or nullptr for identity.
+    QList<vtkSmartPointer<vtkPolyData>> geometry; ///< Shallow copy of the mesh of each detail level for AddPart, for views on other threads that build their own actors.
+    double position[3] = { 0.0, 0.0, 1.0 }; ///< Camera position for SetCamera.
+    double focalPoint[3] = { 0.0, 0.0, 0.0 }; ///< Camera focal point for SetCamera.
+    double viewUp[3] = { 0.0, 1.0, 0.0 }; ///< Camera view-up vector for SetCamera.
+};
+
+Q_DECLARE_METATYPE(SceneDelta)
+
+#endif // VIEWER_SCENEDELTA_H
@@ -0,0 +1,148 @@
+/**
+ * @file SceneDeltaQueue.cpp
+ * @brief Implementation of the SceneDeltaQueue class.
+ *
+ * Implements the scene-delta queue and the coalescing of queued deltas into a single frame.
+ */
+
+#include "SceneDeltaQueue.h"
+#include <QHash>
+#include <QMutexLocker>
+
+ /**
+  * @brief Constructs an empty scene delta queue.
+  *
+  * @param parent The parent QObject.
+  */
+SceneDeltaQueue::SceneDeltaQueue(QObject* parent)
+    : QObject(parent), flushScheduled(false) {
+    qRegisterMetaType<SceneDelta>();
+    qRegisterMetaType<QList<SceneDelta>>();
+}
+
+/**
+ * @brief Queues one scene change. Safe to call from any thread.
+ *
+ * @param delta The change to queue.
+ */
+void SceneDeltaQueue::enqueue(const SceneDelta& delta) {
+    {
+        QMutexLocker locker(&mutex);
+        queue.append(delta);
+    }
+    schedule();
+}
+
+/**
+ * @brief Queues several scene changes at once. Safe to call from any thread.
+ *
+ * @param deltas The changes to queue, in order.
+ */
+void SceneDeltaQueue::enqueue(const QList<SceneDelta>& deltas) {
+    if (deltas.isEmpty())
+        return;
+
+    {
+        QMutexLocker locker(&mutex);
+        queue.append(deltas);
+    }
+    schedule();
+}
+
+/**
+ * @brief Posts flush() to the queue's thread unless a flush is already waiting.
+ */
+void SceneDeltaQueue::schedule() {
+    {
+        QMutexLocker locker(&mutex);
+        if (flushScheduled)
+            return;
+        flushScheduled = true;
+    }
+    QMetaObject::invokeMethod(this, &SceneDeltaQueue::flush, Qt::QueuedConnection);
+}
+
+/**
+ * @brief Emits everything queued since the last batch as one coalesced batch.
+ */
+void SceneDeltaQueue::flush() {
+    QList<SceneDelta> pending;
+    {
+        QMutexLocker locker(&mutex);
+        pending.swap(queue);
+        flushScheduled = false;
+    }
+    if (!pending.isEmpty())
+        emit frameReady(coalesce(pending));
+}
+
+/**
+ * @brief Merges queued deltas into the smallest equivalent batch.
+ *
+ * Additions, removals and geometry releases keep their order. Repeated updates or transforms of the same actor
+ * collapse into the last one, but only between additions and removals of that actor: an update queued after the
+ * actor is removed and added again stays after the addition, so a view that builds its own copy on AddPart still
+ * receives it. Only the last camera change is kept and is moved to the end so that it sees every part added in
+ * the batch, and a plain Render request is dropped if anything else will render.
+ *
+ * @param pending The deltas in the order they were queued.
+ * @return The coalesced batch.
+ */
+QList<SceneDelta> SceneDeltaQueue::coalesce(const QList<SceneDelta>& pending) {
+    QList<SceneDelta> batch;
+    QHash<vtkActor*, int> updateSlots;
+    QHash<vtkActor*, int> transformSlots;
+    const SceneDelta* camera = nullptr;
+    bool renderRequested = false;
+
+    for (const SceneDelta& delta : pending) {
+        switch (delta.type) {
+        case SceneDelta::Type::AddPart:
+        case SceneDelta::Type::RemovePart:
+            // Later changes must land after this one, so they may not merge into earlier slots
+            updateSlots.remove(delta.actor.Get());
+            transformSlots.remove(delta.actor.Get());
+            batch.append(delta);
+            break;
+        case SceneDelta::Type::ReleaseGeometry:
+            batch.append(delta);
+            break;
+        case SceneDelta::Type::UpdatePart: {
+            auto slot = updateSlots.constFind(delta.actor.Get());
+            if (slot != updateSlots.constEnd()) {
+                batch[slot.value()] = delta;
+            }
+            else {
+                updateSlots.insert(delta.actor.Get(), batch.size());
+                batch.append(delta);
+            }
+            break;
+        }
+        case SceneDelta::Type::SetTransform: {
+            auto slot = transformSlots.constFind(delta.actor.Get());
+            if (slot != transformSlots.constEnd()) {
+                batch[slot.value()] = delta;
+            }
+            else {
+                transformSlots.insert(delta.actor.Get(), batch.size());
+                batch.append(delta);
+            }
+            break;
+        }
+        case SceneDelta::Type::ResetCamera:
+        case SceneDelta::Type::SetCamera:
+            camera = &delta;
+            break;
+        case SceneDelta::Type::Render:
+            renderRequested = true;
+            break;
+        }
+    }
+
+    if (camera)
+        batch.append(*camera);
+    if (batch.isEmpty() && renderRequested)
+        batch.append(SceneDelta());
+    return batch;
+}
+
@@ -0,0 +1,53 @@
+/**
+ * @file SceneDeltaQueue.h
+ *
+ * Defines the SceneDeltaQueue class, which collects the scene changes sent by the GUI and hands
+ * them to the renderer as one coalesced batch per event loop pass.
+ */
+
+#ifndef VIEWER_SCENEDELTAQUEUE_H
+#define VIEWER_SCENEDELTAQUEUE_H
+
+#include <QObject>
+#include <QMutex>
+#include <QList>
+#include "SceneDelta.h"
+
+/**
+ * @class SceneDeltaQueue
+ * @brief Command queue between the GUI and the renderer.
+ *
+ * The GUI enqueues SceneDelta commands instead of touching the renderer. The first delta queued
+ * after a batch schedules the next one on the event loop; when it runs, everything queued in the
+ * meantime is merged (later property updates replace earlier ones, only the last camera change is
+ * kept) and emitted as one batch, which the GUI applies before rendering once.
+ *
+ * A burst of tree edits therefore costs one frame rather than one frame per edit, and because the
+ * batch is posted behind the events already waiting, input received during a slow frame is handled
+ * before the next frame starts. The frame itself is drawn on the GUI thread, which owns the view's
+ * OpenGL context and the meshes shared through the GeometryCache, so a single slow frame still
+ * delays input for its own duration; the queue bounds the delay to one frame, not to a backlog.
+ */
+class SceneDeltaQueue : public QObject {
+    Q_OBJECT
+
+public:
+    explicit SceneDeltaQueue(QObject* parent = nullptr);
+
+    void enqueue(const SceneDelta& delta);
+    void enqueue(const QList<SceneDelta>& deltas);
+    static QList<SceneDelta> coalesce(const QList<SceneDelta>& pending);
+
+signals:
+    void frameReady(const QList<SceneDelta>& deltas);
+
+private:
+    void schedule();
+    void flush();
+
+    QMutex mutex; ///< Guards the queue and the flag below.
+    QList<SceneDelta> queue; ///< Deltas received since the last batch was emitted.
+    bool flushScheduled; ///< True while flush() is queued on the event loop.
+};
+
+#endif // VIEWER_SCENEDELTAQUEUE_H
@@ -0,0 +1,224 @@
+/**
+ * @file SceneSnapshot.cpp
+ * @brief Implementation of the SceneSnapshot class and its node types.
+ */
+
+#include "SceneSnapshot.h"
+#include "GeometryCache.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentMap>
+#include <algorithm>
+#include <iterator>
+#include <vtkAppendPolyData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkSTLWriter.h>
+#include <vtkTransform.h>
+
+namespace {
+    /// Chunks the outermost ~SnapshotNode() on this thread still has to release, or nullptr if none is running.
+    thread_local std::vector<std::shared_ptr<const SnapshotChunk>>* releasing = nullptr;
+}
+
+/**
+ * @brief Releases the frozen part's children without recursing down the tree.
+ *
+ * Nodes freed while an outer node is being released hand their chunks to it rather than freeing
+ * them, so a frozen chain of any depth is freed from one loop. Whichever snapshot or part drops a
+ * shared node last frees it, as before.
+ */
+SnapshotNode::~SnapshotNode() {
+    if (releasing) {
+        releasing->insert(releasing->end(), std::make_move_iterator(chunks.begin()), std::make_move_iterator(chunks.end()));
+        return;
+    }
+
+    std::vector<std::shared_ptr<const SnapshotChunk>> pending = std::move(chunks);
+    releasing = &pending;
+    while (!pending.empty()) {
+        std::shared_ptr<const SnapshotChunk> chunk = std::move(pending.back());
+        pending.pop_back();
+        chunk.reset();
+    }
+    releasing = nullptr;
+}
+
+/**
+ * @brief Returns a built child of the frozen part.
+ *
+ * @param row The child's row.
+ * @return The child, or nullptr if the row is out of range.
+ */
+const SnapshotNode* SnapshotNode::child(int row) const {
+    if (row < 0 || row >= childCount)
+        return nullptr;
+    return chunks[row / SnapshotChunk::Capacity]->nodes[row % SnapshotChunk::Capacity].get();
+}
+
+/**
+ * @brief Composes the frozen part's transform relative to its parent, as ModelPart does.
+ *
+ * @param matrix Receives the transform.
+ */
+void SnapshotNode::localMatrix(vtkMatrix4x4* matrix) const {
+    vtkNew<vtkTransform> transform;
+    transform->Translate(position[0], position[1], position[2]);
+    transform->RotateZ(orientation[2]);
+    transform->RotateY(orientation[1]);
+    transform->RotateX(orientation[0]);
+    matrix->DeepCopy(transform->GetMatrix());
+}
+
+/**
+ * @brief Composes the frozen part's world matrix from its parent's.
+ *
+ * @param parentWorld The parent's world matrix, or nullptr for identity.
+ * @return The world matrix, which is parentWorld itself if the part is not transformed.
+ */
+vtkSmartPointer<vtkMatrix4x4> SnapshotNode::worldMatrix(vtkMatrix4x4* parentWorld) const {
+    bool moved = false;
+    for (int i = 0; i < 3; ++i)
+        moved = moved || position[i] != 0.0 || orientation[i] != 0.0;
+    if (!moved)
+        return parentWorld;
+
+    vtkNew<vtkMatrix4x4> local;
+    localMatrix(local);
+    vtkSmartPointer<vtkMatrix4x4> world = vtkSmartPointer<vtkMatrix4x4>::New();
+    if (parentWorld)
+        vtkMatrix4x4::Multiply4x4(parentWorld, local, world);
+    else
+        world->DeepCopy(local);
+    return world;
+}
+
+/**
+ * @brief Creates a null snapshot.
+ */
+SceneSnapshot::SceneSnapshot() {
+}
+
+/**
+ * @brief Wraps a frozen tree.
+ *
+ * @param root The frozen root part.
+ */
+SceneSnapshot::SceneSnapshot(std::shared_ptr<const SnapshotNode> root) : rootNode(std::move(root)) {
+}
+
+/**
+ * @brief Returns true if the snapshot holds no tree.
+ */
+bool SceneSnapshot::isNull() const {
+    return !rootNode;
+}
+
+/**
+ * @brief Returns the frozen root part, or nullptr for a null snapshot.
+ */
+const SnapshotNode* SceneSnapshot::root() const {
+    return rootNode.get();
+}
+
+/**
+ * @brief Calls a function for every frozen part, on several threads at once.
+ *
+ * The top of the tree is expanded on the calling thread until there are enough subtrees to share
+ * out, and the subtrees are then walked in parallel on the global thread pool. Returns once every
+ * part has been visited. Parts are visited in no particular order, so the function must be safe
+ * to call concurrently.
+ *
+ * @param visit Called with each part and its world matrix, or nullptr for identity.
+ */
+void SceneSnapshot::parallelForEach(const std::function<void(const SnapshotNode& node, vtkMatrix4x4* world)>& visit) const {
+    struct Pending {
+        const SnapshotNode* node; ///< Root of a subtree still to visit.
+        vtkSmartPointer<vtkMatrix4x4> parentWorld; ///< The world matrix of its parent, or nullptr for identity.
+    };
+    if (!rootNode)
+        return;
+
+    const std::size_t wanted = 8 * static_cast<std::size_t>(qMax(1, QThread::idealThreadCount()));
+    std::vector<Pending> frontier{ { rootNode.get(), nullptr } };
+    while (frontier.size() < wanted) {
+        std::vector<Pending> next;
+        bool expanded = false;
+        for (const Pending& pending : frontier) {
+            if (pending.node->childCount == 0) {
+                next.push_back(pending); // Leaves are left for the pool
+                continue;
+            }
+            vtkSmartPointer<vtkMatrix4x4> world = pending.node->worldMatrix(pending.parentWorld);
+            visit(*pending.node, world);
+            for (int row = 0; row < pending.node->childCount; ++row)
+                next.push_back({ pending.node->child(row), world });
+            expanded = true;
+        }
+        frontier.swap(next);
+        if (!expanded)
+            break;
+    }
+
+    QtConcurrent::blockingMap(frontier, [&visit](const Pending& start) {
+        std::vector<Pending> stack{ start };
+        while (!stack.empty()) {
+            Pending pending = stack.back();
+            stack.pop_back();
+            vtkSmartPointer<vtkMatrix4x4> world = pending.node->worldMatrix(pending.parentWorld);
+            visit(*pending.node, world);
+            for (int row = pending.node->childCount - 1; row >= 0; --row)
+                stack.push_back({ pending.node->child(row), world });
+        }
+        });
+}
+
+/**
+ * @brief Writes the visible parts of the snapshot to one binary STL file, in world coordinates.
+ *
+ * The parts are transformed in parallel. Each one works on a private shallow copy of its mesh, so
+ * the meshes shared with the renderer are only ever read. Meshes released since the snapshot was
+ * taken are reloaded through the GeometryCache. Safe to call from any thread.
+ *
+ * @param fileName The file to write.
+ * @return The number of parts written, or -1 if the file could not be written.
+ */
+int SceneSnapshot::writeStl(const QString& fileName) const {
+    QMutex mutex;
+    std::vector<std::pair<quint64, vtkSmartPointer<vtkPolyData>>> meshes;
+    parallelForEach([&](const SnapshotNode& node, vtkMatrix4x4* world) {
+        if (!node.visible || node.sourceFile.isEmpty())
+            return;
+        vtkSmartPointer<vtkPolyData> mesh = node.geometry ? node.geometry : GeometryCache::instance().load(node.sourceFile);
+        if (!mesh)
+            return;
+
+        vtkSmartPointer<vtkPolyData> copy = vtkSmartPointer<vtkPolyData>::New();
+        copy->ShallowCopy(mesh);
+        if (world && mesh->GetPoints()) {
+            vtkNew<vtkTransform> transform;
+            transform->SetMatrix(world);
+            vtkNew<vtkPoints> points;
+            transform->TransformPoints(mesh->GetPoints(), points);
+            copy->SetPoints(points);
+        }
+        QMutexLocker locker(&mutex);
+        meshes.emplace_back(node.id, copy);
+        });
+    if (meshes.empty())
+        return 0;
+
+    // Parts are written in the order they were created, whichever thread finished first
+    std::sort(meshes.begin(), meshes.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    vtkNew<vtkAppendPolyData> append;
+    for (const auto& entry : meshes)
+        append->AddInputData(entry.second);
+
+    vtkNew<vtkSTLWriter> writer;
+    writer->SetFileName(fileName.toStdString().c_str());
+    writer->SetFileTypeToBinary();
+    writer->SetInputConnection(append->GetOutputPort());
+    return writer->Write() ? static_cast<int>(meshes.size()) : -1;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file SceneSnapshot.h
+ *
+ * Defines the SceneSnapshot class, an immutable version of the parts tree that background tasks
+ * can read while the tree keeps changing, and the node types it is made of.
+ */
+
+#ifndef VIEWER_SCENESNAPSHOT_H
+#define VIEWER_SCENESNAPSHOT_H
+
+#include <QColor>
+#include <QString>
+#include <QtGlobal>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+class vtkMatrix4x4;
+struct SnapshotChunk;
+
+/**
+ * @struct SnapshotNode
+ * @brief Frozen copy of one part. Never changed once built.
+ *
+ * Children are held in chunks of SnapshotChunk::Capacity rows, so a new version of a part with
+ * many children shares every chunk except those holding changed children.
+ */
+struct SnapshotNode {
+    quint64 id = 0; ///< The part's stable ID.
+    QString name; ///< The part's name.
+    bool visible = true; ///< The part's visibility.
+    QRgb colour = 0; ///< The part's colour.
+    float opacity = 1.0f; ///< The part's opacity.
+    double position[3] = {}; ///< Translation relative to the parent.
+    double orientation[3] = {}; ///< Rotation about X, Y and Z relative to the parent, in degrees.
+    QString sourceFile; ///< STL file the geometry was loaded from, or empty for groups.
+    vtkSmartPointer<vtkPolyData> geometry; ///< Full-detail mesh, shared with the part, or nullptr if it was released.
+    int deferredChildren = 0; ///< Children the part had not built yet.
+    int childCount = 0; ///< Number of built children.
+    std::vector<std::shared_ptr<const SnapshotChunk>> chunks; ///< Built children, in row order.
+
+    ~SnapshotNode();
+    const SnapshotNode* child(int row) const;
+    void localMatrix(vtkMatrix4x4* matrix) const;
+    vtkSmartPointer<vtkMatrix4x4> worldMatrix(vtkMatrix4x4* parentWorld) const;
+};
+
+/**
+ * @struct SnapshotChunk
+ * @brief A run of consecutive children of a frozen part.
+ */
+struct SnapshotChunk {
+    static constexpr int Capacity = 64; ///< Children per chunk; only a parent's last chunk may hold fewer.
+
+    std::vector<std::shared_ptr<const SnapshotNode>> nodes; ///< The children, in row order.
+};
+
+/**
+ * @class SceneSnapshot
+ * @brief Consistent, read-only version of the parts tree.
+ *
+ * A snapshot is the frozen root of the tree. Parts keep the frozen copy made for the last
+ * snapshot and drop it, with those of their ancestors, when they change, so taking a snapshot
+ * only copies the parts changed since the last one, and returns the same root at no cost if
+ * nothing changed. Everything else is shared between snapshots, and a snapshot held by a
+ * background task costs only the old versions of the parts edited meanwhile.
+ *
+ * Snapshots are taken on the GUI thread with ModelPartList::snapshot(). Copies can then be read
+ * from any thread without locking, and parallelForEach() walks one on every pool thread at once.
+ * This is how background work reads the tree: the live ModelParts belong to the GUI thread, and
+ * a removed or changed part's old frozen copy is only freed once no snapshot refers to it, so
+ * readers never see a node reclaimed under them.
+ */
+class SceneSnapshot {
+public:
+    SceneSnapshot();
+    explicit SceneSnapshot(std::shared_ptr<const SnapshotNode> root);
+
+    bool isNull() const;
+    const SnapshotNode* root() const;
+    void parallelForEach(const std::function<void(const SnapshotNode& node, vtkMatrix4x4* world)>& visit) const;
+    int writeStl(const QString& fileName) const;
+
+private:
+    std::shared_ptr<const SnapshotNode> rootNode; ///< Frozen root of the tree, or nullptr.
+};
+
+#endif // VIEWER_SCENESNAPSHOT_H
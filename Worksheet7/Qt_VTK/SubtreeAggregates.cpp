@@ -0,0 +1,278 @@
+/**
+ * @file SubtreeAggregates.cpp
+ * @brief Implementation of the SubtreeAggregates class.
+ */
+
+#include "SubtreeAggregates.h"
+#include "ModelPart.h"
+#include <utility>
+#include <vector>
+#include <vtkMath.h>
+
+/**
+ * @brief Adds another set of totals to this one.
+ */
+SubtreeAggregates::Totals& SubtreeAggregates::Totals::operator+=(const Totals& other) {
+    parts += other.parts;
+    triangles += other.triangles;
+    shownTriangles += other.shownTriangles;
+    vertices += other.vertices;
+    memory += other.memory;
+    return *this;
+}
+
+/**
+ * @brief Subtracts another set of totals from this one.
+ */
+SubtreeAggregates::Totals& SubtreeAggregates::Totals::operator-=(const Totals& other) {
+    parts -= other.parts;
+    triangles -= other.triangles;
+    shownTriangles -= other.shownTriangles;
+    vertices -= other.vertices;
+    memory -= other.memory;
+    return *this;
+}
+
+/**
+ * @brief Returns true if every total is equal.
+ */
+bool SubtreeAggregates::Totals::operator==(const Totals& other) const {
+    return parts == other.parts && triangles == other.triangles && shownTriangles == other.shownTriangles
+        && vertices == other.vertices && memory == other.memory;
+}
+
+/**
+ * @brief Returns true if any total differs.
+ */
+bool SubtreeAggregates::Totals::operator!=(const Totals& other) const {
+    return !(*this == other);
+}
+
+/**
+ * @brief Adds a part and its built descendants, once they are attached to their parent.
+ *
+ * @param part The root of the subtree that was inserted.
+ */
+void SubtreeAggregates::insertSubtree(ModelPart* part) {
+    if (!part || entries.contains(part))
+        return;
+
+    Totals added = insertEntries(part);
+    addToAncestors(part, added);
+    markBoundsStale(part->parentItem());
+}
+
+/**
+ * @brief Removes a part and its descendants, before they are detached from their parent.
+ *
+ * @param part The root of the subtree being removed.
+ */
+void SubtreeAggregates::removeSubtree(ModelPart* part) {
+    auto it = entries.constFind(part);
+    if (!part || it == entries.constEnd())
+        return;
+
+    Totals removed;
+    removed -= it->subtree;
+    addToAncestors(part, removed);
+    markBoundsStale(part->parentItem());
+    removeEntries(part);
+}
+
+/**
+ * @brief Measures a part again after its geometry, residency, visibility or transform changed.
+ *
+ * @param part The part that changed. Parts not in the tree are ignored.
+ */
+void SubtreeAggregates::update(ModelPart* part) {
+    auto it = entries.find(part);
+    if (it == entries.end())
+        return;
+
+    Totals measured = measure(part, *it);
+    vtkBoundingBox measuredBounds = measureBounds(part, *it);
+    if (measuredBounds != it->ownBounds) {
+        it->ownBounds = measuredBounds;
+        markBoundsStale(part);
+    }
+    if (measured == it->own)
+        return;
+
+    Totals delta = measured;
+    delta -= it->own;
+    it->own = measured;
+    it->subtree += delta;
+    changed.insert(part);
+    addToAncestors(part, delta);
+}
+
+/**
+ * @brief Returns the totals of a part's subtree, including the part itself.
+ *
+ * @param part The part to look up.
+ * @return The totals, all zero for a part not in the tree.
+ */
+SubtreeAggregates::Totals SubtreeAggregates::totals(const ModelPart* part) const {
+    auto it = entries.constFind(part);
+    return it == entries.constEnd() ? Totals() : it->subtree;
+}
+
+/**
+ * @brief Returns the world bounds of a part's subtree, recomputing any stale branches first.
+ *
+ * @param part The part to look up.
+ * @return The bounds, invalid if neither the part nor any descendant has geometry.
+ */
+vtkBoundingBox SubtreeAggregates::bounds(ModelPart* part) {
+    auto it = entries.constFind(part);
+    if (it == entries.constEnd())
+        return vtkBoundingBox();
+
+    // Stale subtrees are recomputed children first from an explicit stack, since the tree may be
+    // far deeper than the call stack allows. The flag marks parts whose children are done.
+    std::vector<std::pair<ModelPart*, bool>> stack{ { part, false } };
+    while (!stack.empty()) {
+        ModelPart* current = stack.back().first;
+        auto entry = entries.find(current);
+        if (entry == entries.end() || !entry->boundsStale) {
+            stack.pop_back();
+            continue;
+        }
+        if (!stack.back().second) {
+            stack.back().second = true;
+            for (int row = 0; row < current->childCount(); ++row)
+                stack.push_back({ current->child(row), false });
+            continue;
+        }
+        stack.pop_back();
+
+        vtkBoundingBox box = entry->ownBounds;
+        for (int row = 0; row < current->childCount(); ++row) {
+            auto child = entries.constFind(current->child(row));
+            if (child != entries.constEnd() && child->subtreeBounds.IsValid())
+                box.AddBox(child->subtreeBounds);
+        }
+        entry->subtreeBounds = box;
+        entry->boundsStale = false;
+    }
+    return entries.constFind(part)->subtreeBounds;
+}
+
+/**
+ * @brief Returns the parts whose subtree totals changed since the last call, and forgets them.
+ */
+QSet<ModelPart*> SubtreeAggregates::takeChanged() {
+    QSet<ModelPart*> taken;
+    taken.swap(changed);
+    return taken;
+}
+
+/**
+ * @brief Creates the entries of a subtree bottom-up.
+ *
+ * The subtree is listed parents first and then measured in reverse, so every part's children
+ * already have entries when its own is made, without recursing down a deep tree.
+ *
+ * @return The totals of the whole subtree.
+ */
+SubtreeAggregates::Totals SubtreeAggregates::insertEntries(ModelPart* part) {
+    std::vector<ModelPart*> order;
+    std::vector<ModelPart*> stack{ part };
+    while (!stack.empty()) {
+        ModelPart* current = stack.back();
+        stack.pop_back();
+        order.push_back(current);
+        for (int row = 0; row < current->childCount(); ++row)
+            stack.push_back(current->child(row));
+    }
+
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        ModelPart* current = *it;
+        Entry entry;
+        entry.own = measure(current, entry);
+        entry.ownBounds = measureBounds(current, entry);
+        entry.subtree = entry.own;
+        for (int row = 0; row < current->childCount(); ++row)
+            entry.subtree += entries.constFind(current->child(row))->subtree;
+        entries.insert(current, entry);
+        changed.insert(current);
+    }
+    return entries.constFind(part)->subtree;
+}
+
+/**
+ * @brief Drops the entries of a subtree.
+ */
+void SubtreeAggregates::removeEntries(ModelPart* part) {
+    std::vector<ModelPart*> stack{ part };
+    while (!stack.empty()) {
+        ModelPart* current = stack.back();
+        stack.pop_back();
+        entries.remove(current);
+        changed.remove(current);
+        for (int row = 0; row < current->childCount(); ++row)
+            stack.push_back(current->child(row));
+    }
+}
+
+/**
+ * @brief Measures a part's own contribution.
+ *
+ * The vertex count is kept from the previous measurement while the part's mesh is released.
+ */
+SubtreeAggregates::Totals SubtreeAggregates::measure(ModelPart* part, const Entry& previous) {
+    Totals own;
+    own.parts = 1;
+    own.triangles = part->primitiveCount(ModelPart::DetailLevel::Full);
+    own.shownTriangles = part->visible() ? own.triangles : 0;
+    vtkPolyData* mesh = part->levelGeometry(ModelPart::DetailLevel::Full);
+    own.vertices = mesh ? mesh->GetNumberOfPoints() : previous.own.vertices;
+    own.memory = part->geometryBytes();
+    return own;
+}
+
+/**
+ * @brief Measures the world bounds of a part's own geometry.
+ *
+ * The actor's bounds include the part's world transform. They are kept from the previous
+ * measurement while the part has no geometry to measure, as when its mesh is released.
+ */
+vtkBoundingBox SubtreeAggregates::measureBounds(ModelPart* part, const Entry& previous) {
+    vtkSmartPointer<vtkActor> actor = part->getActor();
+    if (!actor || !part->geometryResident())
+        return previous.ownBounds;
+
+    double* box = actor->GetBounds();
+    if (!box || !vtkMath::AreBoundsInitialized(box))
+        return previous.ownBounds;
+    return vtkBoundingBox(box);
+}
+
+/**
+ * @brief Adds a difference to the subtree totals of every ancestor of a part.
+ */
+void SubtreeAggregates::addToAncestors(ModelPart* part, const Totals& delta) {
+    for (ModelPart* ancestor = part->parentItem(); ancestor; ancestor = ancestor->parentItem()) {
+        auto it = entries.find(ancestor);
+        if (it == entries.end())
+            continue;
+        it->subtree += delta;
+        changed.insert(ancestor);
+    }
+}
+
+/**
+ * @brief Flags the subtree bounds of a part and its ancestors as stale.
+ *
+ * A flagged part always has flagged ancestors, so the walk stops at the first one already flagged.
+ */
+void SubtreeAggregates::markBoundsStale(ModelPart* part) {
+    for (; part; part = part->parentItem()) {
+        auto it = entries.find(part);
+        if (it == entries.end())
+            continue;
+        if (it->boundsStale)
+            return;
+        it->boundsStale = true;
+    }
+}
@@ -0,0 +1,82 @@
+/**
+ * @file SubtreeAggregates.h
+ *
+ * Defines the SubtreeAggregates class, which keeps the triangle, vertex, memory and part totals and
+ * the bounds of every subtree of the parts tree up to date as the tree changes.
+ */
+
+#ifndef VIEWER_SUBTREEAGGREGATES_H
+#define VIEWER_SUBTREEAGGREGATES_H
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QtGlobal>
+#include <vtkBoundingBox.h>
+
+class ModelPart;
+
+/**
+ * @class SubtreeAggregates
+ * @brief Incrementally maintained totals for every subtree of the parts tree.
+ *
+ * Each part's totals are its own contribution plus those of its descendants. When a part changes,
+ * only the difference is added to the part and each of its ancestors, so an insert, remove or
+ * update costs O(depth) however large the subtrees are.
+ *
+ * Bounds cannot be shrunk by a difference, so a change only flags the ancestors' bounds as stale,
+ * stopping at the first one already flagged. bounds() recomputes stale subtrees from their
+ * children when asked, and returns cached bounds otherwise.
+ *
+ * Parts whose totals changed are collected until takeChanged() is called, so views can be told
+ * about every changed row once per event loop pass.
+ */
+class SubtreeAggregates {
+public:
+    /**
+     * @brief Summed statistics of a part or subtree.
+     */
+    struct Totals {
+        qint64 parts = 0; ///< Number of parts.
+        qint64 triangles = 0; ///< Full-detail primitives.
+        qint64 shownTriangles = 0; ///< Full-detail primitives of visible parts.
+        qint64 vertices = 0; ///< Full-detail points.
+        qint64 memory = 0; ///< Bytes of geometry held in memory.
+
+        Totals& operator+=(const Totals& other);
+        Totals& operator-=(const Totals& other);
+        bool operator==(const Totals& other) const;
+        bool operator!=(const Totals& other) const;
+    };
+
+    void insertSubtree(ModelPart* part);
+    void removeSubtree(ModelPart* part);
+    void update(ModelPart* part);
+    Totals totals(const ModelPart* part) const;
+    vtkBoundingBox bounds(ModelPart* part);
+    QSet<ModelPart*> takeChanged();
+
+private:
+    /**
+     * @brief Cached values of one part.
+     */
+    struct Entry {
+        Totals own; ///< The part's own contribution, as last measured.
+        Totals subtree; ///< own plus the subtree totals of every child.
+        vtkBoundingBox ownBounds; ///< World bounds of the part's own geometry, kept while its mesh is released.
+        vtkBoundingBox subtreeBounds; ///< Union of ownBounds over the subtree, valid unless boundsStale.
+        bool boundsStale = true; ///< True if subtreeBounds must be recomputed.
+    };
+
+    Totals insertEntries(ModelPart* part);
+    void removeEntries(ModelPart* part);
+    static Totals measure(ModelPart* part, const Entry& previous);
+    static vtkBoundingBox measureBounds(ModelPart* part, const Entry& previous);
+    void addToAncestors(ModelPart* part, const Totals& delta);
+    void markBoundsStale(ModelPart* part);
+
+    QHash<const ModelPart*, Entry> entries; ///< Cached values of every part in the tree.
+    QSet<ModelPart*> changed; ///< Parts whose subtree totals changed since the last takeChanged().
+};
+
+#endif // VIEWER_SUBTREEAGGREGATES_H
@@ -0,0 +1,460 @@
+/**
+ * @file VRRenderThread.cpp
+ * @brief Implementation of the VRRenderThread class.
+ *
+ * Implements the VR render loop: window creation for the headset or the offscreen stand-in,
+ * application of scene deltas to the VR copies of the parts, and the per-frame detail balancing.
+ */
+
+#include "VRRenderThread.h"
+#include "SceneDeltaQueue.h"
+#include "AmbientOcclusionBaker.h"
+#include <QMutexLocker>
+#include <vtkCamera.h>
+#include <vtkCommand.h>
+#include <vtkMath.h>
+#include <vtkProperty.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#ifdef VIEWER_HAVE_OPENVR
+#include <vtkOpenVRCamera.h>
+#include <vtkOpenVRRenderWindow.h>
+#include <vtkOpenVRRenderWindowInteractor.h>
+#include <vtkOpenVRRenderer.h>
+#endif
+
+namespace {
+    const int eyeWidth = 1440; ///< Per-eye width of the offscreen stand-in, matching common headsets.
+    const int eyeHeight = 1600; ///< Per-eye height of the offscreen stand-in.
+    const double minimumAngularSize = 0.0012; ///< Angular radius in radians below which a part is not drawn, about one headset pixel.
+}
+
+/**
+ * @brief Constructs the session. The thread is not started.
+ *
+ * @param target Where the session renders to.
+ * @param parent The parent QObject.
+ */
+VRRenderThread::VRRenderThread(Target target, QObject* parent)
+    : QThread(parent), sessionTarget(target), budget(1000.0 / 90.0), stopping(false), lastFrameTime(0.0), culledParts(0) {
+    qRegisterMetaType<SceneDelta>();
+    qRegisterMetaType<QList<SceneDelta>>();
+}
+
+/**
+ * @brief Stops the render loop and waits for the thread to release its window.
+ */
+VRRenderThread::~VRRenderThread() {
+    stop();
+    wait();
+}
+
+/**
+ * @brief Tells whether this build can drive a real headset.
+ *
+ * @return True if the viewer was built with VTK's OpenVR module.
+ */
+bool VRRenderThread::headsetSupported() {
+#ifdef VIEWER_HAVE_OPENVR
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Returns where the session renders to.
+ *
+ * @return The session target.
+ */
+VRRenderThread::Target VRRenderThread::target() const {
+    return sessionTarget;
+}
+
+/**
+ * @brief Sets the time each frame may take. Takes effect at the next frame.
+ *
+ * @param milliseconds The frame budget; 11.1 ms for 90 Hz.
+ */
+void VRRenderThread::setFrameBudget(double milliseconds) {
+    QMutexLocker locker(&mutex);
+    budget = milliseconds;
+}
+
+/**
+ * @brief Returns the time each frame may take.
+ *
+ * @return The frame budget in milliseconds.
+ */
+double VRRenderThread::frameBudget() const {
+    QMutexLocker locker(&mutex);
+    return budget;
+}
+
+/**
+ * @brief Queues scene changes for the next frame. Safe to call from any thread.
+ *
+ * @param deltas The changes to queue, in order.
+ */
+void VRRenderThread::enqueue(const QList<SceneDelta>& deltas) {
+    if (deltas.isEmpty())
+        return;
+
+    QMutexLocker locker(&mutex);
+    queue.append(deltas);
+}
+
+/**
+ * @brief Asks the render loop to exit after the current frame.
+ */
+void VRRenderThread::stop() {
+    QMutexLocker locker(&mutex);
+    stopping = true;
+}
+
+/**
+ * @brief Render loop: applies queued deltas, renders both eyes and rebalances detail.
+ *
+ * Statistics are reported to the GUI once a second rather than every frame.
+ */
+void VRRenderThread::run() {
+    if (!createWindow()) {
+        destroyWindow();
+        emit sessionFailed(tr("The VR headset could not be initialised."));
+        return;
+    }
+
+    QElapsedTimer reportTimer;
+    reportTimer.start();
+    double totalTime = 0.0;
+    double worstTime = 0.0;
+    int frames = 0;
+
+    forever {
+        QList<SceneDelta> pending;
+        double currentBudget;
+        {
+            QMutexLocker locker(&mutex);
+            if (stopping)
+                break;
+            pending.swap(queue);
+            currentBudget = budget;
+        }
+        if (!pending.isEmpty())
+            applyDeltas(SceneDeltaQueue::coalesce(pending));
+
+        window->Render();
+        rebalance(lastFrameTime / currentBudget);
+
+#ifdef VIEWER_HAVE_OPENVR
+        if (interactor) {
+            vtkOpenVRRenderWindowInteractor::SafeDownCast(interactor)->DoOneEvent(
+                vtkOpenVRRenderWindow::SafeDownCast(window), vtkOpenVRRenderer::SafeDownCast(renderer));
+        }
+#endif
+
+        totalTime += lastFrameTime;
+        worstTime = std::max(worstTime, lastFrameTime);
+        ++frames;
+        if (reportTimer.elapsed() >= 1000) {
+            emit statisticsUpdated(totalTime / frames, worstTime, culledParts);
+            totalTime = worstTime = 0.0;
+            frames = 0;
+            reportTimer.restart();
+        }
+    }
+
+    destroyWindow();
+}
+
+/**
+ * @brief Creates the headset or offscreen window, its renderer and its frame timing observers.
+ *
+ * @return True if the window is ready to render.
+ */
+bool VRRenderThread::createWindow() {
+#ifdef VIEWER_HAVE_OPENVR
+    if (sessionTarget == Target::Headset) {
+        vtkSmartPointer<vtkOpenVRRenderWindow> headset = vtkSmartPointer<vtkOpenVRRenderWindow>::New();
+        renderer = vtkSmartPointer<vtkOpenVRRenderer>::New();
+        renderer->SetActiveCamera(vtkSmartPointer<vtkOpenVRCamera>::New());
+        headset->Initialize();
+        if (!headset->GetHMD())
+            return false;
+        headset->AddRenderer(renderer);
+        headset->SetWindowName("Viewer VR Session");
+        window = headset;
+
+        interactor = vtkSmartPointer<vtkOpenVRRenderWindowInteractor>::New();
+        interactor->SetRenderWindow(window);
+        interactor->Initialize();
+    }
+#endif
+    if (!window) {
+        if (sessionTarget == Target::Headset)
+            return false;
+
+        // Side-by-side stereo at headset resolution with a headset-like field of view
+        renderer = vtkSmartPointer<vtkRenderer>::New();
+        renderer->GetActiveCamera()->SetViewAngle(100.0);
+        window = vtkSmartPointer<vtkRenderWindow>::New();
+        window->SetOffScreenRendering(1);
+        window->SetSize(2 * eyeWidth, eyeHeight);
+        window->StereoCapableWindowOn();
+        window->SetStereoTypeToSplitViewportHorizontal();
+        window->StereoRenderOn();
+        window->AddRenderer(renderer);
+    }
+
+    renderer->SetBackground(26 / 255.0, 51 / 255.0, 102 / 255.0);
+    window->AddObserver(vtkCommand::StartEvent, this, &VRRenderThread::onRenderStart);
+    window->AddObserver(vtkCommand::EndEvent, this, &VRRenderThread::onRenderEnd);
+    return true;
+}
+
+/**
+ * @brief Releases the VR actors and the window while the thread that created them is still running.
+ */
+void VRRenderThread::destroyWindow() {
+    parts.clear();
+    if (renderer)
+        renderer->RemoveAllViewProps();
+    if (window) {
+        window->RemoveAllObservers();
+        window->Finalize();
+    }
+    interactor = nullptr;
+    renderer = nullptr;
+    window = nullptr;
+}
+
+/**
+ * @brief Applies a coalesced batch of scene changes to the VR copies of the parts.
+ *
+ * Parts are matched by the desktop actor the delta carries and are never dereferenced.
+ * Camera changes only move the offscreen camera, since a headset is positioned by the user's head.
+ *
+ * @param deltas The changes to apply, in order.
+ */
+void VRRenderThread::applyDeltas(const QList<SceneDelta>& deltas) {
+    for (const SceneDelta& delta : deltas) {
+        auto it = parts.find(delta.actor.Get());
+        switch (delta.type) {
+        case SceneDelta::Type::AddPart:
+            addPart(delta);
+            break;
+        case SceneDelta::Type::RemovePart:
+            if (it != parts.end()) {
+                renderer->RemoveActor(it->actor);
+                parts.erase(it);
+            }
+            break;
+        case SceneDelta::Type::UpdatePart:
+            if (it != parts.end()) {
+                it->visible = delta.visible;
+                it->actor->SetVisibility(delta.visible);
+                it->actor->GetProperty()->SetDiffuseColor(delta.colour.redF(), delta.colour.greenF(), delta.colour.blueF());
+                it->actor->GetProperty()->SetOpacity(delta.opacity);
+            }
+            break;
+        case SceneDelta::Type::SetTransform:
+            if (it != parts.end())
+                it->actor->SetUserMatrix(delta.matrix);
+            break;
+        case SceneDelta::Type::ReleaseGeometry:
+            if (it != parts.end())
+                releaseGeometry(*it);
+            break;
+        case SceneDelta::Type::ResetCamera:
+            renderer->ResetCamera();
+            break;
+        case SceneDelta::Type::SetCamera:
+            if (!interactor) {
+                renderer->GetActiveCamera()->SetPosition(delta.position);
+                renderer->GetActiveCamera()->SetFocalPoint(delta.focalPoint);
+                renderer->GetActiveCamera()->SetViewUp(delta.viewUp);
+                renderer->ResetCameraClippingRange();
+            }
+            break;
+        case SceneDelta::Type::Render:
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Creates the VR copy of a part from the meshes carried by an AddPart delta.
+ *
+ * Adding a part that already exists replaces its meshes, which is how a part whose mesh was
+ * restored after being released is brought back.
+ *
+ * @param delta The AddPart delta.
+ */
+void VRRenderThread::addPart(const SceneDelta& delta) {
+    if (!delta.actor || delta.geometry.isEmpty() || !delta.geometry.first())
+        return;
+
+    Part& part = parts[delta.actor.Get()];
+    part.source = delta.actor;
+    if (!part.actor) {
+        part.actor = vtkSmartPointer<vtkActor>::New();
+        renderer->AddActor(part.actor);
+    }
+
+    for (int level = 0; level < ModelPart::DetailLevelCount; ++level) {
+        vtkPolyData* mesh = level < delta.geometry.size() ? delta.geometry[level].Get() : nullptr;
+        if (!mesh) {
+            part.mappers[level] = nullptr;
+            part.primitives[level] = 0;
+            continue;
+        }
+        part.mappers[level] = vtkSmartPointer<vtkPolyDataMapper>::New();
+        part.mappers[level]->SetInputData(mesh);
+        part.mappers[level]->ScalarVisibilityOff();
+        part.primitives[level] = level == 0 ? mesh->GetNumberOfPolys() + mesh->GetNumberOfStrips() : mesh->GetNumberOfCells();
+    }
+    part.level = 0;
+    part.actor->SetMapper(part.mappers[0]);
+    if (AmbientOcclusionBaker::hasOcclusion(delta.geometry.first()))
+        AmbientOcclusionBaker::enableShading(part.actor, part.mappers[0]);
+}
+
+/**
+ * @brief Drops the VR copy's full-detail mesh and its GPU buffers, after the desktop part dropped
+ * its own, so that the GeometryCache can free the mesh.
+ *
+ * The part is drawn at the next level that is still held until an AddPart brings the mesh back.
+ *
+ * @param part The VR copy of the part.
+ */
+void VRRenderThread::releaseGeometry(Part& part) {
+    if (!part.mappers[0])
+        return;
+
+    part.mappers[0]->ReleaseGraphicsResources(window);
+    part.mappers[0] = nullptr;
+    part.primitives[0] = 0;
+    part.level = firstLevel(part);
+    part.actor->SetMapper(part.mappers[part.level]);
+}
+
+/**
+ * @brief Returns the most detailed level whose mesh the VR copy holds.
+ *
+ * @param part The VR copy of the part.
+ * @return The level, or the last level if the part holds no mesh at all.
+ */
+int VRRenderThread::firstLevel(const Part& part) {
+    int level = 0;
+    while (level < ModelPart::DetailLevelCount - 1 && !part.mappers[level])
+        ++level;
+    return level;
+}
+
+/**
+ * @brief Chooses per-part detail levels for the next frame.
+ *
+ * The cost of the last frame is spread over the primitives it submitted to estimate the cost of
+ * drawing everything at full detail; parts are then downgraded level by level, smallest first,
+ * until the estimate fits the budget. Parts below about a pixel in size are hidden.
+ *
+ * @param load The last frame's rendering time as a fraction of the budget.
+ */
+void VRRenderThread::rebalance(double load) {
+    struct Candidate {
+        Part* part;
+        double size;
+        int level;
+    };
+
+    vtkCamera* camera = renderer->GetActiveCamera();
+    std::vector<Candidate> candidates;
+    candidates.reserve(parts.size());
+    double submitted = 0.0;
+    double fullCost = 0.0;
+    culledParts = 0;
+
+    for (Part& part : parts) {
+        if (!part.visible)
+            continue;
+        bool wasDrawn = part.actor->GetVisibility();
+        double size = angularSize(part.actor, camera);
+        part.actor->SetVisibility(size >= minimumAngularSize);
+        if (!part.actor->GetVisibility()) {
+            ++culledParts;
+            continue;
+        }
+        if (wasDrawn)
+            submitted += part.primitives[part.level];
+        int first = firstLevel(part);
+        fullCost += part.primitives[first];
+        candidates.push_back({ &part, size, first });
+    }
+    if (candidates.empty())
+        return;
+
+    // Budget in primitives, with 10% headroom for the compositor
+    double budgetPrimitives = submitted > 0.0 && load > 0.0 ? 0.9 * submitted / load : fullCost;
+
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.size < b.size;
+    });
+
+    double estimate = fullCost;
+    for (int level = 1; level < ModelPart::DetailLevelCount && estimate > budgetPrimitives; ++level) {
+        for (Candidate& candidate : candidates) {
+            if (estimate <= budgetPrimitives)
+                break;
+            if (level <= candidate.level || !candidate.part->mappers[level])
+                continue;
+            estimate -= candidate.part->primitives[candidate.level] - candidate.part->primitives[level];
+            candidate.level = level;
+        }
+    }
+
+    for (const Candidate& candidate : candidates) {
+        Part* part = candidate.part;
+        if (part->level != candidate.level) {
+            part->actor->SetMapper(part->mappers[candidate.level]);
+            part->level = candidate.level;
+        }
+    }
+}
+
+/**
+ * @brief Estimates the angular radius of an actor as seen from the camera.
+ *
+ * @param actor The actor to measure.
+ * @param camera The camera it is seen from.
+ * @return The angular radius of the actor's bounding sphere in radians.
+ */
+double VRRenderThread::angularSize(vtkActor* actor, vtkCamera* camera) const {
+    double bounds[6];
+    actor->GetBounds(bounds);
+    double center[3] = { (bounds[0] + bounds[1]) / 2.0, (bounds[2] + bounds[3]) / 2.0, (bounds[4] + bounds[5]) / 2.0 };
+    double radius = 0.5 * std::sqrt((bounds[1] - bounds[0]) * (bounds[1] - bounds[0]) +
+        (bounds[3] - bounds[2]) * (bounds[3] - bounds[2]) +
+        (bounds[5] - bounds[4]) * (bounds[5] - bounds[4]));
+
+    double distance = std::sqrt(vtkMath::Distance2BetweenPoints(center, camera->GetPosition()));
+    return distance <= radius ? vtkMath::Pi() / 2.0 : std::asin(radius / distance);
+}
+
+/**
+ * @brief Starts timing a frame when the window begins rendering.
+ *
+ * On a headset this excludes the wait for the compositor, so the time measured is the cost of
+ * drawing the scene rather than the display's refresh interval.
+ */
+void VRRenderThread::onRenderStart(vtkObject*, unsigned long, void*) {
+    frameTimer.start();
+}
+
+/**
+ * @brief Records the rendering time of the frame that just ended.
+ */
+void VRRenderThread::onRenderEnd(vtkObject*, unsigned long, void*) {
+    lastFrameTime = frameTimer.nsecsElapsed() / 1.0e6;
+}
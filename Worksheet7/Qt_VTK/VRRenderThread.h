@@ -0,0 +1,113 @@
+/**
+ * @file VRRenderThread.h
+ *
+ * Defines the VRRenderThread class, which shows the viewer's scene in a VR headset, or in an
+ * offscreen stereo window standing in for one, from its own thread. The thread consumes the same
+ * scene deltas as the desktop view, so the two always show the same parts, colours and transforms.
+ */
+
+#ifndef VIEWER_VRRENDERTHREAD_H
+#define VIEWER_VRRENDERTHREAD_H
+
+#include <QThread>
+#include <QMutex>
+#include <QHash>
+#include <QList>
+#include <QElapsedTimer>
+#include <vtkSmartPointer.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkRenderer.h>
+#include <vtkPolyDataMapper.h>
+#include "SceneDelta.h"
+#include "ModelPart.h"
+
+class vtkObject;
+class vtkCamera;
+
+/**
+ * @class VRRenderThread
+ * @brief Render loop of a VR session that mirrors the desktop scene.
+ *
+ * The window, renderer and actors are created on the thread and never touched from the GUI. Each
+ * part gets its own actor and mappers over shallow copies of the part's meshes, made on the GUI
+ * thread: the point and cell arrays are shared, so no geometry is duplicated, but the data objects
+ * whose pipeline information the mappers write are the thread's own, and the GPU buffers live in
+ * the VR context. Between frames the thread applies whatever deltas the GUI has sent, then renders
+ * both eyes.
+ *
+ * To hold the frame budget (90 Hz by default) the thread times the rendering part of every frame
+ * and, like the InteractionGovernor, lowers the detail level of the parts with the smallest
+ * angular size until the estimated cost fits. Parts smaller than about a pixel of the display
+ * are not drawn at all; frustum culling is left to the renderer's culler, per eye.
+ */
+class VRRenderThread : public QThread {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Where the session renders to.
+     */
+    enum class Target {
+        Headset, ///< An OpenVR headset. Only available when built with VTK's OpenVR module.
+        OffscreenStereo ///< An offscreen side-by-side stereo window at headset resolution, unpaced.
+    };
+
+    explicit VRRenderThread(Target target, QObject* parent = nullptr);
+    ~VRRenderThread();
+
+    static bool headsetSupported();
+    Target target() const;
+    void setFrameBudget(double milliseconds);
+    double frameBudget() const;
+    void enqueue(const QList<SceneDelta>& deltas);
+    void stop();
+
+signals:
+    void statisticsUpdated(double averageFrameTime, double worstFrameTime, int culledParts);
+    void sessionFailed(const QString& reason);
+
+protected:
+    void run() override;
+
+private:
+    /**
+     * @brief The VR copy of one part.
+     */
+    struct Part {
+        vtkSmartPointer<vtkActor> source; ///< Desktop actor the part is keyed by, held so the key stays unique.
+        vtkSmartPointer<vtkActor> actor; ///< Actor drawn in the VR scene.
+        vtkSmartPointer<vtkPolyDataMapper> mappers[ModelPart::DetailLevelCount]; ///< Mapper per detail level, over the thread's copies of the part's meshes.
+        vtkIdType primitives[ModelPart::DetailLevelCount] = {}; ///< Primitives submitted by each detail level.
+        int level = 0; ///< Detail level currently drawn.
+        bool visible = true; ///< Visibility requested by the desktop.
+    };
+
+    bool createWindow();
+    void destroyWindow();
+    void applyDeltas(const QList<SceneDelta>& deltas);
+    void addPart(const SceneDelta& delta);
+    void releaseGeometry(Part& part);
+    static int firstLevel(const Part& part);
+    void rebalance(double load);
+    double angularSize(vtkActor* actor, vtkCamera* camera) const;
+    void onRenderStart(vtkObject* caller, unsigned long eventId, void* callData);
+    void onRenderEnd(vtkObject* caller, unsigned long eventId, void* callData);
+
+    Target sessionTarget; ///< Where the session renders to.
+    mutable QMutex mutex; ///< Guards the queue, the budget and the stop flag.
+    QList<SceneDelta> queue; ///< Deltas received since the last frame.
+    double budget; ///< Frame budget in milliseconds.
+    bool stopping; ///< Set to end the render loop.
+
+    // Owned by the thread while it runs
+    vtkSmartPointer<vtkRenderWindow> window; ///< Headset or offscreen stereo window.
+    vtkSmartPointer<vtkRenderer> renderer; ///< Renderer holding the VR actors.
+    vtkSmartPointer<vtkRenderWindowInteractor> interactor; ///< Headset event pump, nullptr offscreen.
+    QHash<vtkActor*, Part> parts; ///< VR parts keyed by the desktop actor they mirror.
+    QElapsedTimer frameTimer; ///< Measures the rendering part of the current frame.
+    double lastFrameTime; ///< Rendering time of the last frame in milliseconds.
+    int culledParts; ///< Parts skipped in the last frame for being too small to see.
+};
+
+#endif // VIEWER_VRRENDERTHREAD_H
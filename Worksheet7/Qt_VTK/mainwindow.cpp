@@ -12,6 +12,8 @@
 #include "ui_mainwindow.h"
 #include "OptionDialog.h"
 #include "NewGroupDialog.h"
+#include "residencydialog.h"
+#include "PartRegistry.h"
 #include <vtkGenericOpenGLRenderWindow.h>
 #include <vtkRenderer.h>
 #include <vtkCylinderSource.h>
@@ -19,14 +21,18 @@
 #include <vtkActor.h>
 #include <vtkProperty.h>
 #include <vtkCamera.h>
+#include <vtkBoundingBox.h>
 #include <vtkNamedColors.h>
 #include <QDebug>
 #include <QMessageBox>
 #include <vtkPlaneSource.h>
 #include <QInputDialog>
-#include <vtkTransform.h>
-#include <vtkTransformPolyDataFilter.h>
 #include <QtConcurrent/QtConcurrentRun>
+#include <QActionGroup>
+#include <QTimer>
+#include <QSet>
+#include <algorithm>
+#include <vector>
 
 
  /**
@@ -40,7 +46,20 @@
 MainWindow::MainWindow(QWidget* parent) :
     QMainWindow(parent),
     ui(new Ui::MainWindow),
-    partList(nullptr) {
+    partList(nullptr),
+    journal(nullptr),
+    partFilter(nullptr),
+    filterDialog(nullptr),
+    viewCount(1),
+    depthPeeling(false),
+    governor(nullptr),
+    statistics(nullptr),
+    sceneQueue(nullptr),
+    residency(nullptr),
+    picker(nullptr),
+    vrThread(nullptr),
+    occlusionBaker(nullptr),
+    searchCurrent(-1) {
     ui->setupUi(this);
     initializePartList();
     setupTreeView();
@@ -52,9 +71,13 @@ MainWindow::MainWindow(QWidget* parent) :
 /**
  * @brief Destructor for the MainWindow class.
  *
- * Cleans up the user interface and the dynamically allocated partList.
+ * Cleans up the user interface and the dynamically allocated partList. The journal is deleted
+ * first, while the streamers and the interface its signals reach are still alive.
  */
 MainWindow::~MainWindow() {
+    journal->clear();
+    delete journal;
+    stopVRSession();
     delete ui;
     delete partList;
 }
@@ -62,10 +85,12 @@ MainWindow::~MainWindow() {
 /**
  * @brief Initializes the part list model.
  *
- * This function creates a new ModelPartList and assigns it to partList.
+ * This function creates a new ModelPartList and assigns it to partList, and the journal
+ * that records edits to it.
  */
 void MainWindow::initializePartList() {
     partList = new ModelPartList("Parts List");
+    journal = new EditJournal(this);
 }
 
 /**
@@ -75,8 +100,11 @@ void MainWindow::initializePartList() {
  * It also populates the tree with initial data.
  */
 void MainWindow::setupTreeView() {
-    ui->treeView->setModel(partList);
+    partFilter = new PartFilterProxy(partList, this);
+    ui->treeView->setModel(partFilter);
     ui->treeView->setContextMenuPolicy(Qt::ActionsContextMenu);
+    ui->treeView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    on_actionStatisticsColumns_toggled(false);
     addModelPartToTree();
 }
 
@@ -86,9 +114,8 @@ void MainWindow::setupTreeView() {
  * Creates a root item and a child item, appending the child to the root in the tree.
  */
 void MainWindow::addModelPartToTree() {
-    ModelPart* rootItem = partList->getRootItem();
-    ModelPart* childItem = new ModelPart({ "Model", "true", "255,255,255" });
-    rootItem->appendChild(childItem);
+    ModelPart* childItem = new ModelPart("Model");
+    partList->appendParts({ childItem });
 }
 
 /**
@@ -120,17 +147,108 @@ void MainWindow::createAction(QAction** action, const QString& text, void (MainW
  * @brief Sets up the renderer for the VTK visualization.
  *
  * Initializes the VTK render window and renderer, and associates them with the UI.
+ * The top, front and side views used by the split layouts are created here too; they
+ * hold the same actors as the main view at all times, so switching layout is instant.
+ * Creates the scene delta queue that all later scene changes are queued through.
  */
 void MainWindow::setupRenderer() {
     renderWindow = vtkSmartPointer<vtkGenericOpenGLRenderWindow>::New();
     ui->vtkWidget->setRenderWindow(renderWindow);
     renderer = vtkSmartPointer<vtkRenderer>::New();
     renderWindow->AddRenderer(renderer);
+    renderWindow->SetAlphaBitPlanes(1);
+    viewRenderers.append(renderer);
+    setupTransparency(renderer);
+
+    const double top[3] = { 0.0, 0.0, -1.0 }, topUp[3] = { 0.0, 1.0, 0.0 };
+    const double front[3] = { 0.0, 1.0, 0.0 }, frontUp[3] = { 0.0, 0.0, 1.0 };
+    const double side[3] = { -1.0, 0.0, 0.0 }, sideUp[3] = { 0.0, 0.0, 1.0 };
+    addSecondaryView(top, topUp);
+    addSecondaryView(front, frontUp);
+    addSecondaryView(side, sideUp);
+    governor = new InteractionGovernor(renderWindow, renderer, this);
+    statistics = new RenderStatistics(renderWindow, renderer, this);
+
+    sceneQueue = new SceneDeltaQueue(this);
+    connect(sceneQueue, &SceneDeltaQueue::frameReady, this, &MainWindow::applySceneDeltas);
+
+    occlusionBaker = new AmbientOcclusionBaker(this);
+    connect(occlusionBaker, &AmbientOcclusionBaker::baked, this, &MainWindow::applyAmbientOcclusion);
+
+    residency = new ResidencyManager(renderWindow, this);
+    connect(residency, &ResidencyManager::partRestored, this, [this](ModelPart* part) {
+        SceneDelta delta;
+        delta.type = SceneDelta::Type::UpdatePart;
+        delta.partId = part->id();
+        delta.actor = part->getActor();
+        delta.visible = part->visible();
+        delta.colour = part->getColor();
+        delta.opacity = part->opacity();
+        sceneQueue->enqueue(delta);
+        if (vrThread) {
+            vrThread->enqueue(describePart(part)); // The VR copy may never have had this mesh
+        }
+        occlusionBaker->bake(part); // Only bakes if the mesh was reloaded from disk
+        partList->refreshAttributes(part);
+        });
+    connect(residency, &ResidencyManager::geometryReleased, partList, &ModelPartList::refreshAttributes);
+    connect(residency, &ResidencyManager::geometryReleased, this, [this](ModelPart* part) {
+        if (vrThread) {
+            SceneDelta release; // The VR copy holds its own reference to the mesh
+            release.type = SceneDelta::Type::ReleaseGeometry;
+            release.partId = part->id();
+            release.actor = part->getActor();
+            vrThread->enqueue({ release });
+        }
+        });
+
+    picker = new PartPicker(renderWindow, renderer, this);
+    connect(picker, &PartPicker::partPicked, this, &MainWindow::handlePartPicked);
+    connect(picker, &PartPicker::partHovered, this, [this] {
+        sceneQueue->enqueue(SceneDelta()); // Shows the moved highlight
+        });
 
     addFloor(); // Add the floor to the scene
 }
 
 
+/**
+ * @brief Creates an orthographic view renderer for the split layouts.
+ *
+ * The renderer is not added to the window until a split layout is chosen.
+ *
+ * @param direction The direction the camera looks in.
+ * @param viewUp The camera's up vector.
+ */
+void MainWindow::addSecondaryView(const double direction[3], const double viewUp[3]) {
+    vtkSmartPointer<vtkRenderer> view = vtkSmartPointer<vtkRenderer>::New();
+    vtkCamera* camera = view->GetActiveCamera();
+    camera->ParallelProjectionOn();
+    camera->SetFocalPoint(0.0, 0.0, 0.0);
+    camera->SetPosition(-direction[0], -direction[1], -direction[2]);
+    camera->SetViewUp(viewUp[0], viewUp[1], viewUp[2]);
+    viewRenderers.append(view);
+    setupTransparency(view);
+}
+
+/**
+ * @brief Selects how a view draws translucent parts.
+ *
+ * By default translucent parts are drawn with weighted blended order-independent transparency,
+ * a single extra pass over the translucent geometry whose cost does not depend on how many
+ * surfaces overlap. Depth peeling sorts the layers exactly but renders the translucent geometry
+ * once per peel, so it is only used when the quality mode is chosen from the View menu.
+ * Opaque parts are drawn the same way in both modes.
+ *
+ * @param view The renderer to configure.
+ */
+void MainWindow::setupTransparency(vtkRenderer* view) {
+    view->SetUseDepthPeeling(depthPeeling);
+    view->SetMaximumNumberOfPeels(8);
+    view->SetOcclusionRatio(0.05);
+    view->SetUseOIT(!depthPeeling);
+}
+
 /**
  * @brief Connects signals from various UI elements to the corresponding slots.
  */
@@ -141,6 +259,47 @@ void MainWindow::connectSignals() {
     connect(ui->actionItem_Options, &QAction::triggered, this, &MainWindow::on_actionItemOptions_triggered);
     connect(ui->actionNew_Group, &QAction::triggered, this, &MainWindow::on_actionNewGroup_triggered);
     connect(ui->actionSearch_Items, &QAction::triggered, this, &MainWindow::on_actionSearchItem_triggered);
+    connect(ui->actionFind_Next, &QAction::triggered, this, &MainWindow::on_actionFindNext_triggered);
+    connect(ui->actionFind_Previous, &QAction::triggered, this, &MainWindow::on_actionFindPrevious_triggered);
+    connect(ui->lineEditSearch, &QLineEdit::textChanged, this, &MainWindow::searchParts);
+    connect(ui->lineEditSearch, &QLineEdit::returnPressed, this, &MainWindow::on_actionFindNext_triggered);
+    ui->toolButtonSearchNext->setDefaultAction(ui->actionFind_Next);
+    ui->toolButtonSearchPrevious->setDefaultAction(ui->actionFind_Previous);
+    connect(ui->actionPerformance_Overlay, &QAction::toggled, this, &MainWindow::on_actionPerformanceOverlay_toggled);
+    connect(ui->actionExport_Render_Statistics, &QAction::triggered, this, &MainWindow::on_actionExportRenderStatistics_triggered);
+    connect(ui->actionExport_Scene, &QAction::triggered, this, &MainWindow::on_actionExportScene_triggered);
+    connect(ui->actionResidency, &QAction::triggered, this, &MainWindow::on_actionResidency_triggered);
+    connect(ui->actionFilter_Parts, &QAction::triggered, this, &MainWindow::on_actionFilterParts_triggered);
+    connect(ui->actionStatistics_Columns, &QAction::toggled, this, &MainWindow::on_actionStatisticsColumns_toggled);
+    connect(ui->actionZoom_To_Selection, &QAction::triggered, this, &MainWindow::on_actionZoomToSelection_triggered);
+    connect(ui->actionDepth_Peeling, &QAction::toggled, this, &MainWindow::on_actionDepthPeeling_toggled);
+    connect(ui->actionVR_Session, &QAction::toggled, this, &MainWindow::on_actionVRSession_toggled);
+    connect(ui->actionVR_Offscreen_Session, &QAction::toggled, this, &MainWindow::on_actionVROffscreenSession_toggled);
+    ui->actionVR_Session->setEnabled(VRRenderThread::headsetSupported());
+    connect(ui->actionUndo, &QAction::triggered, this, &MainWindow::on_actionUndo_triggered);
+    connect(ui->actionRedo, &QAction::triggered, this, &MainWindow::on_actionRedo_triggered);
+    connect(journal, &EditJournal::changed, this, &MainWindow::updateUndoActions);
+    connect(journal, &EditJournal::subtreeDiscarded, this, [this](ModelPart* root) {
+        if (streamers.isEmpty())
+            return;
+        std::vector<ModelPart*> stack{ root };
+        while (!stack.empty()) {
+            ModelPart* part = stack.back();
+            stack.pop_back();
+            delete streamers.take(part->id());
+            for (int i = 0; i < part->childCount(); ++i)
+                stack.push_back(part->child(i));
+        }
+        });
+    updateUndoActions();
+
+    QActionGroup* layoutGroup = new QActionGroup(this);
+    layoutGroup->addAction(ui->actionSingle_View);
+    layoutGroup->addAction(ui->actionTwo_Views);
+    layoutGroup->addAction(ui->actionFour_Views);
+    connect(ui->actionSingle_View, &QAction::triggered, this, [this]() { setViewLayout(1); });
+    connect(ui->actionTwo_Views, &QAction::triggered, this, [this]() { setViewLayout(2); });
+    connect(ui->actionFour_Views, &QAction::triggered, this, [this]() { setViewLayout(4); });
 }
 
 /**
@@ -154,10 +313,13 @@ void MainWindow::handleTreeClicked() {
     QModelIndex index = ui->treeView->currentIndex();
 
     // Get a pointer to the item from the index
-    ModelPart* selectedPart = static_cast<ModelPart*>(index.internalPointer());
+    ModelPart* selectedPart = partForIndex(index);
+    if (!selectedPart) {
+        return;
+    }
 
     // Retrieve the name string from the internal QVariant data array
-    QString text = selectedPart->data(0).toString();
+    QString text = selectedPart->name();
 
     emit statusUpdateMessage("The selected item is: " + text, 2000);
 }
@@ -165,109 +327,130 @@ void MainWindow::handleTreeClicked() {
 /**
  * @brief Triggered when the 'Item Options' action is activated.
  *
- * Opens a dialog for editing the properties (name, visibility, color) of the selected item.
- * If changes are confirmed, it applies the updated properties to the selected item
- * and all its child items recursively.
+ * Opens a dialog for editing the properties (name, visibility, color, opacity, position) of the selected items.
+ * If changes are confirmed, it applies the updated properties to every selected item
+ * and all their child items in one batch. With a single item selected, the name and position
+ * are set on that item only; its children follow through the transform hierarchy.
  */
 void MainWindow::on_actionItemOptions_triggered() {
-    QModelIndex index = ui->treeView->currentIndex();
-    if (!index.isValid()) {
+    QList<ModelPart*> parts = selectedParts();
+    if (parts.isEmpty()) {
         QMessageBox::information(this, tr("No Selection"), tr("There is no selected part."));
         return;
     }
 
-    ModelPart* selectedPart = static_cast<ModelPart*>(index.internalPointer());
-    if (!selectedPart) {
-        QMessageBox::information(this, tr("No Selection"), tr("There is no selected part."));
-        return;
-    }
+    // The current row, if it is one of the selected parts, provides the values shown in the dialog
+    ModelPart* selectedPart = partForIndex(ui->treeView->currentIndex());
+    if (!parts.contains(selectedPart))
+        selectedPart = parts.first();
 
     OptionDialog dialog(this);
-    dialog.setName(selectedPart->data(0).toString());
+    dialog.setName(selectedPart->name());
     dialog.setColor(QColor(selectedPart->getColourR(), selectedPart->getColourG(), selectedPart->getColourB()));
     dialog.setVisibility(selectedPart->visible());
+    dialog.setOpacity(selectedPart->opacity());
+    double position[3], orientation[3];
+    selectedPart->getLocalTransform(position, orientation);
+    dialog.setTransform(position, orientation);
+    if (parts.size() > 1)
+        dialog.setMultipleSelection(parts.size());
 
     if (dialog.exec() == QDialog::Accepted) {
         QColor color = dialog.getColor();
-        applyPropertiesToPart(selectedPart, dialog.getName(), dialog.getVisibility(), color, true);
-        updateChildrenProperties(selectedPart, dialog.getVisibility(), color);
-        emit statusUpdateMessage("Item and its children updated.", 2000);
+        PropertyTransaction transaction;
+        for (ModelPart* part : parts) {
+            partList->materializeSubtree(part); // Parts not loaded yet take the new properties too
+            transaction.setSubtreeProperties(part, dialog.getVisibility(), color, dialog.getOpacity());
+        }
+        if (parts.size() == 1)
+            transaction.setName(selectedPart, dialog.getName());
+
+        EditJournal::Entry entry;
+        entry.text = parts.size() == 1 ? tr("Edit %1").arg(selectedPart->name()) : tr("Edit %n Items", nullptr, parts.size());
+        EditJournal::captureProperties(entry, transaction);
+        if (parts.size() == 1) {
+            dialog.getTransform(position, orientation);
+            EditJournal::captureTransform(entry, selectedPart, position, orientation);
+            selectedPart->setLocalTransform(position, orientation);
+        }
+        commitProperties(transaction);
+        journal->record(std::move(entry));
+        if (parts.size() == 1)
+            emit statusUpdateMessage("Item and its children updated.", 2000);
+        else
+            emit statusUpdateMessage(tr("%n items and their children updated.", nullptr, parts.size()), 2000);
     }
 }
 
 /**
- * @brief Applies specified properties to a part.
+ * @brief Applies a batch of property edits to the model, the octree streamers and the renderer.
  *
- * Sets the provided name, visibility, and color to the specified part. If updateName is true,
- * the name of the part is updated along with its visibility and color.
+ * The model is updated in one pass with one view notification per parent, and the renderer is
+ * handed every changed actor as a single batch followed by one frame. A part whose mesh was
+ * released while hidden stays hidden until the residency manager has restored it.
  *
- * @param part The part to which the properties will be applied.
- * @param name The new name to set, applicable only if updateName is true.
- * @param visibility The new visibility state to apply.
- * @param color The new color to apply.
- * @param updateName Flag to determine whether to update the part's name.
+ * @param transaction The edits to apply.
  */
-void MainWindow::applyPropertiesToPart(ModelPart* part, const QString& name, bool visibility, const QColor& color, bool updateName) {
-    if (!part) return;
-
-    if (updateName) {
-        part->set(0, QVariant(name)); // Update name only if updateName is true
-    }
-    part->set(1, QVariant(visibility ? "true" : "false"));
-    part->set(2, QVariant(QString::number(color.red()) + "," + QString::number(color.green()) + "," + QString::number(color.blue())));
-
-    part->setColour(color.red(), color.green(), color.blue());
-    part->setVisible(visibility);
+void MainWindow::commitProperties(const PropertyTransaction& transaction) {
+    if (transaction.isEmpty())
+        return;
 
-    QAbstractItemModel* model = ui->treeView->model();
-    QModelIndex startIndex = model->index(part->row(), 0);
-    QModelIndex endIndex = model->index(part->row(), model->columnCount());
-    model->dataChanged(startIndex, endIndex);
-    ui->treeView->update(startIndex);
+    partList->applyProperties(transaction);
 
-    vtkSmartPointer<vtkActor> actor = part->getActor();
-    if (actor) {
-        actor->SetVisibility(visibility);
-        actor->GetProperty()->SetDiffuseColor(color.red() / 255.0, color.green() / 255.0, color.blue() / 255.0);
-        updateRender();
-    }
-}
+    QList<SceneDelta> deltas;
+    for (const PropertyTransaction::Edit& edit : transaction.edits()) {
+        ModelPart* part = edit.part;
+        if (OctreeStreamer* streamer = streamers.value(part->id())) {
+            streamer->setVisible(part->visible());
+            streamer->setColour(part->getColor());
+            streamer->setOpacity(part->opacity());
+        }
 
-/**
- * @brief Recursively updates the properties of child parts.
- *
- * Applies the specified visibility and color recursively to all child parts of the given part.
- * The name of the child parts is not updated.
- *
- * @param part The part whose children will be updated.
- * @param visibility The visibility state to apply to all child parts.
- * @param color The color to apply to all child parts.
- */
-void MainWindow::updateChildrenProperties(ModelPart* part, bool visibility, const QColor& color) {
-    for (int i = 0; i < part->childCount(); ++i) {
-        ModelPart* child = part->child(i);
-        applyPropertiesToPart(child, QString(), visibility, color, false); // false to not update name
-        updateChildrenProperties(child, visibility, color); // Recursive call
+        vtkSmartPointer<vtkActor> actor = part->getActor();
+        if (actor) {
+            bool drawable = residency->notifyVisibility(part, part->visible());
+            SceneDelta delta;
+            delta.type = SceneDelta::Type::UpdatePart;
+            delta.partId = part->id();
+            delta.actor = actor;
+            delta.visible = part->visible() && drawable;
+            delta.colour = part->getColor();
+            delta.opacity = part->opacity();
+            deltas.append(delta);
+        }
     }
+    deltas.append(SceneDelta());
+    sceneQueue->enqueue(deltas);
 }
 
 /**
  * @brief Updates the renderer with the current tree structure.
  *
  * Iterates over the top-level items in the tree and updates the rendering accordingly.
- * This includes resetting the camera and updating the render view.
+ * This includes resetting the camera and updating the render view. Incremental changes
+ * should be queued on the scene delta queue instead; this rebuilds the whole scene.
  */
 void MainWindow::updateRender() {
-    renderer->RemoveAllViewProps(); // Remove existing actors
-
-   
+    for (vtkRenderer* view : viewRenderers) {
+        view->RemoveAllViewProps(); // Remove existing actors
+        if (floorActor) {
+            view->AddActor(floorActor);
+        }
+    }
+    renderedParts.clear();
 
     int topLevelItemCount = partList->rowCount(QModelIndex());
     for (int i = 0; i < topLevelItemCount; ++i) {
         QModelIndex topLevelIndex = partList->index(i, 0, QModelIndex());
         updateRenderFromTree(topLevelIndex);
     }
+    QList<ModelPart*> parts = renderedPartList();
+    governor->setParts(parts);
+    statistics->setParts(parts);
 
+    for (int i = 1; i < viewRenderers.size(); ++i) {
+        viewRenderers[i]->ResetCamera();
+    }
     renderer->ResetCamera();
     renderer->GetActiveCamera()->Azimuth(30);
     renderer->GetActiveCamera()->Elevation(30);
@@ -292,7 +475,10 @@ void MainWindow::updateRenderFromTree(const QModelIndex& index) {
         if (selectedPart) {
             vtkActor* actor = selectedPart->getActor();
             if (actor) {
-                renderer->AddActor(actor);
+                for (vtkRenderer* view : viewRenderers) {
+                    view->AddActor(actor);
+                }
+                renderedParts.append(selectedPart->id());
             }
         }
         int rows = partList->rowCount(index);
@@ -306,12 +492,16 @@ void MainWindow::updateRenderFromTree(const QModelIndex& index) {
  * @brief Slot triggered to open and load files.
  *
  * Opens a file dialog allowing the user to select and load STL files. Each selected file
- * creates a new ModelPart that is appended to the tree and rendered in the viewport.
+ * creates a new ModelPart that is appended to the tree and rendered in the viewport. Octree
+ * files written by stl2octree are streamed instead of loaded.
  */
 void MainWindow::on_actionOpen_File_triggered() {
-    QStringList fileNames = QFileDialog::getOpenFileNames(this, tr("Open Files"), QDir::homePath(), tr("STL Files (*.stl);;Text Files (*.txt)"));
+    QStringList fileNames = QFileDialog::getOpenFileNames(this, tr("Open Files"), QDir::homePath(), tr("STL Files (*.stl);;Octree Files (*.oct);;Text Files (*.txt)"));
     for (const QString& fileName : fileNames) {
-        if (!fileName.isEmpty()) {
+        if (fileName.endsWith(".oct", Qt::CaseInsensitive)) {
+            openOctree(fileName);
+        }
+        else if (!fileName.isEmpty()) {
             createModelPartFromFile(fileName);
         }
     }
@@ -321,7 +511,8 @@ void MainWindow::on_actionOpen_File_triggered() {
  * @brief Creates a ModelPart from a file and adds it to the tree.
  *
  * Given a file name, this function creates a new ModelPart, loads the data from the file,
- * and appends it to the model tree, updating the rendering accordingly.
+ * and queues it for insertPendingParts(), which appends it to the model tree and updates the
+ * rendering.
  *
  * @param fileName The name of the file to create the ModelPart from.
  */
@@ -332,36 +523,107 @@ void MainWindow::createModelPartFromFile(const QString& fileName) {
         QFileInfo fileInfo(fileName);
         QString justFileName = fileInfo.fileName();
 
-        QList<QVariant> data = { QVariant(justFileName), QVariant("true"), QVariant("255,255,255") };
-        ModelPart* newPart = new ModelPart(data);
+        ModelPart* newPart = new ModelPart(justFileName); // Visible, white and opaque
 
         // Load STL file (heavy operation)
         newPart->loadSTL(fileName);
 
-        QColor whiteColor(255, 255, 255);
-        newPart->setColour(whiteColor.red(), whiteColor.green(), whiteColor.blue());
-        newPart->setVisible(true);
-
         // Once done, schedule the following code to be run on the main thread
-        QMetaObject::invokeMethod(this, [this, newPart, fileName] {
+        QMetaObject::invokeMethod(this, [this, newPart] {
                 QModelIndex currentIndex = ui->treeView->currentIndex();
-                ModelPart* parentPart = currentIndex.isValid() ? static_cast<ModelPart*>(currentIndex.internalPointer()) : partList->getRootItem();
-                parentPart->appendChild(newPart);
-
-                QAbstractItemModel* model = ui->treeView->model();
-                model->dataChanged(model->index(newPart->row(), 0), model->index(newPart->row(), model->columnCount() - 1));
-                emit model->dataChanged(model->index(newPart->row(), 0), model->index(newPart->row(), model->columnCount() - 1));
-                emit model->layoutChanged();
-
-                updateRender();
-                addFloor(); // Re-add the floor every time the scene is updated
-                emit statusUpdateMessage(QString("Loaded STL file: %1").arg(fileName), 5000);
+                ModelPart* parentPart = currentIndex.isValid() ? partForIndex(currentIndex) : partList->getRootItem();
+                if (pendingParts.isEmpty()) {
+                    QTimer::singleShot(0, this, &MainWindow::insertPendingParts);
+                }
+                pendingParts[parentPart->id()].append(newPart);
             }, Qt::QueuedConnection);
     });
 }
 
+/**
+ * @brief Inserts the parts loaded since the last call into the tree.
+ *
+ * Files opened together finish loading in the same few event loop iterations, so their parts are
+ * gathered and inserted with one model notification per parent, and one scene batch for all.
+ * Parts whose intended parent was deleted meanwhile are added at the top level.
+ */
+void MainWindow::insertPendingParts() {
+    QHash<quint64, QList<ModelPart*>> batches;
+    batches.swap(pendingParts);
+
+    QList<SceneDelta> deltas;
+    EditJournal::Entry entry;
+    for (auto it = batches.constBegin(); it != batches.constEnd(); ++it) {
+        ModelPart* parentPart = PartRegistry::instance().find(it.key());
+        partList->appendParts(it.value(), partList->indexForPart(parentPart ? parentPart : partList->getRootItem()));
+        for (ModelPart* newPart : it.value()) {
+            entry.inserted.push_back(EditJournal::placement(newPart));
+            residency->track(newPart);
+            picker->registerPart(newPart);
+            occlusionBaker->bake(newPart);
+            deltas.append(describePart(newPart));
+        }
+    }
 
+    SceneDelta camera;
+    camera.type = SceneDelta::Type::ResetCamera;
+    deltas.append(camera);
+    sceneQueue->enqueue(deltas);
+    entry.text = entry.inserted.size() == 1 ? tr("Open %1").arg(batches.cbegin().value().first()->name())
+                                            : tr("Open %n Files", nullptr, static_cast<int>(entry.inserted.size()));
+    journal->record(std::move(entry));
+    if (batches.size() == 1 && batches.cbegin().value().size() == 1) {
+        emit statusUpdateMessage(QString("Loaded STL file: %1").arg(batches.cbegin().value().first()->sourceFile()), 5000);
+    }
+    else {
+        int count = 0;
+        for (const QList<ModelPart*>& parts : batches) {
+            count += parts.size();
+        }
+        emit statusUpdateMessage(QString("Loaded %1 STL files").arg(count), 5000);
+    }
+}
 
+/**
+ * @brief Adds an octree file to the tree and streams it into the main view.
+ *
+ * The part has no actor of its own: its OctreeStreamer adds and removes chunk actors in the main
+ * renderer as the camera moves, and asks for a frame whenever the drawn chunks change. The part's
+ * visibility, colour and opacity are forwarded to the streamer by commitProperties().
+ *
+ * @param fileName The octree file to open.
+ */
+void MainWindow::openOctree(const QString& fileName) {
+    OctreeStreamer* streamer = new OctreeStreamer(renderWindow, renderer, this);
+    if (!streamer->open(fileName)) {
+        delete streamer;
+        QMessageBox::warning(this, tr("Open Error"), tr("%1 is not a valid octree file.").arg(fileName));
+        return;
+    }
+    connect(streamer, &OctreeStreamer::needsRender, this, [this] {
+        sceneQueue->enqueue(SceneDelta());
+        });
+
+    ModelPart* newPart = new ModelPart(QFileInfo(fileName).fileName());
+    QModelIndex currentIndex = ui->treeView->currentIndex();
+    ModelPart* parentPart = currentIndex.isValid() ? partForIndex(currentIndex) : partList->getRootItem();
+    streamers.insert(newPart->id(), streamer);
+    partList->appendParts({ newPart }, partList->indexForPart(parentPart));
+    EditJournal::Entry entry;
+    entry.text = tr("Open %1").arg(newPart->name());
+    entry.inserted.push_back(EditJournal::placement(newPart));
+    journal->record(std::move(entry));
+
+    // The chunks arrive after the first frames, so fit the camera to the bounds in the node table
+    double bounds[6];
+    streamer->bounds(bounds);
+    renderer->ResetCamera(bounds);
+    renderer->GetActiveCamera()->Azimuth(30);
+    renderer->GetActiveCamera()->Elevation(30);
+    renderer->ResetCameraClippingRange(bounds);
+    sceneQueue->enqueue(SceneDelta());
+    emit statusUpdateMessage(QString("Streaming octree file: %1").arg(fileName), 5000);
+}
 
 /**
  * @brief Slot triggered to handle the creation of a new group.
@@ -374,122 +636,923 @@ void MainWindow::on_actionNewGroup_triggered() {
     QModelIndex index = ui->treeView->currentIndex();
     connect(newGroupDialog, &NewGroupDialog::accepted, [this, index]() {
         QString groupName = newGroupDialog->getGroupName();
-        ModelPart* parentPart = index.isValid() ? static_cast<ModelPart*>(index.internalPointer()) : this->partList->getRootItem();
-        ModelPart* newGroup = new ModelPart({ groupName, "true", "255,255,255" });
-        parentPart->appendChild(newGroup);
-        ui->treeView->model()->layoutChanged();
+        ModelPart* parentPart = index.isValid() ? partForIndex(index) : this->partList->getRootItem();
+        ModelPart* newGroup = new ModelPart(groupName);
+        partList->appendParts({ newGroup }, partList->indexForPart(parentPart));
+        EditJournal::Entry entry;
+        entry.text = tr("New Group %1").arg(groupName);
+        entry.inserted.push_back(EditJournal::placement(newGroup));
+        journal->record(std::move(entry));
         });
 
     newGroupDialog->show();
 }
 
 /**
- * @brief Slot triggered to delete the currently selected file/part.
+ * @brief Slot triggered to delete the selected files/parts.
  *
- * Removes the selected item from the model and the tree view, updating the renderer
- * accordingly. If no item is selected, no action is taken.
+ * Removes every selected item, with its children, from the model and the tree view, updating
+ * the renderer in one batch. If no item is selected, no action is taken. The removed subtrees
+ * are parked in the journal rather than deleted, so the deletion can be undone.
  */
 void MainWindow::on_actionDeleteFile_triggered() {
-    QModelIndex currentIndex = ui->treeView->currentIndex();
-    if (!currentIndex.isValid()) {
+    QList<ModelPart*> parts = selectedParts();
+    if (parts.isEmpty()) {
         QMessageBox::warning(this, tr("Selection Error"), tr("Please select an item to delete."));
         return;
     }
 
-    ModelPartList* model = qobject_cast<ModelPartList*>(ui->treeView->model());
-    if (!model) {
-        return;
+    for (ModelPart* part : parts) {
+        if (part->name() == "Model") {
+            QMessageBox::warning(this, tr("Invalid Operation"), tr("Cannot delete root item."));
+            return;
+        }
     }
 
-    ModelPart* selectedItem = static_cast<ModelPart*>(currentIndex.internalPointer());
-    if (!selectedItem) {
-        return;
+    QString question = parts.size() == 1 ? tr("Are you sure you want to delete this item?")
+                                         : tr("Are you sure you want to delete these %n items?", nullptr, parts.size());
+    auto response = QMessageBox::question(this, tr("Confirm Deletion"), question, QMessageBox::Yes | QMessageBox::No);
+
+    if (response == QMessageBox::Yes) {
+        EditJournal::Entry entry;
+        entry.text = parts.size() == 1 ? tr("Delete %1").arg(parts.first()->name()) : tr("Delete %n Items", nullptr, parts.size());
+        for (ModelPart* part : parts)
+            entry.removed.push_back(EditJournal::placement(part));
+        int removed = detachParts(entry.removed);
+        if (removed > 0)
+            journal->record(std::move(entry));
+        searchParts(ui->lineEditSearch->text()); // The deleted parts may have been matches
+        if (removed == parts.size())
+            emit statusUpdateMessage(tr("%n item(s) deleted successfully.", nullptr, removed), 5000);
+        else
+            emit statusUpdateMessage("Error deleting item.", 5000);
     }
+}
 
-    if (selectedItem->data(0).toString() == "Model") {
-        QMessageBox::warning(this, tr("Invalid Operation"), tr("Cannot delete root item."));
-        return;
+/**
+ * @brief Removes the vtkActor objects of some parts and all their descendants from the renderer.
+ *
+ * Walks each part's hierarchy, queuing the removal of every associated vtkActor as a single batch.
+ * The parts are dropped from the governor and statistics immediately, since the caller is
+ * about to detach them; the actors themselves leave the renderer with the next frame. Octree
+ * streamers are hidden rather than deleted, in case the parts are put back.
+ *
+ * @param parts The roots of the subtrees being removed.
+ */
+void MainWindow::removeActors(const QList<ModelPart*>& parts) {
+    QList<SceneDelta> deltas;
+    QSet<quint64> removed;
+    std::vector<ModelPart*> stack(parts.begin(), parts.end());
+    while (!stack.empty()) {
+        ModelPart* part = stack.back();
+        stack.pop_back();
+        if (!part)
+            continue;
+
+        vtkSmartPointer<vtkActor> actor = part->getActor();
+        if (actor) {
+            SceneDelta delta;
+            delta.type = SceneDelta::Type::RemovePart;
+            delta.partId = part->id();
+            delta.actor = actor;
+            deltas.append(delta);
+            removed.insert(part->id());
+            residency->forget(part);
+            picker->unregisterPart(part);
+        }
+        if (OctreeStreamer* streamer = streamers.value(part->id()))
+            streamer->setVisible(false);
+
+        for (int i = 0; i < part->childCount(); ++i)
+            stack.push_back(part->child(i));
+    }
+    deltas.append(SceneDelta());
+    sceneQueue->enqueue(deltas);
+
+    if (!removed.isEmpty()) {
+        renderedParts.erase(std::remove_if(renderedParts.begin(), renderedParts.end(),
+            [&removed](quint64 id) { return removed.contains(id); }), renderedParts.end());
+        QList<ModelPart*> rendered = renderedPartList();
+        governor->setParts(rendered);
+        statistics->setParts(rendered);
     }
+}
 
-    auto response = QMessageBox::question(this, tr("Confirm Deletion"),
-        tr("Are you sure you want to delete this item?"),
-        QMessageBox::Yes | QMessageBox::No);
+/**
+ * @brief Returns the parts whose actors are in the renderer, resolved from their IDs.
+ *
+ * @return The parts, in the order they were added, without any that no longer exist.
+ */
+QList<ModelPart*> MainWindow::renderedPartList() const {
+    QList<ModelPart*> parts;
+    parts.reserve(renderedParts.size());
+    for (quint64 id : renderedParts) {
+        if (ModelPart* part = PartRegistry::instance().find(id))
+            parts.append(part);
+    }
+    return parts;
+}
 
-    if (response == QMessageBox::Yes) {
-        removeActorsRecursively(selectedItem);
-        if (model->removeRows(currentIndex.row(), 1, currentIndex.parent())) {
-            emit statusUpdateMessage("Item deleted successfully.", 5000);
+/**
+ * @brief Adds the actors of some parts and all their descendants back to the renderer.
+ *
+ * The counterpart of removeActors() for subtrees put back in the tree. A part whose mesh was
+ * released before it was removed stays hidden until the residency manager has restored it.
+ *
+ * @param parts The roots of the subtrees being put back.
+ */
+void MainWindow::addActors(const QList<ModelPart*>& parts) {
+    QList<SceneDelta> deltas;
+    std::vector<ModelPart*> stack(parts.begin(), parts.end());
+    while (!stack.empty()) {
+        ModelPart* part = stack.back();
+        stack.pop_back();
+
+        if (OctreeStreamer* streamer = streamers.value(part->id()))
+            streamer->setVisible(part->visible());
+        if (part->getActor()) {
+            residency->track(part);
+            picker->registerPart(part);
+            bool drawable = residency->notifyVisibility(part, part->visible());
+            if (!part->geometryResident()) {
+                SceneDelta addition; // describePart() only adds parts that have a mesh to send
+                addition.type = SceneDelta::Type::AddPart;
+                addition.partId = part->id();
+                addition.actor = part->getActor();
+                deltas.append(addition);
+            }
+            for (SceneDelta delta : describePart(part)) {
+                if (delta.type == SceneDelta::Type::UpdatePart)
+                    delta.visible = delta.visible && drawable;
+                deltas.append(delta);
+            }
         }
-        else {
-            emit statusUpdateMessage("Error deleting item.", 5000);
+
+        for (int i = 0; i < part->childCount(); ++i)
+            stack.push_back(part->child(i));
+    }
+    deltas.append(SceneDelta());
+    sceneQueue->enqueue(deltas);
+}
+
+/**
+ * @brief Takes subtrees out of the tree and the renderer, parking them in their placements.
+ *
+ * Each placement is updated to the part's current parent and row before it is detached, and the
+ * placements are sorted so that attachParts() can put them back in order.
+ *
+ * @param placements The subtrees to detach, by root ID. Parts no longer in the tree are skipped.
+ * @return The number of subtrees detached.
+ */
+int MainWindow::detachParts(std::vector<EditJournal::Placement>& placements) {
+    QList<ModelPart*> parts;
+    for (EditJournal::Placement& placement : placements) {
+        ModelPart* part = PartRegistry::instance().find(placement.partId);
+        if (!part || !part->parentItem())
+            continue;
+        placement = EditJournal::placement(part);
+        parts.append(part);
+    }
+    if (parts.isEmpty())
+        return 0;
+
+    std::sort(placements.begin(), placements.end(), [](const EditJournal::Placement& a, const EditJournal::Placement& b) {
+        return a.parentId != b.parentId ? a.parentId < b.parentId : a.row < b.row;
+        });
+    removeActors(parts);
+    QList<ModelPart*> taken = partList->takeParts(parts);
+    QSet<ModelPart*> detached(taken.begin(), taken.end());
+    for (EditJournal::Placement& placement : placements) {
+        ModelPart* part = PartRegistry::instance().find(placement.partId);
+        if (detached.contains(part))
+            placement.parked = part;
+    }
+    return taken.size();
+}
+
+/**
+ * @brief Puts parked subtrees back in the tree and the renderer.
+ *
+ * Placements under the same parent in consecutive rows are inserted as one run. A subtree whose
+ * parent no longer exists or is not in the tree is put back at the top level. A run that cannot
+ * be inserted stays parked in its placements, so the journal still owns it.
+ *
+ * @param placements The subtrees to attach, as sorted by detachParts().
+ */
+void MainWindow::attachParts(std::vector<EditJournal::Placement>& placements) {
+    QList<ModelPart*> attached;
+    for (std::size_t first = 0; first < placements.size();) {
+        std::size_t last = first;
+        while (last + 1 < placements.size() && placements[last + 1].parentId == placements[first].parentId &&
+            placements[last + 1].row == placements[last].row + 1)
+            ++last;
+
+        QList<ModelPart*> run;
+        for (std::size_t i = first; i <= last; ++i) {
+            if (placements[i].parked)
+                run.append(placements[i].parked);
         }
+
+        // A parent that is gone or itself parked has no index, so the run goes to the top level
+        ModelPart* parentPart = PartRegistry::instance().find(placements[first].parentId);
+        QModelIndex parentIndex = partList->indexForPart(parentPart);
+        if (!parentIndex.isValid())
+            parentPart = partList->getRootItem();
+        int row = qBound(0, placements[first].row, parentPart->childCount());
+        if (!run.isEmpty() && partList->insertParts(row, run, parentIndex)) {
+            for (std::size_t i = first; i <= last; ++i)
+                placements[i].parked = nullptr;
+            attached.append(run);
+        }
+        first = last + 1;
     }
+    if (!attached.isEmpty())
+        addActors(attached);
+}
+
+/**
+ * @brief Slot triggered to undo the last edit recorded in the journal.
+ */
+void MainWindow::on_actionUndo_triggered() {
+    EditJournal::Entry* entry = journal->undoEntry();
+    if (!entry)
+        return;
+
+    QString text = entry->text;
+    applyJournalEntry(*entry, false);
+    journal->finishUndo();
+    emit statusUpdateMessage(tr("Undone: %1").arg(text), 2000);
 }
 
 /**
- * @brief Recursively removes vtkActor objects from the renderer for a ModelPart and its descendants.
+ * @brief Slot triggered to redo the last undone edit.
+ */
+void MainWindow::on_actionRedo_triggered() {
+    EditJournal::Entry* entry = journal->redoEntry();
+    if (!entry)
+        return;
+
+    QString text = entry->text;
+    applyJournalEntry(*entry, true);
+    journal->finishRedo();
+    emit statusUpdateMessage(tr("Redone: %1").arg(text), 2000);
+}
+
+/**
+ * @brief Reverts or reapplies one journal entry.
  *
- * Iterates over the ModelPart hierarchy, removing each associated vtkActor from the renderer.
- * It ensures the graphical representation is consistent with the tree view's structure.
+ * Undoing sets the old properties and transforms, puts removed subtrees back and parks inserted
+ * ones; redoing does the same steps in reverse order with the new values.
  *
- * @param part The ModelPart to start removal from; does nothing if null.
+ * @param entry The entry. Its placements are updated as subtrees are parked and put back.
+ * @param redo True to reapply the entry, false to revert it.
  */
-void MainWindow::removeActorsRecursively(ModelPart* part) {
-    if (!part) return;
+void MainWindow::applyJournalEntry(EditJournal::Entry& entry, bool redo) {
+    if (redo) {
+        attachParts(entry.inserted);
+        detachParts(entry.removed);
+    }
+    else {
+        commitProperties(EditJournal::propertyTransaction(entry, false));
+    }
 
-    vtkSmartPointer<vtkActor> actor = part->getActor();
-    if (actor) {
-        renderer->RemoveActor(actor);
+    for (const EditJournal::TransformChange& change : entry.transforms) {
+        ModelPart* part = PartRegistry::instance().find(change.partId);
+        if (!part)
+            continue;
+        const double* values = redo ? change.after : change.before;
+        part->setLocalTransform(values, values + 3);
     }
 
-    for (int i = 0; i < part->childCount(); ++i) {
-        removeActorsRecursively(part->child(i));
+    if (redo) {
+        commitProperties(EditJournal::propertyTransaction(entry, true));
+    }
+    else {
+        attachParts(entry.removed);
+        detachParts(entry.inserted);
     }
 
-    renderWindow->Render();
+    searchParts(ui->lineEditSearch->text()); // Parts may have been renamed, removed or put back
+    sceneQueue->enqueue(SceneDelta()); // Moved parts are recomposed with the next frame
+}
+
+/**
+ * @brief Shows what the Undo and Redo actions would do and enables them if there is anything to do.
+ */
+void MainWindow::updateUndoActions() {
+    ui->actionUndo->setEnabled(journal->canUndo());
+    ui->actionUndo->setText(journal->canUndo() ? tr("Undo %1").arg(journal->undoText()) : tr("Undo"));
+    ui->actionRedo->setEnabled(journal->canRedo());
+    ui->actionRedo->setText(journal->canRedo() ? tr("Redo %1").arg(journal->redoText()) : tr("Redo"));
 }
 
+/**
+ * @brief Returns the parts selected in the tree, leaving out those whose ancestor is also selected.
+ *
+ * Falls back to the current row if no row is selected.
+ *
+ * @return The selected parts, in selection order.
+ */
+QList<ModelPart*> MainWindow::selectedParts() {
+    QModelIndexList rows = ui->treeView->selectionModel()->selectedRows();
+    if (rows.isEmpty() && ui->treeView->currentIndex().isValid())
+        rows.append(ui->treeView->currentIndex());
+
+    QSet<ModelPart*> selected;
+    for (const QModelIndex& index : rows) {
+        if (ModelPart* part = partForIndex(index))
+            selected.insert(part);
+    }
+
+    QList<ModelPart*> parts;
+    for (const QModelIndex& index : rows) {
+        ModelPart* part = partForIndex(index);
+        if (!part)
+            continue;
+        bool covered = false;
+        for (ModelPart* ancestor = part->parentItem(); ancestor && !covered; ancestor = ancestor->parentItem())
+            covered = selected.contains(ancestor);
+        if (!covered)
+            parts.append(part);
+    }
+    return parts;
+}
 
+/**
+ * @brief Slot triggered to search the tree; moves the focus to the search box.
+ */
 void MainWindow::on_actionSearchItem_triggered() {
-    bool ok;
-    QString searchTerm = QInputDialog::getText(this, tr("Search in TreeView"),
-        tr("Enter search term:"), QLineEdit::Normal,
-        QString(), &ok);
-    if (ok && !searchTerm.isEmpty()) {
-        QModelIndex searchResult = searchInTreeView(searchTerm, QModelIndex()); // Start from the root
-
-        if (searchResult.isValid()) {
-            selectItemInTreeView(searchResult);
+    ui->lineEditSearch->setFocus();
+    ui->lineEditSearch->selectAll();
+}
+
+/**
+ * @brief Finds every part whose name contains the text, as the user types.
+ *
+ * The query runs against the model's name index rather than walking the tree. All matches are
+ * highlighted and the first is selected; Find Next and Find Previous step through the rest.
+ *
+ * @param text The text in the search box; empty clears the search.
+ */
+void MainWindow::searchParts(const QString& text) {
+    QList<ModelPart*> matches = partList->nameIndex().find(text);
+    partList->setHighlightedParts(matches);
+    searchMatches.clear();
+    searchMatches.reserve(matches.size());
+    for (ModelPart* part : matches)
+        searchMatches.append(part->id());
+    searchCurrent = -1;
+    if (!searchMatches.isEmpty()) {
+        selectMatch(0);
+    }
+    else {
+        ui->labelSearchMatches->setText(text.isEmpty() ? QString() : tr("No matches"));
+    }
+}
+
+/**
+ * @brief Slot triggered to select the next search match, wrapping around at the end.
+ */
+void MainWindow::on_actionFindNext_triggered() {
+    if (!searchMatches.isEmpty()) {
+        selectMatch((searchCurrent + 1) % searchMatches.size());
+    }
+}
+
+/**
+ * @brief Slot triggered to select the previous search match, wrapping around at the start.
+ */
+void MainWindow::on_actionFindPrevious_triggered() {
+    if (!searchMatches.isEmpty()) {
+        selectMatch((searchCurrent + searchMatches.size() - 1) % searchMatches.size());
+    }
+}
+
+/**
+ * @brief Selects one of the search matches in the tree and shows its position in the results.
+ *
+ * @param match The position of the match in searchMatches.
+ */
+void MainWindow::selectMatch(int match) {
+    searchCurrent = match;
+    ModelPart* part = PartRegistry::instance().find(searchMatches[match]);
+    QModelIndex index = part ? viewIndexForPart(part) : QModelIndex(); // The match may have been deleted since
+    if (index.isValid()) {
+        ui->treeView->selectionModel()->clearSelection();
+        selectItemInTreeView(index);
+    }
+    ui->labelSearchMatches->setText(tr("%1 of %2").arg(match + 1).arg(searchMatches.size()));
+}
+
+/**
+ * @brief Makes an index current in the tree view, scrolls to it and selects its row.
+ *
+ * @param index The index to select.
+ */
+void MainWindow::selectItemInTreeView(const QModelIndex& index) {
+    ui->treeView->setCurrentIndex(index);
+    ui->treeView->scrollTo(index);
+    ui->treeView->selectionModel()->select(index, QItemSelectionModel::Select | QItemSelectionModel::Rows);
+}
+
+/**
+ * @brief Returns the collector of per-frame render statistics for the 3D view.
+ *
+ * @return The render statistics of the main view.
+ */
+RenderStatistics* MainWindow::renderStatistics() {
+    return statistics;
+}
+
+/**
+ * @brief Slot triggered to show or hide the performance overlay in the 3D view.
+ *
+ * @param checked True to show the overlay.
+ */
+void MainWindow::on_actionPerformanceOverlay_toggled(bool checked) {
+    statistics->setOverlayVisible(checked);
+}
+
+/**
+ * @brief Slot triggered to export the rolling render statistics.
+ *
+ * Writes the per-frame history to the chosen CSV file and the frame-time histograms to a
+ * companion file with a "_histogram" suffix.
+ */
+void MainWindow::on_actionExportRenderStatistics_triggered() {
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Export Render Statistics"), QDir::homePath(), tr("CSV Files (*.csv)"));
+    if (fileName.isEmpty())
+        return;
+
+    QFileInfo fileInfo(fileName);
+    QString histogramName = fileInfo.path() + "/" + fileInfo.completeBaseName() + "_histogram.csv";
+    if (statistics->exportFramesCsv(fileName) && statistics->exportHistogramCsv(histogramName)) {
+        emit statusUpdateMessage(QString("Render statistics exported to %1").arg(fileName), 5000);
+    }
+    else {
+        QMessageBox::warning(this, tr("Export Failed"), tr("Could not write the render statistics."));
+    }
+}
+
+/**
+ * @brief Slot triggered to export the visible parts to a single STL file.
+ *
+ * The file is written on a worker thread from a snapshot of the tree, so the window stays
+ * responsive and edits made meanwhile do not affect the export.
+ */
+void MainWindow::on_actionExportScene_triggered() {
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Export Scene"), QDir::homePath(), tr("STL Files (*.stl)"));
+    if (fileName.isEmpty())
+        return;
+
+    SceneSnapshot snapshot = partList->snapshot();
+    emit statusUpdateMessage(QString("Exporting scene to %1...").arg(fileName), 0);
+    QtConcurrent::run([this, snapshot, fileName] {
+        int written = snapshot.writeStl(fileName);
+        QMetaObject::invokeMethod(this, [this, fileName, written] {
+            if (written < 0)
+                QMessageBox::warning(this, tr("Export Failed"), tr("Could not write %1.").arg(fileName));
+            else if (written == 0)
+                emit statusUpdateMessage("No visible parts to export.", 5000);
+            else
+                emit statusUpdateMessage(QString("Exported %1 parts to %2").arg(written).arg(fileName), 5000);
+            }, Qt::QueuedConnection);
+        });
+}
+
+/**
+ * @brief Applies a batch of scene changes from the scene delta queue and renders one frame.
+ *
+ * Parts are referred to by ID and resolved through the PartRegistry, because a part may have been
+ * deleted after its change was queued and its memory reused by a new part. World transforms of
+ * parts moved since the last frame are recomposed just before rendering. A running VR session
+ * receives the same batch, followed by the new world matrices of the parts that moved.
+ *
+ * @param deltas The coalesced changes for this frame, in order.
+ */
+void MainWindow::applySceneDeltas(const QList<SceneDelta>& deltas) {
+    bool partsChanged = false;
+    for (const SceneDelta& delta : deltas) {
+        switch (delta.type) {
+        case SceneDelta::Type::AddPart:
+            if (delta.actor) {
+                for (vtkRenderer* view : viewRenderers) {
+                    view->AddActor(delta.actor);
+                }
+                if (PartRegistry::instance().find(delta.partId)) {
+                    renderedParts.append(delta.partId); // Unless it was deleted while the delta was queued
+                    partsChanged = true;
+                }
+            }
+            break;
+        case SceneDelta::Type::RemovePart:
+            for (vtkRenderer* view : viewRenderers) {
+                view->RemoveActor(delta.actor);
+            }
+            partsChanged |= renderedParts.removeOne(delta.partId);
+            break;
+        case SceneDelta::Type::SetTransform:
+            break; // Desktop actors receive their world matrices from the parts below
+        case SceneDelta::Type::ReleaseGeometry:
+            break; // Desktop actors are the parts' own, which already dropped the mesh
+        case SceneDelta::Type::UpdatePart:
+            delta.actor->SetVisibility(delta.visible);
+            delta.actor->GetProperty()->SetDiffuseColor(delta.colour.redF(), delta.colour.greenF(), delta.colour.blueF());
+            delta.actor->GetProperty()->SetOpacity(delta.opacity);
+            break;
+        case SceneDelta::Type::ResetCamera:
+            for (int i = 1; i < viewRenderers.size(); ++i) {
+                viewRenderers[i]->ResetCamera();
+            }
+            renderer->ResetCamera();
+            renderer->GetActiveCamera()->Azimuth(30);
+            renderer->GetActiveCamera()->Elevation(30);
+            renderer->ResetCameraClippingRange();
+            break;
+        case SceneDelta::Type::SetCamera:
+            renderer->GetActiveCamera()->SetPosition(delta.position);
+            renderer->GetActiveCamera()->SetFocalPoint(delta.focalPoint);
+            renderer->GetActiveCamera()->SetViewUp(delta.viewUp);
+            renderer->ResetCameraClippingRange();
+            break;
+        case SceneDelta::Type::Render:
+            break;
         }
-        else {
-            QMessageBox::information(this, tr("Search Result"), tr("Item not found."));
+    }
+
+    if (partsChanged) {
+        QList<ModelPart*> parts = renderedPartList();
+        governor->setParts(parts);
+        statistics->setParts(parts);
+    }
+    if (!deltas.isEmpty()) {
+        picker->invalidate();
+    }
+    QList<ModelPart*> moved;
+    partList->getRootItem()->updateWorldTransforms(&moved);
+    if (!moved.isEmpty()) {
+        partList->refreshAggregates(moved); // Their world bounds changed
+    }
+    if (vrThread) {
+        QList<SceneDelta> shared = deltas;
+        for (ModelPart* part : moved) {
+            shared.append(transformDelta(part));
+        }
+        vrThread->enqueue(shared);
+    }
+    renderWindow->Render();
+}
+
+/**
+ * @brief Slot triggered to open the resource residency dashboard.
+ *
+ * The dashboard is modeless so that it keeps updating while parts are shown and hidden.
+ */
+void MainWindow::on_actionResidency_triggered() {
+    ResidencyDialog* dialog = new ResidencyDialog(residency, this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->show();
+}
+
+/**
+ * @brief Slot triggered to filter and sort the parts tree by part attributes.
+ *
+ * The dialog keeps its settings between uses. Matching parts are shown with their ancestors;
+ * the number of matches is reported in the status bar.
+ */
+void MainWindow::on_actionFilterParts_triggered() {
+    if (!filterDialog) {
+        filterDialog = new PartFilterDialog(this);
+    }
+    if (filterDialog->exec() != QDialog::Accepted) {
+        return;
+    }
+
+    partFilter->setConditions(filterDialog->conditions());
+    partFilter->setSortKey(filterDialog->sortKey(), filterDialog->sortOrder());
+    if (partFilter->filterActive()) {
+        ui->treeView->expandAll();
+        emit statusUpdateMessage(tr("%n part(s) match the filter", nullptr, partFilter->matchCount()), 5000);
+    }
+    else {
+        emit statusUpdateMessage(tr("Filter cleared"), 3000);
+    }
+}
+
+/**
+ * @brief Slot triggered to show or hide the subtree statistics columns of the parts tree.
+ *
+ * @param checked True to show the columns.
+ */
+void MainWindow::on_actionStatisticsColumns_toggled(bool checked) {
+    for (int column = ModelPartList::FirstStatisticsColumn; column < ModelPartList::ColumnCount; ++column) {
+        ui->treeView->setColumnHidden(column, !checked);
+    }
+}
+
+/**
+ * @brief Slot triggered to fit the main view's camera to the selected parts and their children.
+ *
+ * The bounds come from the subtree aggregates kept by the model, so fitting a large group does
+ * not visit its parts. The camera keeps its viewing direction.
+ */
+void MainWindow::on_actionZoomToSelection_triggered() {
+    vtkBoundingBox box;
+    for (ModelPart* part : selectedParts()) {
+        vtkBoundingBox partBox = partList->subtreeBounds(part);
+        if (partBox.IsValid()) {
+            box.AddBox(partBox);
+        }
+        if (OctreeStreamer* streamer = streamers.value(part->id())) {
+            double streamed[6];
+            streamer->bounds(streamed);
+            box.AddBounds(streamed);
+        }
+    }
+    if (!box.IsValid()) {
+        emit statusUpdateMessage(tr("The selection has no geometry to zoom to."), 3000);
+        return;
+    }
+
+    double bounds[6];
+    box.GetBounds(bounds);
+    renderer->ResetCamera(bounds);
+    renderer->ResetCameraClippingRange();
+    sceneQueue->enqueue(SceneDelta());
+}
+
+/**
+ * @brief Returns the part shown at an index of the tree view.
+ *
+ * The tree view shows the parts through the filter proxy, so its indices must be mapped back to
+ * the model before their parts are read.
+ *
+ * @param index An index of the tree view's model.
+ * @return The part, or nullptr for an invalid index.
+ */
+ModelPart* MainWindow::partForIndex(const QModelIndex& index) const {
+    return partFilter->partForIndex(index);
+}
+
+/**
+ * @brief Returns the tree view index of a part.
+ *
+ * @param part The part to locate.
+ * @return The index, or an invalid index if the part is filtered out.
+ */
+QModelIndex MainWindow::viewIndexForPart(ModelPart* part) {
+    return partFilter->indexForPart(part);
+}
+
+/**
+ * @brief Selects the tree row of a part clicked in the 3D view.
+ *
+ * @param part The part that was clicked.
+ * @param extendSelection True to add the row to, or remove it from, the current selection instead of replacing it.
+ */
+void MainWindow::handlePartPicked(ModelPart* part, bool extendSelection) {
+    QModelIndex index = viewIndexForPart(part);
+    if (!index.isValid())
+        return;
+
+    if (extendSelection) {
+        ui->treeView->selectionModel()->setCurrentIndex(index, QItemSelectionModel::Toggle | QItemSelectionModel::Rows);
+        ui->treeView->scrollTo(index);
+    }
+    else {
+        selectItemInTreeView(index);
+    }
+    emit statusUpdateMessage("The selected item is: " + part->name(), 2000);
+}
+
+/**
+ * @brief Switches between a single view and split layouts of two or four views.
+ *
+ * Every viewport is a renderer in the same render window, so all of them draw from the
+ * one OpenGL context and share each mapper's buffers: adding views adds draw calls but no
+ * geometry uploads. Each view keeps its own camera and is culled independently. The main
+ * perspective view takes the right half with two views and the bottom-right quarter with four,
+ * next to the front view, or the top, front and side views.
+ *
+ * @param views The number of viewports to show: 1, 2 or 4.
+ */
+void MainWindow::setViewLayout(int views) {
+    static const double twoViews[2][4] = { { 0.5, 0.0, 1.0, 1.0 }, { 0.0, 0.0, 0.5, 1.0 } };
+    static const double fourViews[4][4] = {
+        { 0.5, 0.0, 1.0, 0.5 }, // Perspective
+        { 0.0, 0.5, 0.5, 1.0 }, // Top
+        { 0.5, 0.5, 1.0, 1.0 }, // Front
+        { 0.0, 0.0, 0.5, 0.5 }  // Side
+    };
+
+    views = views >= 4 ? 4 : (views >= 2 ? 2 : 1);
+    for (int i = 1; i < viewRenderers.size(); ++i) {
+        renderWindow->RemoveRenderer(viewRenderers[i]);
+    }
+
+    if (views == 1) {
+        renderer->SetViewport(0.0, 0.0, 1.0, 1.0);
+    }
+    else if (views == 2) {
+        renderer->SetViewport(twoViews[0][0], twoViews[0][1], twoViews[0][2], twoViews[0][3]);
+        viewRenderers[2]->SetViewport(twoViews[1][0], twoViews[1][1], twoViews[1][2], twoViews[1][3]);
+        renderWindow->AddRenderer(viewRenderers[2]);
+        viewRenderers[2]->ResetCamera();
+    }
+    else {
+        for (int i = 0; i < 4; ++i) {
+            viewRenderers[i]->SetViewport(fourViews[i][0], fourViews[i][1], fourViews[i][2], fourViews[i][3]);
+            if (i > 0) {
+                renderWindow->AddRenderer(viewRenderers[i]);
+                viewRenderers[i]->ResetCamera();
+            }
         }
     }
+
+    viewCount = views;
+    picker->invalidate();
+    sceneQueue->enqueue(SceneDelta());
 }
 
-QModelIndex MainWindow::searchInTreeView(const QString& searchString, const QModelIndex& parentIndex) {
-    for (int r = 0; r < partList->rowCount(parentIndex); ++r) {
-        QModelIndex index = partList->index(r, 0, parentIndex); // Assuming the name is in the first column
-        QString itemText = partList->data(index, Qt::DisplayRole).toString();
+/**
+ * @brief Slot triggered to switch translucent parts between weighted blended OIT and depth peeling.
+ *
+ * @param checked True to use depth peeling in every view.
+ */
+void MainWindow::on_actionDepthPeeling_toggled(bool checked) {
+    depthPeeling = checked;
+    for (vtkRenderer* view : viewRenderers) {
+        setupTransparency(view);
+    }
+    sceneQueue->enqueue(SceneDelta());
+}
 
-        if (itemText.contains(searchString, Qt::CaseInsensitive)) {
-            return index; // Item found
+/**
+ * @brief Gives every part loaded from a file the mesh with baked ambient occlusion.
+ *
+ * Parts whose mesh is currently released pick the new mesh up from the GeometryCache when
+ * they are restored.
+ *
+ * @param fileName The source file that was baked.
+ * @param mesh The mesh carrying the occlusion array.
+ */
+void MainWindow::applyAmbientOcclusion(const QString& fileName, vtkSmartPointer<vtkPolyData> mesh) {
+    for (ModelPart* part : renderedPartList()) {
+        if (part->sourceFile() == fileName && part->geometryResident()) {
+            part->restoreGeometry(mesh);
+            partList->refreshAttributes(part);
+            if (vrThread) {
+                vrThread->enqueue(describePart(part));
+            }
         }
+    }
+    sceneQueue->enqueue(SceneDelta());
+    emit statusUpdateMessage(QString("Ambient occlusion baked for %1").arg(QFileInfo(fileName).fileName()), 3000);
+}
 
-        // Search in child nodes
-        QModelIndex childResult = searchInTreeView(searchString, index);
-        if (childResult.isValid()) {
-            return childResult; // Item found in children
+/**
+ * @brief Describes a part as the scene deltas that add it, style it and place it.
+ *
+ * The AddPart delta carries a shallow copy of the part's mesh for each detail level, made here on
+ * the GUI thread with its bounds already computed. The copies share the point and cell arrays but
+ * are separate data objects, so a view on another thread can attach them to its own mappers and
+ * run their pipelines without touching the meshes the GUI thread draws. Parts whose mesh has been
+ * released are described without the AddPart delta.
+ *
+ * @param part The part to describe; must have an actor.
+ * @return The AddPart, UpdatePart and SetTransform deltas, in that order.
+ */
+QList<SceneDelta> MainWindow::describePart(ModelPart* part) const {
+    QList<SceneDelta> deltas;
+    if (part->geometryResident()) {
+        SceneDelta addition;
+        addition.type = SceneDelta::Type::AddPart;
+        addition.partId = part->id();
+        addition.actor = part->getActor();
+        for (int level = 0; level < ModelPart::DetailLevelCount; ++level) {
+            vtkPolyData* mesh = part->levelGeometry(static_cast<ModelPart::DetailLevel>(level));
+            vtkSmartPointer<vtkPolyData> copy;
+            if (mesh) {
+                copy = vtkSmartPointer<vtkPolyData>::New();
+                copy->ShallowCopy(mesh);
+                copy->GetBounds();
+            }
+            addition.geometry.append(copy);
         }
+        deltas.append(addition);
     }
 
-    return QModelIndex(); // Not found
+    SceneDelta update;
+    update.type = SceneDelta::Type::UpdatePart;
+    update.partId = part->id();
+    update.actor = part->getActor();
+    update.visible = part->visible();
+    update.colour = part->getColor();
+    update.opacity = part->opacity();
+    deltas.append(update);
+
+    deltas.append(transformDelta(part));
+    return deltas;
 }
 
-void MainWindow::selectItemInTreeView(const QModelIndex& index) {
-    ui->treeView->setCurrentIndex(index);
-    ui->treeView->scrollTo(index);
-    ui->treeView->selectionModel()->select(index, QItemSelectionModel::Select | QItemSelectionModel::Rows);
+/**
+ * @brief Describes a part's current world matrix as a SetTransform delta.
+ *
+ * The matrix is copied so that the delta stays valid when the part moves again.
+ *
+ * @param part The part to describe; must have an actor.
+ * @return The SetTransform delta.
+ */
+SceneDelta MainWindow::transformDelta(ModelPart* part) const {
+    SceneDelta transform;
+    transform.type = SceneDelta::Type::SetTransform;
+    transform.partId = part->id();
+    transform.actor = part->getActor();
+    if (vtkMatrix4x4* world = part->worldMatrix()) {
+        transform.matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+        transform.matrix->DeepCopy(world);
+    }
+    return transform;
+}
+
+/**
+ * @brief Starts a VR session showing the current scene, ending any session already running.
+ *
+ * The session is seeded with every rendered part and then follows the scene through the
+ * batches broadcast by applySceneDeltas().
+ *
+ * @param target Where the session renders to.
+ */
+void MainWindow::startVRSession(VRRenderThread::Target target) {
+    stopVRSession();
+
+    vrThread = new VRRenderThread(target, this);
+    connect(vrThread, &VRRenderThread::statisticsUpdated, this, [this](double average, double worst, int culled) {
+        emit statusUpdateMessage(QString("VR: %1 ms average, %2 ms worst, %3 parts culled")
+            .arg(average, 0, 'f', 1).arg(worst, 0, 'f', 1).arg(culled), 2000);
+        });
+    connect(vrThread, &VRRenderThread::sessionFailed, this, [this](const QString& reason) {
+        ui->actionVR_Session->setChecked(false);
+        ui->actionVR_Offscreen_Session->setChecked(false);
+        QMessageBox::warning(this, tr("VR Session"), reason);
+        });
+
+    QList<SceneDelta> scene;
+    for (ModelPart* part : renderedPartList()) {
+        scene.append(describePart(part));
+    }
+    SceneDelta camera;
+    camera.type = SceneDelta::Type::ResetCamera;
+    scene.append(camera);
+    vrThread->enqueue(scene);
+    vrThread->start();
+}
+
+/**
+ * @brief Ends the running VR session, if any, and waits for its window to close.
+ */
+void MainWindow::stopVRSession() {
+    if (!vrThread)
+        return;
+
+    vrThread->stop();
+    vrThread->wait();
+    delete vrThread;
+    vrThread = nullptr;
+}
+
+/**
+ * @brief Slot triggered to start or end a VR session on the headset.
+ *
+ * @param checked True to start the session.
+ */
+void MainWindow::on_actionVRSession_toggled(bool checked) {
+    if (checked) {
+        ui->actionVR_Offscreen_Session->setChecked(false);
+        startVRSession(VRRenderThread::Target::Headset);
+    }
+    else if (vrThread && vrThread->target() == VRRenderThread::Target::Headset) {
+        stopVRSession();
+    }
+}
+
+/**
+ * @brief Slot triggered to start or end a VR session in the offscreen stereo stand-in window.
+ *
+ * The stand-in renders both eyes at headset resolution as fast as it can, and reports its
+ * frame times in the status bar, so the scene can be profiled against the VR budget without
+ * a headset.
+ *
+ * @param checked True to start the session.
+ */
+void MainWindow::on_actionVROffscreenSession_toggled(bool checked) {
+    if (checked) {
+        ui->actionVR_Session->setChecked(false);
+        startVRSession(VRRenderThread::Target::OffscreenStereo);
+    }
+    else if (vrThread && vrThread->target() == VRRenderThread::Target::OffscreenStereo) {
+        stopVRSession();
+    }
 }
 
 void MainWindow::addFloor() {
@@ -498,24 +1561,20 @@ void MainWindow::addFloor() {
 
     double scale = 500.0; // Adjust the scale as needed
 
-    vtkSmartPointer<vtkTransform> transform = vtkSmartPointer<vtkTransform>::New();
-    transform->Translate(50.0, 50.0, -10.0); // Adjust positioning if needed
-    transform->RotateX(0); // Rotating 90 degrees around the X-axis
-    transform->Scale(scale, scale, 1); // Scaling the plane
-
-    vtkSmartPointer<vtkTransformPolyDataFilter> transformFilter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
-    transformFilter->SetInputConnection(planeSource->GetOutputPort());
-    transformFilter->SetTransform(transform);
-    transformFilter->Update();
-
     vtkSmartPointer<vtkPolyDataMapper> mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
-    mapper->SetInputConnection(transformFilter->GetOutputPort());
+    mapper->SetInputConnection(planeSource->GetOutputPort());
 
+    // Position the plane with the actor's matrix rather than transforming its points
     vtkSmartPointer<vtkActor> actor = vtkSmartPointer<vtkActor>::New();
     actor->SetMapper(mapper);
+    actor->SetPosition(50.0, 50.0, -10.0); // Adjust positioning if needed
+    actor->SetScale(scale, scale, 1); // Scaling the plane
     actor->GetProperty()->SetColor(0.8, 0.8, 0.8); // Set the floor color
 
-    renderer->AddActor(actor);
+    floorActor = actor;
+    for (vtkRenderer* view : viewRenderers) {
+        view->AddActor(actor);
+    }
 }
 
 
@@ -18,6 +18,18 @@
 #include "ModelPartList.h" 
 #include "ModelPart.h" 
 #include "NewGroupDialog.h"
+#include "InteractionGovernor.h"
+#include "RenderStatistics.h"
+#include "SceneDeltaQueue.h"
+#include "ResidencyManager.h"
+#include "PartPicker.h"
+#include "VRRenderThread.h"
+#include "AmbientOcclusionBaker.h"
+#include "OctreeStreamer.h"
+#include "PartFilterProxy.h"
+#include "partfilterdialog.h"
+#include "PropertyTransaction.h"
+#include "EditJournal.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -41,8 +53,7 @@ public:
 
     void updateRender();
     void updateRenderFromTree(const QModelIndex& index);
-    void applyPropertiesToPart(ModelPart* part, const QString& name, bool visibility, const QColor& color, bool updateName = true);
-    void updateChildrenProperties(ModelPart* part, bool visibility, const QColor& color);
+    void commitProperties(const PropertyTransaction& transaction);
     void initializePartList();
     void setupTreeView();
     void setupActions();
@@ -50,8 +61,17 @@ public:
     void connectSignals();
     void addModelPartToTree();
     void createAction(QAction** action, const QString& text, void (MainWindow::* slot)());
-    QModelIndex searchInTreeView(const QString& searchString, const QModelIndex& parentIndex);
+    void addSecondaryView(const double direction[3], const double viewUp[3]);
+    void setupTransparency(vtkRenderer* view);
+    void selectMatch(int match);
+    ModelPart* partForIndex(const QModelIndex& index) const;
+    QModelIndex viewIndexForPart(ModelPart* part);
     void selectItemInTreeView(const QModelIndex& index);
+    RenderStatistics* renderStatistics();
+    QList<SceneDelta> describePart(ModelPart* part) const;
+    SceneDelta transformDelta(ModelPart* part) const;
+    void startVRSession(VRRenderThread::Target target);
+    void stopVRSession();
 signals:
     void statusUpdateMessage(const QString& message, int timeout);
 
@@ -62,16 +82,62 @@ public slots:
     void on_actionNewGroup_triggered();
     void on_actionDeleteFile_triggered();
     void createModelPartFromFile(const QString& fileName);
-    void removeActorsRecursively(ModelPart* part);
+    void insertPendingParts();
+    void openOctree(const QString& fileName);
+    void removeActors(const QList<ModelPart*>& parts);
+    void addActors(const QList<ModelPart*>& parts);
+    QList<ModelPart*> renderedPartList() const;
+    int detachParts(std::vector<EditJournal::Placement>& placements);
+    void attachParts(std::vector<EditJournal::Placement>& placements);
+    void on_actionUndo_triggered();
+    void on_actionRedo_triggered();
+    void applyJournalEntry(EditJournal::Entry& entry, bool redo);
+    void updateUndoActions();
+    QList<ModelPart*> selectedParts();
     void on_actionSearchItem_triggered();
+    void searchParts(const QString& text);
+    void on_actionFindNext_triggered();
+    void on_actionFindPrevious_triggered();
     void addFloor();
+    void on_actionPerformanceOverlay_toggled(bool checked);
+    void on_actionExportRenderStatistics_triggered();
+    void on_actionExportScene_triggered();
+    void applySceneDeltas(const QList<SceneDelta>& deltas);
+    void on_actionResidency_triggered();
+    void on_actionFilterParts_triggered();
+    void on_actionStatisticsColumns_toggled(bool checked);
+    void on_actionZoomToSelection_triggered();
+    void handlePartPicked(ModelPart* part, bool extendSelection);
+    void setViewLayout(int views);
+    void on_actionDepthPeeling_toggled(bool checked);
+    void on_actionVRSession_toggled(bool checked);
+    void on_actionVROffscreenSession_toggled(bool checked);
+    void applyAmbientOcclusion(const QString& fileName, vtkSmartPointer<vtkPolyData> mesh);
 
 private:
     Ui::MainWindow* ui; ///< User interface for the main window.
     ModelPartList* partList; ///< List of model parts displayed in the tree view.
-    vtkSmartPointer<vtkRenderer> renderer; ///< Renderer for displaying VTK objects.
+    EditJournal* journal; ///< Undo and redo history of edits to the tree.
+    PartFilterProxy* partFilter; ///< Attribute filter and sort between partList and the tree view.
+    PartFilterDialog* filterDialog; ///< Filter settings dialog, created on first use.
+    vtkSmartPointer<vtkRenderer> renderer; ///< Renderer for displaying VTK objects; the main perspective view.
+    QList<vtkSmartPointer<vtkRenderer>> viewRenderers; ///< Renderers of every viewport, main view first, all sharing the scene's actors.
+    int viewCount; ///< Number of viewports currently shown.
+    bool depthPeeling; ///< True to draw translucent parts with depth peeling instead of weighted blended OIT.
     vtkSmartPointer<vtkGenericOpenGLRenderWindow> renderWindow; ///< OpenGL render window for VTK rendering.
     vtkSmartPointer<vtkActor> floorActor;
+    InteractionGovernor* governor; ///< Lowers part detail while the camera is moving.
+    RenderStatistics* statistics; ///< Per-frame render statistics and overlay.
+    SceneDeltaQueue* sceneQueue; ///< Queue through which all scene changes reach the renderer.
+    ResidencyManager* residency; ///< Releases resources of parts that stay hidden.
+    PartPicker* picker; ///< Maps clicks and hovers in the 3D view to parts.
+    VRRenderThread* vrThread; ///< Running VR session mirroring the scene, or nullptr.
+    AmbientOcclusionBaker* occlusionBaker; ///< Bakes ambient occlusion into loaded meshes in the background.
+    QHash<quint64, OctreeStreamer*> streamers; ///< Streamers drawing the octree files in the tree, by part ID.
+    QHash<quint64, QList<ModelPart*>> pendingParts; ///< Loaded parts waiting for insertPendingParts(), by parent ID.
+    QList<quint64> searchMatches; ///< IDs of the parts matching the search box, in index order.
+    int searchCurrent; ///< Position in searchMatches of the selected match, or -1.
+    QList<quint64> renderedParts; ///< IDs of the parts whose actors are currently in the renderer.
     QAction* actionNewGroup; ///< Action to create a new group in the tree view.
     NewGroupDialog* newGroupDialog; ///< Dialog for creating new groups.
     QAction* actionDeleteGroup; ///< Action to delete a selected group.
@@ -25,6 +25,9 @@ OptionDialog::OptionDialog(QWidget* parent)
     ui->setupUi(this);
     ui->checkBox->setChecked(true); // Default checked state
     connect(ui->pushButton, &QPushButton::clicked, this, &OptionDialog::openColorDialog);
+    connect(ui->horizontalSliderOpacity, &QSlider::valueChanged, this, [this](int value) {
+        ui->labelOpacityValue->setText(QString("%1%").arg(value));
+        });
 
 
     // Connect scroll bars to line edits for RGB values
@@ -78,6 +81,15 @@ bool OptionDialog::getVisibility() const {
     return ui->checkBox->isChecked();
 }
 
+/**
+ * @brief Retrieves the opacity from the dialog.
+ *
+ * @return The opacity, from 0 (fully transparent) to 1 (opaque).
+ */
+double OptionDialog::getOpacity() const {
+    return ui->horizontalSliderOpacity->value() / 100.0;
+}
+
 /**
  * @brief Sets the displayed name in the dialog.
  *
@@ -107,6 +119,65 @@ void OptionDialog::setVisibility(bool isVisible) {
     ui->checkBox->setChecked(isVisible);
 }
 
+/**
+ * @brief Sets the opacity shown in the dialog.
+ *
+ * @param opacity The opacity, from 0 (fully transparent) to 1 (opaque).
+ */
+void OptionDialog::setOpacity(double opacity) {
+    ui->horizontalSliderOpacity->setValue(qRound(opacity * 100.0));
+}
+
+/**
+ * @brief Retrieves the position and rotation relative to the parent from the dialog.
+ *
+ * @param position Receives the X, Y and Z translation.
+ * @param orientation Receives the rotation about the X, Y and Z axes in degrees.
+ */
+void OptionDialog::getTransform(double position[3], double orientation[3]) const {
+    position[0] = ui->doubleSpinBoxPositionX->value();
+    position[1] = ui->doubleSpinBoxPositionY->value();
+    position[2] = ui->doubleSpinBoxPositionZ->value();
+    orientation[0] = ui->doubleSpinBoxRotationX->value();
+    orientation[1] = ui->doubleSpinBoxRotationY->value();
+    orientation[2] = ui->doubleSpinBoxRotationZ->value();
+}
+
+/**
+ * @brief Sets the position and rotation relative to the parent shown in the dialog.
+ *
+ * @param position The X, Y and Z translation.
+ * @param orientation The rotation about the X, Y and Z axes in degrees.
+ */
+void OptionDialog::setTransform(const double position[3], const double orientation[3]) {
+    ui->doubleSpinBoxPositionX->setValue(position[0]);
+    ui->doubleSpinBoxPositionY->setValue(position[1]);
+    ui->doubleSpinBoxPositionZ->setValue(position[2]);
+    ui->doubleSpinBoxRotationX->setValue(orientation[0]);
+    ui->doubleSpinBoxRotationY->setValue(orientation[1]);
+    ui->doubleSpinBoxRotationZ->setValue(orientation[2]);
+}
+
+/**
+ * @brief Switches the dialog to editing several parts at once.
+ *
+ * Names and transforms belong to a single part, so their fields are disabled; the visibility,
+ * colour and opacity are applied to every selected part.
+ *
+ * @param count The number of selected parts.
+ */
+void OptionDialog::setMultipleSelection(int count) {
+    setWindowTitle(tr("Edit %n Parts", nullptr, count));
+    ui->plainTextEdit->setPlainText(tr("%n parts selected", nullptr, count));
+    ui->plainTextEdit->setEnabled(false);
+    ui->doubleSpinBoxPositionX->setEnabled(false);
+    ui->doubleSpinBoxPositionY->setEnabled(false);
+    ui->doubleSpinBoxPositionZ->setEnabled(false);
+    ui->doubleSpinBoxRotationX->setEnabled(false);
+    ui->doubleSpinBoxRotationY->setEnabled(false);
+    ui->doubleSpinBoxRotationZ->setEnabled(false);
+}
+
 /**
  * @brief Sets up connections between UI elements for real-time updates of color values.
  */
@@ -35,10 +35,15 @@ public:
     QString getName() const; ///< Retrieves the item's name from the dialog.
     QColor getColor() const; ///< Retrieves the selected color from the dialog.
     bool getVisibility() const; ///< Checks the visibility status from the dialog.
+    double getOpacity() const; ///< Retrieves the opacity from the dialog, from 0 to 1.
 
     void setName(const QString& name); ///< Sets the item's name in the dialog.
     void setColor(const QColor& color); ///< Updates the color displayed in the dialog.
     void setVisibility(bool isVisible); ///< Sets the visibility status in the dialog.
+    void setOpacity(double opacity); ///< Sets the opacity shown in the dialog, from 0 to 1.
+    void getTransform(double position[3], double orientation[3]) const; ///< Retrieves the position and rotation from the dialog.
+    void setTransform(const double position[3], const double orientation[3]); ///< Sets the position and rotation shown in the dialog.
+    void setMultipleSelection(int count); ///< Disables the per-part name and transform fields when editing several parts.
 
 private:
     Ui::OptionDialog* ui; ///< Pointer to the user interface elements of the dialog.
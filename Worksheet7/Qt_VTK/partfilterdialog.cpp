@@ -0,0 +1,83 @@
+/**
+ * @file partfilterdialog.cpp
+ * @brief Implementation of the PartFilterDialog class.
+ */
+
+#include "partfilterdialog.h"
+#include "ui_partfilterdialog.h"
+#include <QPushButton>
+
+ /**
+  * @brief Constructs the dialog with no filter selected.
+  *
+  * @param parent The parent widget of this dialog, nullptr if there's no parent.
+  */
+PartFilterDialog::PartFilterDialog(QWidget* parent)
+    : QDialog(parent), ui(new Ui::PartFilterDialog) {
+    ui->setupUi(this);
+
+    connect(ui->trianglesCheckBox, &QCheckBox::toggled, ui->trianglesSpinBox, &QWidget::setEnabled);
+    connect(ui->memoryCheckBox, &QCheckBox::toggled, ui->memorySpinBox, &QWidget::setEnabled);
+    connect(ui->boundsCheckBox, &QCheckBox::toggled, ui->boundsSpinBox, &QWidget::setEnabled);
+    connect(ui->buttonBox->button(QDialogButtonBox::Reset), &QPushButton::clicked, this, &PartFilterDialog::reset);
+}
+
+/**
+ * @brief Destroys the PartFilterDialog object.
+ */
+PartFilterDialog::~PartFilterDialog() {
+    delete ui;
+}
+
+/**
+ * @brief Builds the filter conditions from the enabled controls.
+ *
+ * @return The conditions, empty if no control restricts the parts.
+ */
+QList<PartAttributeStore::Condition> PartFilterDialog::conditions() const {
+    using Attribute = PartAttributeStore::Attribute;
+    using Comparison = PartAttributeStore::Comparison;
+
+    QList<PartAttributeStore::Condition> result;
+    if (ui->trianglesCheckBox->isChecked())
+        result.append({ Attribute::Triangles, Comparison::GreaterEqual, double(ui->trianglesSpinBox->value()) });
+    if (ui->memoryCheckBox->isChecked())
+        result.append({ Attribute::Memory, Comparison::GreaterEqual, ui->memorySpinBox->value() * 1024.0 * 1024.0 });
+    if (ui->boundsCheckBox->isChecked())
+        result.append({ Attribute::BoundsSize, Comparison::GreaterEqual, ui->boundsSpinBox->value() });
+    if (ui->visibilityComboBox->currentIndex() > 0)
+        result.append({ Attribute::Visible, Comparison::Equal, ui->visibilityComboBox->currentIndex() == 1 ? 1.0 : 0.0 });
+    if (ui->loadStateComboBox->currentIndex() > 0) {
+        // The combo box entries follow PartAttributeStore::LoadState, after "Any"
+        result.append({ Attribute::LoadState, Comparison::Equal, double(ui->loadStateComboBox->currentIndex() - 1) });
+    }
+    return result;
+}
+
+/**
+ * @brief Returns the sort key chosen in the dialog.
+ */
+PartFilterProxy::SortKey PartFilterDialog::sortKey() const {
+    // The combo box entries follow PartFilterProxy::SortKey
+    return static_cast<PartFilterProxy::SortKey>(ui->sortComboBox->currentIndex());
+}
+
+/**
+ * @brief Returns the sort direction chosen in the dialog.
+ */
+Qt::SortOrder PartFilterDialog::sortOrder() const {
+    return ui->descendingCheckBox->isChecked() ? Qt::DescendingOrder : Qt::AscendingOrder;
+}
+
+/**
+ * @brief Clears every control back to no filter and tree order.
+ */
+void PartFilterDialog::reset() {
+    ui->trianglesCheckBox->setChecked(false);
+    ui->memoryCheckBox->setChecked(false);
+    ui->boundsCheckBox->setChecked(false);
+    ui->visibilityComboBox->setCurrentIndex(0);
+    ui->loadStateComboBox->setCurrentIndex(0);
+    ui->sortComboBox->setCurrentIndex(0);
+    ui->descendingCheckBox->setChecked(false);
+}
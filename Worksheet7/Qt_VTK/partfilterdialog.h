@@ -0,0 +1,45 @@
+/**
+ * @file PartFilterDialog.h
+ *
+ * Defines the PartFilterDialog class, which lets the user build an attribute filter and choose a
+ * sort order for the parts tree.
+ */
+
+#ifndef PARTFILTERDIALOG_H
+#define PARTFILTERDIALOG_H
+
+#include <QDialog>
+#include "PartAttributeStore.h"
+#include "PartFilterProxy.h"
+
+namespace Ui {
+    class PartFilterDialog;
+}
+
+/**
+ * @class PartFilterDialog
+ * @brief Dialog for filtering and sorting the parts tree by triangle count, memory, size,
+ * visibility and mesh residency.
+ *
+ * Each enabled control becomes one condition; the conditions are combined with AND. Reset clears
+ * every control back to no filter and tree order.
+ */
+class PartFilterDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit PartFilterDialog(QWidget* parent = nullptr);
+    ~PartFilterDialog();
+
+    QList<PartAttributeStore::Condition> conditions() const; ///< Builds the filter from the enabled controls.
+    PartFilterProxy::SortKey sortKey() const; ///< Returns the chosen sort key.
+    Qt::SortOrder sortOrder() const; ///< Returns the chosen sort direction.
+
+private:
+    Ui::PartFilterDialog* ui; ///< Pointer to the user interface elements of the dialog.
+
+    void reset(); ///< Clears every control back to no filter and tree order.
+};
+
+#endif // PARTFILTERDIALOG_H
@@ -0,0 +1,84 @@
+/**
+ * @file residencydialog.cpp
+ * @brief Implementation of the ResidencyDialog class.
+ *
+ * Fills the residency table from the ResidencyManager and keeps the policy controls in sync with it.
+ */
+
+#include "residencydialog.h"
+#include "ui_residencydialog.h"
+#include <QTableWidgetItem>
+
+ /**
+  * @brief Constructs the dashboard for the given residency manager.
+  *
+  * @param manager The residency manager to show and configure.
+  * @param parent The parent widget of this dialog, nullptr if there's no parent.
+  */
+ResidencyDialog::ResidencyDialog(ResidencyManager* manager, QWidget* parent)
+    : QDialog(parent), ui(new Ui::ResidencyDialog), manager(manager) {
+    ui->setupUi(this);
+
+    ResidencyPolicy policy = manager->policy();
+    ui->gpuDelaySpinBox->setValue(policy.gpuReleaseDelay / 1000);
+    ui->releaseCpuCheckBox->setChecked(policy.releaseCpuGeometry);
+    ui->cpuDelaySpinBox->setValue(policy.cpuReleaseDelay / 1000);
+    ui->cpuDelaySpinBox->setEnabled(policy.releaseCpuGeometry);
+
+    connect(ui->gpuDelaySpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, &ResidencyDialog::applyPolicy);
+    connect(ui->cpuDelaySpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, &ResidencyDialog::applyPolicy);
+    connect(ui->releaseCpuCheckBox, &QCheckBox::toggled, this, [this](bool checked) {
+        ui->cpuDelaySpinBox->setEnabled(checked);
+        applyPolicy();
+        });
+
+    refreshTimer.setInterval(1000);
+    connect(&refreshTimer, &QTimer::timeout, this, &ResidencyDialog::refresh);
+    refreshTimer.start();
+    refresh();
+}
+
+/**
+ * @brief Destroys the ResidencyDialog object.
+ */
+ResidencyDialog::~ResidencyDialog() {
+    delete ui;
+}
+
+/**
+ * @brief Rebuilds the table and the totals from the manager's current records.
+ */
+void ResidencyDialog::refresh() {
+    QList<ResidencyManager::Record> records = manager->records();
+    ui->tableWidget->setRowCount(records.size());
+
+    qint64 totalBytes = 0;
+    int gpuHeld = 0;
+    for (int row = 0; row < records.size(); ++row) {
+        const ResidencyManager::Record& record = records[row];
+        totalBytes += record.cpuBytes;
+        if (record.state == ResidencyManager::State::Resident)
+            ++gpuHeld;
+
+        ui->tableWidget->setItem(row, 0, new QTableWidgetItem(record.name));
+        ui->tableWidget->setItem(row, 1, new QTableWidgetItem(ResidencyManager::stateName(record.state)));
+        ui->tableWidget->setItem(row, 2, new QTableWidgetItem(record.hidden ? QString::number(record.hiddenFor / 1000) : QString("-")));
+        ui->tableWidget->setItem(row, 3, new QTableWidgetItem(QString::number(record.cpuBytes / (1024.0 * 1024.0), 'f', 1)));
+    }
+
+    ui->summaryLabel->setText(tr("%1 parts tracked, %2 holding GPU buffers, %3 MB of CPU meshes held")
+        .arg(records.size())
+        .arg(gpuHeld)
+        .arg(totalBytes / (1024.0 * 1024.0), 0, 'f', 1));
+}
+
+/**
+ * @brief Pushes the values of the policy controls to the residency manager.
+ */
+void ResidencyDialog::applyPolicy() {
+    ResidencyPolicy policy;
+    policy.gpuReleaseDelay = ui->gpuDelaySpinBox->value() * 1000;
+    policy.releaseCpuGeometry = ui->releaseCpuCheckBox->isChecked();
+    policy.cpuReleaseDelay = ui->cpuDelaySpinBox->value() * 1000;
+    manager->setPolicy(policy);
+}
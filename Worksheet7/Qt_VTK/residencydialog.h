@@ -0,0 +1,43 @@
+/**
+ * @file ResidencyDialog.h
+ *
+ * Defines the ResidencyDialog class, a dashboard that lists which parts currently hold GPU buffers
+ * and CPU meshes, and lets the user adjust the release policy of the ResidencyManager.
+ */
+
+#ifndef RESIDENCYDIALOG_H
+#define RESIDENCYDIALOG_H
+
+#include <QDialog>
+#include <QTimer>
+#include "ResidencyManager.h"
+
+namespace Ui {
+    class ResidencyDialog;
+}
+
+/**
+ * @class ResidencyDialog
+ * @brief Dashboard showing the residency of every tracked part.
+ *
+ * The table refreshes once a second while the dialog is open. Policy changes are applied to the
+ * ResidencyManager immediately.
+ */
+class ResidencyDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ResidencyDialog(ResidencyManager* manager, QWidget* parent = nullptr);
+    ~ResidencyDialog();
+
+private:
+    Ui::ResidencyDialog* ui; ///< Pointer to the user interface elements of the dialog.
+    ResidencyManager* manager; ///< Manager whose state is shown.
+    QTimer refreshTimer; ///< Drives the periodic table refresh.
+
+    void refresh(); ///< Rebuilds the table and summary from the manager's records.
+    void applyPolicy(); ///< Pushes the policy controls to the manager.
+};
+
+#endif // RESIDENCYDIALOG_H
@@ -0,0 +1,450 @@
+/**
+ * @file stl2octree.cpp
+ * @brief Offline tool that converts an STL mesh of any size into a streamable octree file.
+ *
+ * Usage: stl2octree input.stl output.oct [--chunk triangles] [--memory megabytes]
+ *
+ * The mesh is never held in memory whole. Triangles are streamed from the STL file and split by
+ * the octant of their centroid into temporary files, level by level, until a cell fits the memory
+ * limit; from there the cell is split in memory until each leaf holds at most one chunk of
+ * triangles. On the way back up, each inner node gets a vertex-clustered simplification of its
+ * children's chunks of about one chunk in size, so every node of the file can be drawn on its own
+ * as a level of detail of its cell. The format is described in OctreeFormat.h.
+ */
+
+#include "OctreeFormat.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    using Triangle = std::array<float, 9>; ///< Three corners, xyz each.
+
+    /**
+     * @brief Indexed mesh of one chunk.
+     */
+    struct Chunk {
+        std::vector<float> points; ///< xyz per vertex.
+        std::vector<std::uint32_t> triangles; ///< Three vertex indices per triangle.
+    };
+
+    /**
+     * @brief Axis-aligned cube of octree space.
+     */
+    struct Cell {
+        float origin[3]; ///< Minimum corner.
+        float size; ///< Edge length.
+
+        int octantOf(const Triangle& triangle) const {
+            int octant = 0;
+            for (int axis = 0; axis < 3; ++axis) {
+                float centroid = (triangle[axis] + triangle[3 + axis] + triangle[6 + axis]) / 3.0f;
+                if (centroid >= origin[axis] + size / 2.0f)
+                    octant |= 1 << axis;
+            }
+            return octant;
+        }
+
+        Cell child(int octant) const {
+            Cell cell = { { origin[0], origin[1], origin[2] }, size / 2.0f };
+            for (int axis = 0; axis < 3; ++axis) {
+                if (octant & (1 << axis))
+                    cell.origin[axis] += size / 2.0f;
+            }
+            return cell;
+        }
+    };
+
+    /**
+     * @brief Streams the triangles of a binary or ASCII STL file to a callback.
+     *
+     * @return False if the file cannot be read.
+     */
+    bool forEachTriangle(const std::string& fileName, const std::function<void(const Triangle&)>& visit) {
+        std::ifstream in(fileName, std::ios::binary);
+        if (!in)
+            return false;
+
+        in.seekg(0, std::ios::end);
+        std::uint64_t fileSize = static_cast<std::uint64_t>(in.tellg());
+        in.seekg(0, std::ios::beg);
+
+        char header[80];
+        std::uint32_t count = 0;
+        bool binary = in.read(header, sizeof(header)) && OctreeFormat::readValue(in, count) &&
+            fileSize == 84 + std::uint64_t(count) * 50;
+
+        if (binary) {
+            char record[50];
+            Triangle triangle;
+            for (std::uint32_t i = 0; i < count && in.read(record, sizeof(record)); ++i) {
+                std::memcpy(triangle.data(), record + 12, sizeof(float) * 9); // Skip the facet normal
+                visit(triangle);
+            }
+            return true;
+        }
+
+        in.clear();
+        in.seekg(0, std::ios::beg);
+        std::string line;
+        Triangle triangle;
+        int corner = 0;
+        while (std::getline(in, line)) {
+            std::istringstream words(line);
+            std::string keyword;
+            words >> keyword;
+            if (keyword != "vertex")
+                continue;
+            words >> triangle[corner * 3] >> triangle[corner * 3 + 1] >> triangle[corner * 3 + 2];
+            if (++corner == 3) {
+                visit(triangle);
+                corner = 0;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Builds the octree file from a triangle stream.
+     */
+    class OctreeBuilder {
+    public:
+        OctreeBuilder(std::ostream& out, const std::string& scratchPrefix, std::uint64_t chunkTriangles, std::uint64_t memoryBytes)
+            : out(out), scratchPrefix(scratchPrefix), chunkTriangles(chunkTriangles), memoryTriangles(memoryBytes / sizeof(Triangle)) {
+        }
+
+        /**
+         * @brief Builds the tree below the root cell from a scratch file of triangles.
+         */
+        void build(const std::string& fileName, std::uint64_t count, const Cell& root) {
+            buildFromFile(fileName, count, root, 0);
+        }
+
+        const std::vector<OctreeFormat::Node>& nodes() const { return table; }
+
+    private:
+        static const int MaximumDepth = 21; ///< Cells below this depth are made leaves whatever their size.
+
+        /**
+         * @brief Builds a node from triangles on disk, splitting to disk until they fit in memory.
+         */
+        Chunk buildFromFile(const std::string& fileName, std::uint64_t count, const Cell& cell, int depth) {
+            if (count <= memoryTriangles || depth >= MaximumDepth) {
+                std::vector<Triangle> triangles;
+                triangles.reserve(count);
+                std::ifstream in(fileName, std::ios::binary);
+                Triangle triangle;
+                while (in.read(reinterpret_cast<char*>(triangle.data()), sizeof(Triangle)))
+                    triangles.push_back(triangle);
+                in.close();
+                std::remove(fileName.c_str());
+                return buildFromMemory(triangles, cell, depth);
+            }
+
+            int index = reserveNode();
+            std::string childNames[8];
+            std::uint64_t childCounts[8] = {};
+            {
+                std::ofstream childFiles[8];
+                std::ifstream in(fileName, std::ios::binary);
+                Triangle triangle;
+                while (in.read(reinterpret_cast<char*>(triangle.data()), sizeof(Triangle))) {
+                    int octant = cell.octantOf(triangle);
+                    if (!childFiles[octant].is_open()) {
+                        childNames[octant] = scratchName();
+                        childFiles[octant].open(childNames[octant], std::ios::binary);
+                    }
+                    childFiles[octant].write(reinterpret_cast<const char*>(triangle.data()), sizeof(Triangle));
+                    ++childCounts[octant];
+                }
+            }
+            std::remove(fileName.c_str());
+
+            std::vector<Chunk> children;
+            for (int octant = 0; octant < 8; ++octant) {
+                if (childCounts[octant] == 0)
+                    continue;
+                table[index].children[octant] = static_cast<std::int32_t>(table.size());
+                children.push_back(buildFromFile(childNames[octant], childCounts[octant], cell.child(octant), depth + 1));
+            }
+            return finishInnerNode(index, children, cell);
+        }
+
+        /**
+         * @brief Builds a node from triangles in memory.
+         */
+        Chunk buildFromMemory(std::vector<Triangle>& triangles, const Cell& cell, int depth) {
+            int index = reserveNode();
+            if (triangles.size() <= chunkTriangles || depth >= MaximumDepth) {
+                Chunk chunk = weld(triangles);
+                writeChunk(index, chunk, 0.0f);
+                return chunk;
+            }
+
+            std::vector<Triangle> octants[8];
+            for (const Triangle& triangle : triangles)
+                octants[cell.octantOf(triangle)].push_back(triangle);
+            std::vector<Triangle>().swap(triangles);
+
+            std::vector<Chunk> children;
+            for (int octant = 0; octant < 8; ++octant) {
+                if (octants[octant].empty())
+                    continue;
+                table[index].children[octant] = static_cast<std::int32_t>(table.size());
+                children.push_back(buildFromMemory(octants[octant], cell.child(octant), depth + 1));
+            }
+            return finishInnerNode(index, children, cell);
+        }
+
+        /**
+         * @brief Simplifies the children's chunks into the chunk of an inner node and writes it.
+         *
+         * Vertices are clustered on a grid over the cell; the grid is coarsened until the result
+         * fits in about one chunk. The geometric error is the larger of the children's errors and
+         * the diagonal of a grid cell, the furthest a vertex can move.
+         */
+        Chunk finishInnerNode(int index, const std::vector<Chunk>& children, const Cell& cell) {
+            float childError = 0.0f;
+            for (int octant = 0; octant < 8; ++octant) {
+                if (table[index].children[octant] >= 0)
+                    childError = std::max(childError, table[table[index].children[octant]].geometricError);
+            }
+
+            int resolution = std::max(2, static_cast<int>(std::sqrt(static_cast<double>(chunkTriangles) / 2.0)));
+            Chunk simplified = cluster(children, cell, resolution);
+            while (simplified.triangles.size() / 3 > chunkTriangles * 3 / 2 && resolution > 2) {
+                resolution /= 2;
+                simplified = cluster(children, cell, resolution);
+            }
+
+            float error = std::max(childError, cell.size / resolution * std::sqrt(3.0f));
+            writeChunk(index, simplified, error);
+            return simplified;
+        }
+
+        /**
+         * @brief Vertex clustering of several chunks on a grid of the given resolution over a cell.
+         */
+        static Chunk cluster(const std::vector<Chunk>& inputs, const Cell& cell, int resolution) {
+            struct Accumulator {
+                double sum[3] = {};
+                int count = 0;
+                std::uint32_t index = 0;
+            };
+            std::unordered_map<std::uint64_t, Accumulator> cells;
+            std::vector<std::array<std::uint64_t, 3>> triangleKeys;
+
+            auto keyOf = [&](const float* p) {
+                std::uint64_t key = 0;
+                for (int axis = 0; axis < 3; ++axis) {
+                    int slot = static_cast<int>((p[axis] - cell.origin[axis]) / cell.size * resolution);
+                    slot = std::min(std::max(slot, 0), resolution - 1);
+                    key = key * 2097152u + static_cast<std::uint64_t>(slot);
+                }
+                return key;
+            };
+
+            for (const Chunk& input : inputs) {
+                for (std::size_t t = 0; t + 2 < input.triangles.size(); t += 3) {
+                    std::array<std::uint64_t, 3> keys;
+                    for (int corner = 0; corner < 3; ++corner) {
+                        const float* p = &input.points[input.triangles[t + corner] * 3];
+                        keys[corner] = keyOf(p);
+                        Accumulator& accumulator = cells[keys[corner]];
+                        for (int axis = 0; axis < 3; ++axis)
+                            accumulator.sum[axis] += p[axis];
+                        ++accumulator.count;
+                    }
+                    if (keys[0] != keys[1] && keys[1] != keys[2] && keys[0] != keys[2])
+                        triangleKeys.push_back(keys);
+                }
+            }
+
+            Chunk result;
+            for (auto& entry : cells) {
+                Accumulator& accumulator = entry.second;
+                accumulator.index = static_cast<std::uint32_t>(result.points.size() / 3);
+                for (int axis = 0; axis < 3; ++axis)
+                    result.points.push_back(static_cast<float>(accumulator.sum[axis] / accumulator.count));
+            }
+
+            // Drop triangles that collapsed onto the same three clusters
+            for (auto& keys : triangleKeys) {
+                std::rotate(keys.begin(), std::min_element(keys.begin(), keys.end()), keys.end());
+            }
+            std::sort(triangleKeys.begin(), triangleKeys.end());
+            triangleKeys.erase(std::unique(triangleKeys.begin(), triangleKeys.end()), triangleKeys.end());
+            result.triangles.reserve(triangleKeys.size() * 3);
+            for (const auto& keys : triangleKeys) {
+                for (std::uint64_t key : keys)
+                    result.triangles.push_back(cells[key].index);
+            }
+            return result;
+        }
+
+        /**
+         * @brief Merges coincident corners of a triangle soup into an indexed chunk.
+         */
+        static Chunk weld(const std::vector<Triangle>& triangles) {
+            struct Key {
+                std::uint32_t bits[3];
+                bool operator==(const Key& other) const { return std::memcmp(bits, other.bits, sizeof(bits)) == 0; }
+            };
+            struct KeyHash {
+                std::size_t operator()(const Key& key) const {
+                    return (std::size_t(key.bits[0]) * 73856093u) ^ (std::size_t(key.bits[1]) * 19349663u) ^ (std::size_t(key.bits[2]) * 83492791u);
+                }
+            };
+
+            Chunk chunk;
+            std::unordered_map<Key, std::uint32_t, KeyHash> indices;
+            chunk.triangles.reserve(triangles.size() * 3);
+            for (const Triangle& triangle : triangles) {
+                for (int corner = 0; corner < 3; ++corner) {
+                    Key key;
+                    std::memcpy(key.bits, &triangle[corner * 3], sizeof(key.bits));
+                    auto inserted = indices.emplace(key, static_cast<std::uint32_t>(chunk.points.size() / 3));
+                    if (inserted.second)
+                        chunk.points.insert(chunk.points.end(), &triangle[corner * 3], &triangle[corner * 3] + 3);
+                    chunk.triangles.push_back(inserted.first->second);
+                }
+            }
+            return chunk;
+        }
+
+        int reserveNode() {
+            table.push_back(OctreeFormat::Node());
+            return static_cast<int>(table.size()) - 1;
+        }
+
+        void writeChunk(int index, const Chunk& chunk, float error) {
+            OctreeFormat::Node& node = table[index];
+            node.geometricError = error;
+            node.vertexCount = static_cast<std::uint32_t>(chunk.points.size() / 3);
+            node.triangleCount = static_cast<std::uint32_t>(chunk.triangles.size() / 3);
+            node.dataOffset = static_cast<std::uint64_t>(out.tellp());
+            for (int axis = 0; axis < 3; ++axis) {
+                node.bounds[axis * 2] = 1.0e30f;
+                node.bounds[axis * 2 + 1] = -1.0e30f;
+            }
+            for (std::size_t i = 0; i < chunk.points.size(); ++i) {
+                int axis = static_cast<int>(i % 3);
+                node.bounds[axis * 2] = std::min(node.bounds[axis * 2], chunk.points[i]);
+                node.bounds[axis * 2 + 1] = std::max(node.bounds[axis * 2 + 1], chunk.points[i]);
+            }
+            out.write(reinterpret_cast<const char*>(chunk.points.data()), chunk.points.size() * sizeof(float));
+            out.write(reinterpret_cast<const char*>(chunk.triangles.data()), chunk.triangles.size() * sizeof(std::uint32_t));
+        }
+
+        std::string scratchName() {
+            return scratchPrefix + std::to_string(scratchCounter++) + ".tmp";
+        }
+
+        std::ostream& out; ///< Output file, positioned at the end of the chunk data.
+        std::string scratchPrefix; ///< Path prefix of temporary triangle files.
+        std::uint64_t chunkTriangles; ///< Largest number of triangles in a leaf.
+        std::uint64_t memoryTriangles; ///< Largest number of triangles split in memory.
+        std::vector<OctreeFormat::Node> table; ///< Node table, root first.
+        int scratchCounter = 0; ///< Source of unique temporary file names.
+    };
+}
+
+/**
+ * @brief Entry point of the conversion tool.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The input STL, the output octree file and the optional limits.
+ * @return 0 on success, 1 on a usage or file error.
+ */
+int main(int argc, char* argv[])
+{
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " input.stl output.oct [--chunk triangles] [--memory megabytes]\n";
+        return 1;
+    }
+
+    std::string input = argv[1];
+    std::string output = argv[2];
+    std::uint64_t chunkTriangles = 65536;
+    std::uint64_t memoryMegabytes = 1024;
+    for (int i = 3; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--chunk")
+            chunkTriangles = std::max<std::uint64_t>(64, std::strtoull(argv[i + 1], nullptr, 10));
+        else if (option == "--memory")
+            memoryMegabytes = std::max<std::uint64_t>(1, std::strtoull(argv[i + 1], nullptr, 10));
+    }
+
+    // First pass: bounds, and a flat scratch copy that later passes can read quickly
+    OctreeFormat::Header header;
+    float lower[3] = { 1.0e30f, 1.0e30f, 1.0e30f };
+    float upper[3] = { -1.0e30f, -1.0e30f, -1.0e30f };
+    std::string scratch = output + ".root.tmp";
+    {
+        std::ofstream flat(scratch, std::ios::binary);
+        bool read = forEachTriangle(input, [&](const Triangle& triangle) {
+            for (int corner = 0; corner < 3; ++corner) {
+                for (int axis = 0; axis < 3; ++axis) {
+                    lower[axis] = std::min(lower[axis], triangle[corner * 3 + axis]);
+                    upper[axis] = std::max(upper[axis], triangle[corner * 3 + axis]);
+                }
+            }
+            flat.write(reinterpret_cast<const char*>(triangle.data()), sizeof(Triangle));
+            ++header.triangleCount;
+            });
+        if (!read || !flat) {
+            std::cerr << "Cannot read " << input << " or write scratch files next to " << output << "\n";
+            std::remove(scratch.c_str());
+            return 1;
+        }
+    }
+    if (header.triangleCount == 0) {
+        std::cerr << input << " contains no triangles\n";
+        std::remove(scratch.c_str());
+        return 1;
+    }
+
+    Cell root = { { lower[0], lower[1], lower[2] }, 0.0f };
+    for (int axis = 0; axis < 3; ++axis) {
+        header.bounds[axis * 2] = lower[axis];
+        header.bounds[axis * 2 + 1] = upper[axis];
+        root.size = std::max(root.size, upper[axis] - lower[axis]);
+    }
+    root.size = std::max(root.size * 1.0001f, 1.0e-6f); // Keep the maximum corner inside the last octant
+
+    std::ofstream out(output, std::ios::binary);
+    if (!out) {
+        std::cerr << "Cannot write " << output << "\n";
+        std::remove(scratch.c_str());
+        return 1;
+    }
+    OctreeFormat::writeHeader(out, header); // Rewritten once the table offset is known
+
+    OctreeBuilder builder(out, output + ".", chunkTriangles, memoryMegabytes * 1024 * 1024);
+    builder.build(scratch, header.triangleCount, root);
+
+    header.nodeCount = static_cast<std::uint32_t>(builder.nodes().size());
+    header.tableOffset = static_cast<std::uint64_t>(out.tellp());
+    for (const OctreeFormat::Node& node : builder.nodes())
+        OctreeFormat::writeNode(out, node);
+    out.seekp(0);
+    OctreeFormat::writeHeader(out, header);
+    if (!out) {
+        std::cerr << "Error writing " << output << "\n";
+        return 1;
+    }
+
+    std::cout << header.triangleCount << " triangles written as " << header.nodeCount << " nodes to " << output << "\n";
+    return 0;
+}
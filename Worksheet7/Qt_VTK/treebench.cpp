@@ -0,0 +1,251 @@
+/**
+ * @file treebench.cpp
+ * @brief Headless benchmark of the parts tree on flat and deep trees.
+ *
+ * Usage: treebench [parts]
+ *
+ * Builds a flat tree, one group holding every part, and a deep tree, a chain in which every part
+ * is the only child of the one before, each of one million parts unless another size is given.
+ * Each tree is timed as it is built, traversed and destroyed, which shows the cost of allocating
+ * parts from the NodePool and of releasing its arenas. Each tree is then rebuilt and inserted into
+ * a ModelPartList with every row fetched, and the benchmark times the row(), index() and parent()
+ * lookups views make for every part, which are constant time however wide or deep the tree is.
+ *
+ * Last, a tree of groups of a thousand parts is walked with SceneSnapshot::parallelForEach() on
+ * a reader thread, round after round, while the main thread renames, moves, adds and removes
+ * parts as the GUI thread would. Each walk must visit exactly the parts its snapshot held. Build
+ * with ENABLE_TSAN to check the snapshot scheme under ThreadSanitizer.
+ */
+
+#include "ModelPart.h"
+#include "ModelPartList.h"
+#include "NodePool.h"
+#include "SceneSnapshot.h"
+#include <QCoreApplication>
+#include <QModelIndex>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+    /**
+     * @brief Runs one step and prints how long it took.
+     *
+     * @param shape The tree the step runs on.
+     * @param label What the step does.
+     * @param step The work to time.
+     */
+    template <typename Step>
+    void timed(const char* shape, const char* label, Step step) {
+        auto start = std::chrono::steady_clock::now();
+        step();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::printf("%-5s %-24s %10.1f ms\n", shape, label, elapsed.count());
+    }
+
+    /**
+     * @brief Builds a group holding the given number of parts as its children.
+     */
+    ModelPart* buildFlat(int parts) {
+        QList<ModelPart*> children;
+        children.reserve(parts);
+        for (int i = 0; i < parts; ++i)
+            children.append(new ModelPart(QStringLiteral("Part")));
+        ModelPart* group = new ModelPart(QStringLiteral("Group"));
+        group->insertChildren(0, children);
+        return group;
+    }
+
+    /**
+     * @brief Builds a chain of the given number of parts, each the only child of the one before.
+     */
+    ModelPart* buildDeep(int parts) {
+        ModelPart* top = new ModelPart(QStringLiteral("Part"));
+        ModelPart* last = top;
+        for (int i = 1; i < parts; ++i) {
+            ModelPart* next = new ModelPart(QStringLiteral("Part"));
+            last->appendChild(next);
+            last = next;
+        }
+        return top;
+    }
+
+    /**
+     * @brief Times building, traversing and destroying a tree on its own.
+     *
+     * @param shape Name of the tree's shape, for the report.
+     * @param build Builds the tree of the given number of parts.
+     * @param parts Number of parts in the tree.
+     */
+    void benchmarkLifecycle(const char* shape, ModelPart* (*build)(int), int parts) {
+        ModelPart* top = nullptr;
+        timed(shape, "build", [&] {
+            top = build(parts);
+        });
+        std::printf("%-5s %-24s %10d\n", shape, "arenas in use", ModelPart::pool().arenaCount());
+
+        long long visited = 0;
+        timed(shape, "traverse", [&] {
+            std::vector<ModelPart*> stack{ top };
+            while (!stack.empty()) {
+                ModelPart* part = stack.back();
+                stack.pop_back();
+                ++visited;
+                for (int row = part->childCount() - 1; row >= 0; --row)
+                    stack.push_back(part->child(row));
+            }
+        });
+        std::printf("%-5s %-24s %10lld\n", shape, "parts visited", visited);
+
+        timed(shape, "destroy", [&] {
+            delete top;
+        });
+        std::printf("%-5s %-24s %10d\n", shape, "arenas in use", ModelPart::pool().arenaCount());
+    }
+
+    /**
+     * @brief Inserts a tree into a model, fetches every row and times the lookups views make.
+     *
+     * @param shape Name of the tree's shape, for the report.
+     * @param top The tree; the model takes ownership.
+     */
+    void benchmarkLookups(const char* shape, ModelPart* top) {
+        ModelPartList model(QStringLiteral("Parts"));
+        model.setFetchPageSize(1 << 30);
+        timed(shape, "insert into model", [&] {
+            model.appendParts({ top });
+        });
+
+        // Every part in preorder, with the index of its parent
+        std::vector<ModelPart*> parts;
+        std::vector<QModelIndex> parents;
+        timed(shape, "fetch every row", [&] {
+            std::vector<std::pair<ModelPart*, QModelIndex>> stack{ { top, QModelIndex() } };
+            while (!stack.empty()) {
+                ModelPart* part = stack.back().first;
+                QModelIndex parentIndex = stack.back().second;
+                stack.pop_back();
+                parts.push_back(part);
+                parents.push_back(parentIndex);
+
+                QModelIndex partIndex = model.index(part->row(), 0, parentIndex);
+                while (model.canFetchMore(partIndex))
+                    model.fetchMore(partIndex);
+                for (int row = part->childCount() - 1; row >= 0; --row)
+                    stack.push_back({ part->child(row), partIndex });
+            }
+        });
+
+        long long sum = 0;
+        timed(shape, "row()", [&] {
+            for (ModelPart* part : parts)
+                sum += part->row();
+        });
+
+        std::vector<QModelIndex> indexes(parts.size());
+        timed(shape, "index()", [&] {
+            for (std::size_t i = 0; i < parts.size(); ++i)
+                indexes[i] = model.index(parts[i]->row(), 0, parents[i]);
+        });
+
+        timed(shape, "parent()", [&] {
+            for (const QModelIndex& partIndex : indexes)
+                sum += model.parent(partIndex).row();
+        });
+        std::printf("%-5s %-24s %10lld\n", shape, "checksum", sum);
+    }
+
+    /**
+     * @brief Counts the nodes of a snapshot one at a time.
+     */
+    long long countNodes(const SceneSnapshot& snapshot) {
+        long long count = 0;
+        std::vector<const SnapshotNode*> stack{ snapshot.root() };
+        while (!stack.empty()) {
+            const SnapshotNode* node = stack.back();
+            stack.pop_back();
+            ++count;
+            for (int row = 0; row < node->childCount; ++row)
+                stack.push_back(node->child(row));
+        }
+        return count;
+    }
+
+    /**
+     * @brief Walks snapshots in parallel on a reader thread while the main thread edits the tree.
+     *
+     * @param parts Number of parts in the tree, in groups of a thousand.
+     * @return The number of walks that did not visit exactly the parts of their snapshot.
+     */
+    int benchmarkSnapshots(int parts) {
+        const int groupSize = 1000;
+        const int rounds = 20;
+        int groups = std::max(1, parts / groupSize);
+
+        ModelPartList model(QStringLiteral("Parts"));
+        model.setFetchPageSize(1 << 30);
+        QList<ModelPart*> tree;
+        for (int group = 0; group < groups; ++group)
+            tree.append(buildFlat(groupSize));
+        model.appendParts(tree);
+
+        int mismatches = 0;
+        long long edits = 0;
+        timed("snap", "parallel walks", [&] {
+            for (int round = 0; round < rounds; ++round) {
+                SceneSnapshot snapshot = model.snapshot();
+                std::atomic<long long> visited(0);
+                std::atomic<bool> finished(false);
+                std::thread reader([snapshot, &visited, &finished] {
+                    snapshot.parallelForEach([&visited](const SnapshotNode&, vtkMatrix4x4*) {
+                        visited.fetch_add(1, std::memory_order_relaxed);
+                        });
+                    finished.store(true);
+                    });
+
+                // Edit the live tree as the GUI thread would until the walk is done
+                do {
+                    QModelIndex groupIndex = model.index(static_cast<int>(edits % groups), 0);
+                    ModelPart* group = model.getItem(groupIndex);
+                    ModelPart* part = group->child(static_cast<int>((edits * 7919) % group->childCount()));
+                    model.renamePart(part, QStringLiteral("Edit %1").arg(edits));
+                    const double position[3] = { static_cast<double>(edits), 0.0, 0.0 };
+                    const double orientation[3] = { 0.0, 0.0, static_cast<double>(edits % 360) };
+                    part->setLocalTransform(position, orientation);
+                    if (edits % 64 == 0) {
+                        model.removeRows(group->childCount() - 1, 1, groupIndex);
+                        model.appendParts({ new ModelPart(QStringLiteral("Part")) }, groupIndex);
+                    }
+                    ++edits;
+                } while (!finished.load());
+                reader.join();
+
+                if (visited.load() != countNodes(snapshot))
+                    ++mismatches;
+            }
+        });
+        std::printf("%-5s %-24s %10lld\n", "snap", "edits during walks", edits);
+        std::printf("%-5s %-24s %10d\n", "snap", "inconsistent walks", mismatches);
+        return mismatches;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication application(argc, argv);
+    int parts = argc > 1 ? std::max(1, std::atoi(argv[1])) : 1000000;
+    std::printf("%d parts per tree\n", parts);
+
+    benchmarkLifecycle("flat", buildFlat, parts);
+    benchmarkLookups("flat", buildFlat(parts));
+
+    benchmarkLifecycle("deep", buildDeep, parts);
+    benchmarkLookups("deep", buildDeep(parts));
+
+    return benchmarkSnapshots(parts) == 0 ? 0 : 1;
+}